@@ -0,0 +1,84 @@
+// Frustum Culling Shader
+// 每个工作组处理一条剔除命令，可见实例通过 atomicAdd 写入间接绘制命令的 InstanceCount
+
+#type compute
+#version 450 core
+layout (local_size_x = 64) in;
+
+struct DrawCommand {
+    uint Count;
+    uint InstanceCount;
+    uint FirstIndex;
+    int BaseVertex;
+    uint BaseInstance;
+};
+
+struct CullCommand {
+    vec4 BoundingSphere; // xyz 局部空间球心, w 半径
+    uint FirstInstance;  // 实例在 InstanceBuffer 中的起始下标
+    uint InstanceCount;
+    uint CommandIndex;   // 对应 DrawCommandBuffer 中的命令
+    uint VisibleBase;    // 可见实例写入 VisibleBuffer 的起始位置
+};
+
+layout(std430, binding = 6) writeonly buffer VisibleBuffer {
+    uint visible[];
+};
+
+layout(std430, binding = 7) buffer DrawCommandBuffer {
+    DrawCommand commands[];
+};
+
+layout(std430, binding = 8) readonly buffer CullCommandBuffer {
+    CullCommand cullCommands[];
+};
+
+// 球体与模型的实例结构不同，按 vec4 读取，Transform 总在最前面
+layout(std430, binding = 9) readonly buffer InstanceBuffer {
+    vec4 instanceData[];
+};
+
+uniform vec4 u_FrustumPlanes[6];
+uniform int u_InstanceStride;       // 实例结构体的大小 (vec4 个数)
+uniform int u_SkinnedOffsetIndex;   // SkinnedVertexOffset 在实例结构体中的位置 (4 字节为单位)，-1 表示没有
+
+bool IsVisible(uint instanceIndex, vec4 boundingSphere)
+{
+    uint base = instanceIndex * uint(u_InstanceStride);
+
+    // 蒙皮后的包围盒未知，带动画的实例总是可见
+    if (u_SkinnedOffsetIndex >= 0)
+    {
+        int skinnedOffset = floatBitsToInt(instanceData[base + uint(u_SkinnedOffsetIndex / 4)][u_SkinnedOffsetIndex % 4]);
+        if (skinnedOffset >= 0)
+            return true;
+    }
+
+    mat4 transform = mat4(instanceData[base], instanceData[base + 1], instanceData[base + 2], instanceData[base + 3]);
+
+    vec3 center = (transform * vec4(boundingSphere.xyz, 1.0)).xyz;
+    float scale = max(max(length(transform[0].xyz), length(transform[1].xyz)), length(transform[2].xyz));
+    float radius = boundingSphere.w * scale;
+
+    for (int i = 0; i < 6; i++)
+    {
+        if (dot(u_FrustumPlanes[i].xyz, center) + u_FrustumPlanes[i].w < -radius)
+            return false;
+    }
+    return true;
+}
+
+void main()
+{
+    CullCommand cull = cullCommands[gl_WorkGroupID.x];
+
+    for (uint i = gl_LocalInvocationID.x; i < cull.InstanceCount; i += gl_WorkGroupSize.x)
+    {
+        uint instanceIndex = cull.FirstInstance + i;
+        if (IsVisible(instanceIndex, cull.BoundingSphere))
+        {
+            uint slot = atomicAdd(commands[cull.CommandIndex].InstanceCount, 1u);
+            visible[cull.VisibleBase + slot] = instanceIndex;
+        }
+    }
+}
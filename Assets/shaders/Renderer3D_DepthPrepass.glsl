@@ -0,0 +1,64 @@
+// Depth Pre-Pass Shader
+// 只写深度，之后的主通道以 GL_EQUAL 测试，每个像素只运行一次完整的 PBR 片元着色器
+// 位置计算必须与 Renderer3D_Model / Renderer3D_Sphere 完全一致 (invariant gl_Position)
+
+#type vertex
+#version 450 core
+#extension GL_ARB_shader_draw_parameters : require
+layout (location = 0) in vec3 a_Position;
+
+// 球体与模型的实例结构不同，按 vec4 读取，Transform 总在最前面 (与 Renderer3D_Cull 相同)
+layout(std430, binding = 9) readonly buffer InstanceBuffer {
+    vec4 instanceData[];
+};
+
+layout(std430, binding = 6) readonly buffer VisibleBuffer {
+    uint visible[];
+};
+
+// 由 Renderer3D_Skinning 每帧蒙皮一次的顶点，与 Renderer3D_Model 中的声明一致
+struct SkinnedVertex {
+    vec4 Position;
+    vec4 Normal;
+    vec4 Tangent;
+};
+
+layout(std430, binding = 19) readonly buffer SkinnedVertexBuffer {
+    SkinnedVertex skinnedVertices[];
+};
+
+layout(std140, binding = 0) uniform Camera {
+    mat4 u_Projection;
+    mat4 u_View;
+    mat4 u_ViewProjection;
+    vec3 u_CameraPosition;
+};
+
+uniform int u_InstanceStride;       // 实例结构体的大小 (vec4 个数)
+uniform int u_SkinnedOffsetIndex;   // SkinnedVertexOffset 在实例结构体中的位置 (4 字节为单位)，-1 表示没有 (球体)
+
+invariant gl_Position;
+
+void main()
+{
+    uint base = visible[gl_BaseInstanceARB + gl_InstanceID] * uint(u_InstanceStride);
+    mat4 transform = mat4(instanceData[base], instanceData[base + 1], instanceData[base + 2], instanceData[base + 3]);
+
+    vec3 animatedPosition = a_Position;
+    if (u_SkinnedOffsetIndex >= 0)
+    {
+        int skinnedOffset = floatBitsToInt(instanceData[base + uint(u_SkinnedOffsetIndex / 4)][u_SkinnedOffsetIndex % 4]);
+        if (skinnedOffset >= 0)
+            animatedPosition = skinnedVertices[skinnedOffset + gl_VertexID - gl_BaseVertexARB].Position.xyz;
+    }
+
+    vec4 worldPos4 = transform * vec4(animatedPosition, 1.0);
+    gl_Position = u_ViewProjection * worldPos4;
+}
+
+#type fragment
+#version 450 core
+
+void main()
+{
+}
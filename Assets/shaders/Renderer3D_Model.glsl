@@ -2,6 +2,16 @@
 
 #type vertex
 #version 450 core
+#extension GL_ARB_shader_draw_parameters : require
+
+#ifdef DEFERRED_LIGHTING
+// 延迟光照通道：不读取顶点，由 gl_VertexID 生成覆盖全屏的三角形
+void main()
+{
+    vec2 uv = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+    gl_Position = vec4(uv * 2.0 - 1.0, 0.0, 1.0);
+}
+#else
 layout (location = 0) in vec3 a_Position;
 layout (location = 1) in vec3 a_Normal;
 layout (location = 2) in vec2 a_TexCoords;
@@ -12,38 +22,44 @@ layout (location = 6) in vec4 a_Weights;
 
 // ================================================================================================
 
-#define MAX_BONES 100
-#define MAX_BONE_INFLUENCE 4
-
 struct InstanceData {
     mat4 Transform;
     vec4 TintColor;
 
-	// PBR
-	vec4 AlbedoColor;
-	vec4 EmissiveColor;
-	float Roughness;
-	float Metallic;
-	float AO;
-
-	// 纹理贴图 (对应 Material.h 中的 TextureType 枚举)
-	int AlbedoMapIndex;	   // 0
-	int NormalMapIndex;	   // 1
-	int MetallicMapIndex;  // 2
-	int RoughnessMapIndex; // 3
-	int AoMapIndex;		   // 4
-	int EmissiveMapIndex;  // 5
-	int HeightMapIndex;	   // 6
-
     int EntityID;
     int FlipUV;
+    int MaterialIndex; // MaterialBuffer 中的下标
+    int SkinnedVertexOffset; // -1 为静态网格
+};
+
+// 材质表，内容相同的材质只保存一份 (与 C++ MaterialData 一致)
+struct MaterialData {
+    vec4 AlbedoColor;
+    vec4 EmissiveColor;
+    float Roughness;
+    float Metallic;
+    float AO;
+
+	// 纹理贴图 (对应 Material.h 中的 TextureType 枚举)，全局纹理表的下标
+	int AlbedoMapIndex;	      // 0
+	int NormalMapIndex;	      // 1
+	int MetallicMapIndex;     // 2
+	int RoughnessMapIndex;    // 3
+	int AoMapIndex;		      // 4
+	int EmissiveMapIndex;     // 5
+	int HeightMapIndex;	      // 6
 
     int ReceivesPBR;
 	int ReceivesIBL;
 	int ReceivesLight;
-	int ReceivesShadow;
+    int ReceivesShadow;
 
-    mat4 FinalBoneMatrices[MAX_BONES];
+    int padding_0;
+    int padding_1;
+};
+
+layout(std430, binding = 11) readonly buffer MaterialBuffer {
+    MaterialData materials[];
 };
 
 // SSBO Declaration
@@ -51,6 +67,22 @@ layout(std140, binding = 3) readonly buffer InstanceBuffer {
     InstanceData instances[];
 };
 
+// 视锥剔除后的可见实例下标，由 Renderer3D_Cull 或 CPU 写入
+layout(std430, binding = 6) readonly buffer VisibleBuffer {
+    uint visible[];
+};
+
+// 由 Renderer3D_Skinning 每帧蒙皮一次的顶点 (局部空间)，带动画的实例从 SkinnedVertexOffset 开始读取
+struct SkinnedVertex {
+    vec4 Position;
+    vec4 Normal;
+    vec4 Tangent;
+};
+
+layout(std430, binding = 19) readonly buffer SkinnedVertexBuffer {
+    SkinnedVertex skinnedVertices[];
+};
+
 // Output to fragment shader
 out VS_OUT {
     vec3 WorldPos;    // 世界空间位置
@@ -86,93 +118,246 @@ out VS_OUT {
 } vs_out;
 
 
-uniform mat4 u_ViewProjection;
+// 每帧由 Renderer3D::BeginScene 上传一次，所有程序共用 (与 C++ CameraData 一致)
+layout(std140, binding = 0) uniform Camera {
+    mat4 u_Projection;
+    mat4 u_View;
+    mat4 u_ViewProjection;
+    vec3 u_CameraPosition;
+};
 //  uniform int  u_IsAnimated; // 增加一个开关：0 为静态模型，1 为带动画模型
 
+// 深度预通道之后以 GL_EQUAL 测试，位置必须与 Renderer3D_DepthPrepass 逐位一致
+invariant gl_Position;
+
 void main()
 {
-    InstanceData instance = instances[gl_InstanceID];
+    // 多个网格通过 glMultiDrawElementsIndirect 一次提交，BaseInstance 指向各自的可见列表
+    InstanceData instance = instances[visible[gl_BaseInstanceARB + gl_InstanceID]];
 
     mat4 transform  = instance.Transform;
 
-    mat4 boneTransform = mat4(0.0f);
-    float totalWeight = 0.0;
-    for (int i = 0; i < MAX_BONE_INFLUENCE; i++)
+    // gl_VertexID 包含 BaseVertex，减去后为网格内的顶点下标
+    vec3 animatedPosition = a_Position;
+    vec3 animatedNormal = a_Normal;
+    vec3 animatedTangent = a_Tangent;
+    if (instance.SkinnedVertexOffset >= 0)
     {
-        if (a_BoneIDs[i] == -1) continue;
-        if (a_BoneIDs[i] >= MAX_BONES) break;
-
-        boneTransform += instance.FinalBoneMatrices[a_BoneIDs[i]] * a_Weights[i];
-        totalWeight += a_Weights[i];
+        SkinnedVertex skinned = skinnedVertices[instance.SkinnedVertexOffset + gl_VertexID - gl_BaseVertexARB];
+        animatedPosition = skinned.Position.xyz;
+        animatedNormal = skinned.Normal.xyz;
+        animatedTangent = skinned.Tangent.xyz;
     }
-    // 如果没有权重（静态物体），设为单位矩阵
-    if (totalWeight < 0.01) boneTransform = mat4(1.0);
-
-    vec4 localAnimatedPos = boneTransform * vec4(a_Position, 1.0);
     // ================================================================================================
 
-    vec4 worldPos4 = transform * localAnimatedPos;
+    vec4 worldPos4 = transform * vec4(animatedPosition, 1.0);
     vs_out.WorldPos = worldPos4.xyz;     // 世界空间位置
     gl_Position = u_ViewProjection * worldPos4;
 
     // 世界空间法线 (为了正确变换法线，需要使用模型矩阵的逆转置矩阵)
-    // 假设没有非统一缩放，可以直接用 mat3(Model)
-    vs_out.NormalWS = mat3(transpose(inverse(transform * boneTransform))) * a_Normal;
+    vs_out.NormalWS = mat3(transpose(inverse(transform))) * animatedNormal;
 
     vs_out.TexCoords = a_TexCoords;
     vs_out.TintColor = instance.TintColor;
 
-    // 计算 TBN 矩阵 (切线空间到世界空间)
-    mat3 boneMat3 = mat3(boneTransform);
-    vec3 animatedNormal   = boneMat3 * a_Normal;
-    vec3 animatedTangent  = boneMat3 * a_Tangent;
-    vec3 animatedBitangent = boneMat3 * a_Bitangent;
-
+    // 计算 TBN 矩阵 (切线空间到世界空间)，副切线由法线与切线重新求出
     vec3 T = normalize(mat3(transform) * animatedTangent);
-    vec3 B = normalize(mat3(transform) * animatedBitangent);
     vec3 N = normalize(mat3(transform) * animatedNormal);
     T = normalize(T - dot(T, N) * N);
-    B = normalize(cross(N, T));
+    vec3 B = normalize(cross(N, T));
     vs_out.TBN = mat3(T, B, N);
 
     // PBR
-	vs_out.AlbedoColor = instance.AlbedoColor;
-	vs_out.EmissiveColor = instance.EmissiveColor;
-	vs_out.Roughness = instance.Roughness;
-	vs_out.Metallic = instance.Metallic;
-	vs_out.AO = instance.AO;
-
-	vs_out.AlbedoMapIndex = instance.AlbedoMapIndex;
-	vs_out.NormalMapIndex = instance.NormalMapIndex;
-	vs_out.MetallicMapIndex = instance.MetallicMapIndex;
-	vs_out.RoughnessMapIndex = instance.RoughnessMapIndex;
-	vs_out.AoMapIndex = instance.AoMapIndex;
-	vs_out.EmissiveMapIndex = instance.EmissiveMapIndex;
-	vs_out.HeightMapIndex = instance.HeightMapIndex;
+    MaterialData material = materials[instance.MaterialIndex];
+
+	vs_out.AlbedoColor = material.AlbedoColor;
+	vs_out.EmissiveColor = material.EmissiveColor;
+	vs_out.Roughness = material.Roughness;
+	vs_out.Metallic = material.Metallic;
+	vs_out.AO = material.AO;
+
+	vs_out.AlbedoMapIndex = material.AlbedoMapIndex;
+	vs_out.NormalMapIndex = material.NormalMapIndex;
+	vs_out.MetallicMapIndex = material.MetallicMapIndex;
+	vs_out.RoughnessMapIndex = material.RoughnessMapIndex;
+	vs_out.AoMapIndex = material.AoMapIndex;
+	vs_out.EmissiveMapIndex = material.EmissiveMapIndex;
+	vs_out.HeightMapIndex = material.HeightMapIndex;
 
     vs_out.EntityID = instance.EntityID;
     vs_out.FlipUV = instance.FlipUV;
 
-    vs_out.ReceivesPBR = instance.ReceivesPBR;
-    vs_out.ReceivesIBL = instance.ReceivesIBL;
-    vs_out.ReceivesLight = instance.ReceivesLight;
-    vs_out.ReceivesShadow = instance.ReceivesShadow;
+    vs_out.ReceivesPBR = material.ReceivesPBR;
+    vs_out.ReceivesIBL = material.ReceivesIBL;
+    vs_out.ReceivesLight = material.ReceivesLight;
+    vs_out.ReceivesShadow = material.ReceivesShadow;
 }
+#endif
 
 // ======================================================================
 
 #type fragment
 #version 450 core
+#extension GL_ARB_bindless_texture : enable
+#ifdef DEFERRED_GBUFFER
+layout (location = 0) out vec4 o_GAlbedo;   // rgb: 线性反射率, a: alpha
+layout (location = 1) out vec4 o_GNormal;   // xy: 着色法线, zw: 几何法线 (八面体编码)
+layout (location = 2) out vec4 o_GMaterial; // r: 粗糙度, g: 金属度, b: AO, a: 标志
+layout (location = 3) out vec4 o_GEmissive;
+layout (location = 4) out int o_EntityID;
+#else
 layout (location = 0) out vec4 o_Color;
 layout (location = 1) out int o_EntityID;
+#endif
 
 uniform sampler2D u_Textures[32];
 
+// 贴图下标是全局纹理表的下标
+// 支持 GL_ARB_bindless_texture 时直接索引句柄表，否则先查到当前批次的纹理单元
+#ifdef GL_ARB_bindless_texture
+layout(std430, binding = 10) readonly buffer TextureHandleBuffer {
+    uvec2 textureHandles[];
+};
+uniform bool u_Bindless;
+#endif
+
+layout(std430, binding = 12) readonly buffer TextureSlotBuffer {
+    int textureSlots[];
+};
+
+vec4 SampleMaterialTexture(int index, vec2 texCoords)
+{
+#ifdef GL_ARB_bindless_texture
+    if (u_Bindless)
+        return texture(sampler2D(textureHandles[index]), texCoords);
+#endif
+    return texture(u_Textures[textureSlots[index]], texCoords);
+}
+
+#if defined(DEFERRED_GBUFFER) || defined(DEFERRED_LIGHTING)
+// G-buffer 编码 (与 Renderer3D 的延迟路径一致)
+// 法线使用八面体编码，两个法线共用一个 RGBA16F 附件
+vec2 EncodeNormal(vec3 n)
+{
+    n /= abs(n.x) + abs(n.y) + abs(n.z);
+    if (n.z < 0.0)
+        n.xy = (1.0 - abs(n.yx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+    return n.xy;
+}
+
+vec3 DecodeNormal(vec2 e)
+{
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    float t = max(-n.z, 0.0);
+    n.xy += vec2(n.x >= 0.0 ? -t : t, n.y >= 0.0 ? -t : t);
+    return normalize(n);
+}
+
+// 材质附件的 a 通道：低 4 位为 Receives* 标志，第 5 位表示该像素已写入
+const float GBufferFlagScale = 31.0;
+#endif
+
 // IBL
 uniform samplerCube irradianceMap;
 uniform samplerCube prefilterMap;
 uniform sampler2D brdfLUT;
 
+#ifdef DEFERRED_LIGHTING
+// 延迟光照通道没有顶点着色器的输出，fs_in 由 LoadGBuffer 从 G-buffer 还原
+struct SurfaceInput {
+    vec3 WorldPos;    // 世界空间位置
+    vec3 NormalWS;    // 世界空间法线 (未归一化)
+    mat3 TBN;         // 切线空间到世界空间的转换矩阵
+    vec2 TexCoords;
+    vec4 TintColor;
+
+    // PBR
+	vec4 AlbedoColor;
+    vec4 EmissiveColor;
+
+	float Roughness;
+	float Metallic;
+	float AO; // 环境光遮蔽
+
+	// 纹理贴图 (对应 Material.h 中的 TextureType 枚举)
+	int AlbedoMapIndex;	   // 0
+	int NormalMapIndex;	   // 1
+	int MetallicMapIndex;     // 2
+	int RoughnessMapIndex;    // 3
+	int AoMapIndex;		   // 4
+	int EmissiveMapIndex;     // 5
+	int HeightMapIndex;	   // 6
+
+    int EntityID;
+    int FlipUV;
+
+    int ReceivesPBR;
+	int ReceivesIBL;
+	int ReceivesLight;
+    int ReceivesShadow;
+};
+SurfaceInput fs_in;
+
+uniform sampler2D u_GBufferAlbedo;
+uniform sampler2D u_GBufferNormal;
+uniform sampler2D u_GBufferMaterial;
+uniform sampler2D u_GBufferEmissive;
+uniform isampler2D u_GBufferEntityID;
+uniform sampler2D u_GBufferDepth;
+uniform mat4 u_InverseViewProjection;
+uniform vec2 u_GBufferOffset; // 视口原点，G-buffer 从 (0, 0) 开始
+
+vec3 g_ShadingNormal; // 法线贴图之后的着色法线
+
+// 贴图已在 G-buffer 通道中采样，这里把结果作为常量材质填回 fs_in
+// 没有被本批次写入的像素 (背景或之前批次的物体) 返回 false
+bool LoadGBuffer()
+{
+    ivec2 texel = ivec2(gl_FragCoord.xy - u_GBufferOffset);
+    vec4 material = texelFetch(u_GBufferMaterial, texel, 0);
+    int flags = int(material.a * GBufferFlagScale + 0.5);
+    if ((flags & 16) == 0)
+        return false;
+
+    float depth = texelFetch(u_GBufferDepth, texel, 0).r;
+    vec2 ndc = (vec2(texel) + 0.5) / vec2(textureSize(u_GBufferDepth, 0)) * 2.0 - 1.0;
+    vec4 worldPos = u_InverseViewProjection * vec4(ndc, depth * 2.0 - 1.0, 1.0);
+
+    vec4 albedo = texelFetch(u_GBufferAlbedo, texel, 0);
+    vec4 normals = texelFetch(u_GBufferNormal, texel, 0);
+
+    fs_in.WorldPos = worldPos.xyz / worldPos.w;
+    fs_in.NormalWS = DecodeNormal(normals.zw);
+    fs_in.TBN = mat3(1.0);
+    fs_in.TexCoords = vec2(0.0);
+    fs_in.TintColor = vec4(1.0);
+
+    fs_in.AlbedoColor = albedo;
+    fs_in.EmissiveColor = vec4(texelFetch(u_GBufferEmissive, texel, 0).rgb, 1.0);
+    fs_in.Roughness = material.r;
+    fs_in.Metallic = material.g;
+    fs_in.AO = material.b;
+
+    fs_in.AlbedoMapIndex = -1;
+    fs_in.NormalMapIndex = -1;
+    fs_in.MetallicMapIndex = -1;
+    fs_in.RoughnessMapIndex = -1;
+    fs_in.AoMapIndex = -1;
+    fs_in.EmissiveMapIndex = -1;
+    fs_in.HeightMapIndex = -1;
+
+    fs_in.EntityID = texelFetch(u_GBufferEntityID, texel, 0).r;
+    fs_in.FlipUV = 0;
+
+    fs_in.ReceivesPBR = (flags & 1) != 0 ? 1 : 0;
+    fs_in.ReceivesIBL = (flags & 2) != 0 ? 1 : 0;
+    fs_in.ReceivesLight = (flags & 4) != 0 ? 1 : 0;
+    fs_in.ReceivesShadow = (flags & 8) != 0 ? 1 : 0;
+
+    g_ShadingNormal = DecodeNormal(normals.xy);
+    return true;
+}
+#else
 in VS_OUT {
     vec3 WorldPos;    // 世界空间位置
     vec3 NormalWS;    // 世界空间法线 (未归一化)
@@ -205,13 +390,14 @@ in VS_OUT {
 	flat int ReceivesLight;
     flat int ReceivesShadow;
 } fs_in;
+#endif
 
 // ===================================================================================================================
 // 光源 Uniforms (与 C++ Renderer3DData 中的定义一致)
 #define MAXLIGHTS 8
 #define MAX_DIRECTIONAL_LIGHTS MAXLIGHTS
-#define MAX_POINT_LIGHTS       MAXLIGHTS
-#define MAX_SPOT_LIGHTS        MAXLIGHTS
+#define MAX_POINT_SHADOWS      MAXLIGHTS
+#define SHADOW_CASCADES        4 // 与 C++ ShadowCascadeCount 一致
 
 struct DirectionalLight {
     vec3 direction; // 光源方向 (通常是从物体指向光源，或约定为光线射来的方向的反方向)
@@ -219,8 +405,10 @@ struct DirectionalLight {
     vec3 color;
     int CastsShadows;
 
-	mat4 LightSpaceMatrix;
-	int ShadowMapIndex;
+	mat4 CascadeMatrices[SHADOW_CASCADES];
+	vec4 CascadeSplits; // 每级级联覆盖到的观察空间深度
+	vec4 CascadeRects[SHADOW_CASCADES]; // 每级级联在阴影图集中的区块 (UV: xy 偏移, zw 大小)
+	int ShadowMapIndex; // -1 表示没有阴影
 	float padding_0;
 	float padding_1;
 	float padding_2;
@@ -249,9 +437,19 @@ struct SpotLight {
 
     mat4 LightSpaceMatrix;
 	float outerConeCos; // 外锥角的余弦值 (cos(InnerConeAngle))
-    int ShadowMapIndex;
+    int ShadowMapIndex; // -1 表示没有阴影
     int CastsShadows;
     float padding_0;
+
+    vec4 AtlasRect; // 在阴影图集中的区块 (UV: xy 偏移, zw 大小)
+};
+
+// 级联选择需要观察空间深度，与顶点着色器共用 Camera 块
+layout(std140, binding = 0) uniform Camera {
+    mat4 u_Projection;
+    mat4 u_View;
+    mat4 u_ViewProjection;
+    vec3 u_CameraPosition;
 };
 
 // SSBO Light
@@ -263,12 +461,45 @@ layout(std430, binding = 1) readonly buffer LightData {
     int NumPointLights;
     int NumSpotLights;
     int padding2;
+
+    uvec4 ClusterDimensions; // xyz: 簇网格大小
+    vec4 ClusterDepthParams; // 深度层 slice = log(viewDepth) * x + y
     
     DirectionalLight DirectionalLights[MAX_DIRECTIONAL_LIGHTS];
-    PointLight PointLights[MAX_POINT_LIGHTS];
-    SpotLight SpotLights[MAX_SPOT_LIGHTS];
 };
 
+// 分簇光照：点光源与聚光灯数量不受限制，每个片元只遍历所在簇的光源
+layout(std430, binding = 15) readonly buffer PointLightBuffer {
+    PointLight PointLights[];
+};
+
+layout(std430, binding = 16) readonly buffer SpotLightBuffer {
+    SpotLight SpotLights[];
+};
+
+// x: 在 clusterLightIndices 中的起始位置, y: 点光源数量, z: 聚光灯数量 (紧跟点光源之后)
+layout(std430, binding = 17) readonly buffer ClusterBuffer {
+    uvec4 clusters[];
+};
+
+layout(std430, binding = 18) readonly buffer ClusterIndexBuffer {
+    uint clusterLightIndices[];
+};
+
+// 与 C++ LightClusterGrid 的划分一致：屏幕按 NDC 均分，深度按指数划分
+uvec4 GetLightCluster(vec3 fragPos)
+{
+    vec4 clip = u_ViewProjection * vec4(fragPos, 1.0);
+    vec2 ndc = clip.xy / clip.w;
+    ivec2 tile = clamp(ivec2(floor((ndc * 0.5 + 0.5) * vec2(ClusterDimensions.xy))), ivec2(0), ivec2(ClusterDimensions.xy) - 1);
+
+    float viewDepth = max(-(u_View * vec4(fragPos, 1.0)).z, 1e-4);
+    int slice = clamp(int(log(viewDepth) * ClusterDepthParams.x + ClusterDepthParams.y), 0, int(ClusterDimensions.z) - 1);
+
+    uint index = uint(tile.x) + ClusterDimensions.x * (uint(tile.y) + ClusterDimensions.y * uint(slice));
+    return clusters[index];
+}
+
 // ----------------------------------------------------------------------------
 // PBR Helper Functions (Cook-Torrance BRDF)
 // ----------------------------------------------------------------------------
@@ -314,9 +545,8 @@ vec3 FresnelSchlickRoughness(float cosTheta, vec3 F0, float roughness)
     return F0 + (max(vec3(1.0 - roughness), F0) - F0) * pow(clamp(1.0 - cosTheta, 0.0, 1.0), 5.0);
 }
 // ----------------------------------------------------------------------------
-uniform samplerCube u_PointShadowDepthMaps[MAXLIGHTS];
-uniform sampler2D u_DirectionalShadowMaps[MAXLIGHTS];
-uniform sampler2D u_SpotShadowMaps[MAXLIGHTS];
+uniform samplerCube u_PointShadowDepthMaps[MAX_POINT_SHADOWS];
+uniform sampler2D u_ShadowAtlas; // 方向光级联与聚光灯共用的深度图集
 
 vec3 gridSamplingDisk[20] = vec3[]
 (
@@ -329,6 +559,10 @@ vec3 gridSamplingDisk[20] = vec3[]
 
 float CalculatePointShadow(vec3 fragPos, vec3 lightPos, float farPlane, int shadowMapIndex)
 {
+    // 超出阴影数量上限的点光源没有阴影贴图
+    if (shadowMapIndex < 0)
+        return 0.0;
+
     // 从片元指向光源的向量
     vec3 fragToLight = fragPos - lightPos;
     
@@ -371,9 +605,47 @@ float CalculatePointShadow(vec3 fragPos, vec3 lightPos, float farPlane, int shad
 }
 
 
-float CalculateDirectionalShadow(vec3 fragPos, vec3 lightDirection, mat4 lightSpaceMatrix, int shadowMapIndex) 
+// 按观察空间深度选择级联
+int SelectShadowCascade(vec3 fragPos, vec4 cascadeSplits)
+{
+    float viewDepth = -(u_View * vec4(fragPos, 1.0)).z;
+    for (int i = 0; i < SHADOW_CASCADES - 1; ++i)
+    {
+        if (viewDepth < cascadeSplits[i])
+            return i;
+    }
+    return SHADOW_CASCADES - 1;
+}
+
+// 在图集的一个区块内做 3x3 PCF，采样坐标限制在区块内，不会读到相邻光源的深度
+float SampleShadowAtlasPCF(vec4 rect, vec2 uv, float currentDepth, float bias)
+{
+    vec2 texelSize = 1.0 / vec2(textureSize(u_ShadowAtlas, 0));
+    vec2 minUV = rect.xy + texelSize * 0.5;
+    vec2 maxUV = rect.xy + rect.zw - texelSize * 0.5;
+    vec2 center = rect.xy + uv * rect.zw;
+
+    float shadow = 0.0;
+    for (int x = -1; x <= 1; ++x)
+    {
+        for (int y = -1; y <= 1; ++y)
+        {
+            float pcfDepth = texture(u_ShadowAtlas, clamp(center + vec2(x, y) * texelSize, minUV, maxUV)).r;
+            shadow += currentDepth > pcfDepth + bias ? 1.0 : 0.0;
+        }
+    }
+    // 平均化阴影值 (0.0 表示全光照，1.0 表示全阴影)
+    return shadow / 9.0;
+}
+
+float CalculateDirectionalShadow(vec3 fragPos, vec3 lightDirection, DirectionalLight light) 
 { 
-    vec4 lightSpacePos = lightSpaceMatrix * vec4(fragPos, 1.0); 
+    if (light.ShadowMapIndex < 0)
+        return 0.0;
+
+    int cascade = SelectShadowCascade(fragPos, light.CascadeSplits);
+
+    vec4 lightSpacePos = light.CascadeMatrices[cascade] * vec4(fragPos, 1.0); 
     // vec3 projCoords = lightSpacePos.xyz / lightSpacePos.w; 
     vec3 projCoords = lightSpacePos.xyz; 
     projCoords = projCoords * 0.5 + 0.5; 
@@ -385,36 +657,22 @@ float CalculateDirectionalShadow(vec3 fragPos, vec3 lightDirection, mat4 lightSp
         return 1.0;
     }
     
-    float closestDepth = texture(u_DirectionalShadowMaps[shadowMapIndex], projCoords.xy).r; 
     float currentDepth = projCoords.z;
     vec3 n = normalize(fs_in.NormalWS);
     vec3 l = normalize(lightDirection);
     float bias = max(0.01 * (1.0 - dot(n, l)), 0.005);
 
     // --- PCF (Percentage Closer Filtering) 采样 ---
-    float shadow = 0.0;
-    // vec2 texelSize = vec2(1.0 / 2048.0);
-    vec2 texelSize = 1.0 / textureSize(u_DirectionalShadowMaps[shadowMapIndex], 0);
-    int samples = 9;
-    
-    // 3x3 采样循环
-    for (int x = -1; x <= 1; ++x)
-    {
-        for (int y = -1; y <= 1; ++y)
-        {
-            float pcfDepth = texture(u_DirectionalShadowMaps[shadowMapIndex], projCoords.xy + vec2(x, y) * texelSize).r;
-            shadow += currentDepth > pcfDepth + bias ? 1.0 : 0.0;
-        }    
-    }
-    // 平均化阴影值 (0.0 表示全阴影，1.0 表示全光照)
-    shadow /= float(samples);
-    
-    return shadow;
+    return SampleShadowAtlasPCF(light.CascadeRects[cascade], projCoords.xy, currentDepth, bias);
 }
 
-float CalculateSpotShadow(vec3 fragPos, vec3 lightPos, mat4 lightSpaceMatrix, int shadowMapIndex) 
+float CalculateSpotShadow(vec3 fragPos, SpotLight light) 
 { 
-    vec4 lightSpacePos = lightSpaceMatrix * vec4(fragPos, 1.0); 
+    if (light.ShadowMapIndex < 0)
+        return 0.0;
+
+    vec3 lightPos = light.position;
+    vec4 lightSpacePos = light.LightSpaceMatrix * vec4(fragPos, 1.0); 
     vec3 projCoords = lightSpacePos.xyz / lightSpacePos.w; 
     projCoords = projCoords * 0.5 + 0.5; 
 
@@ -425,7 +683,6 @@ float CalculateSpotShadow(vec3 fragPos, vec3 lightPos, mat4 lightSpaceMatrix, in
         return 1.0;
     }
     
-    float closestDepth = texture(u_SpotShadowMaps[shadowMapIndex], projCoords.xy).r; 
     float currentDepth = projCoords.z;
     
     vec3 n = normalize(fs_in.NormalWS);
@@ -433,29 +690,17 @@ float CalculateSpotShadow(vec3 fragPos, vec3 lightPos, mat4 lightSpaceMatrix, in
     float bias = max(0.01 * (1.0 - dot(n, l)), 0.005);
 
     // --- PCF (Percentage Closer Filtering) 采样 ---
-    float shadow = 0.0;
-    // vec2 texelSize = vec2(1.0 / 2048.0);
-    vec2 texelSize = 1.0 / textureSize(u_SpotShadowMaps[shadowMapIndex], 0);
-    int samples = 9;
-    
-    // 3x3 采样循环
-    for (int x = -1; x <= 1; ++x)
-    {
-        for (int y = -1; y <= 1; ++y)
-        {
-            float pcfDepth = texture(u_SpotShadowMaps[shadowMapIndex], projCoords.xy + vec2(x, y) * texelSize).r;
-            shadow += currentDepth > pcfDepth + bias ? 1.0 : 0.0;
-        }    
-    }
-    // 平均化阴影值 (0.0 表示全阴影，1.0 表示全光照)
-    shadow /= float(samples);
-    
-    return shadow;
+    return SampleShadowAtlasPCF(light.AtlasRect, projCoords.xy, currentDepth, bias);
 }
 
 
 void main()
 {
+#ifdef DEFERRED_LIGHTING
+    if (!LoadGBuffer())
+        discard;
+#endif
+
     o_EntityID = fs_in.EntityID;
 
     vec2 finalTexCoords = fs_in.TexCoords;
@@ -466,34 +711,52 @@ void main()
     // 基础颜色 / 反射率 (Albedo)
     vec3 albedo = fs_in.AlbedoColor.rgb * fs_in.TintColor.rgb;
     if (fs_in.AlbedoMapIndex > -1) {
-        albedo *= pow(texture(u_Textures[fs_in.AlbedoMapIndex], finalTexCoords).rgb, vec3(2.2));
+        albedo *= pow(SampleMaterialTexture(fs_in.AlbedoMapIndex, finalTexCoords).rgb, vec3(2.2));
     }
     float alpha = fs_in.AlbedoColor.a * fs_in.TintColor.a;
 
     // 粗糙度：结合贴图和实例数据
     float roughness = fs_in.Roughness;
     if (fs_in.RoughnessMapIndex > -1) {
-        roughness *= texture(u_Textures[fs_in.RoughnessMapIndex], finalTexCoords).r;
+        roughness *= SampleMaterialTexture(fs_in.RoughnessMapIndex, finalTexCoords).r;
     }
     
     // 金属度：结合贴图和实例数据
     float metallic = fs_in.Metallic;
     if (fs_in.MetallicMapIndex > -1) {
-        metallic *= texture(u_Textures[fs_in.MetallicMapIndex], finalTexCoords).r;
+        metallic *= SampleMaterialTexture(fs_in.MetallicMapIndex, finalTexCoords).r;
     }
 
     // 环境光遮蔽 (AO)：结合贴图和实例数据
     float ao = fs_in.AO;
     if (fs_in.AoMapIndex > -1) {
-        ao *= texture(u_Textures[fs_in.AoMapIndex], finalTexCoords).r;
+        ao *= SampleMaterialTexture(fs_in.AoMapIndex, finalTexCoords).r;
     }
 
     // 自发光：结合贴图和实例数据
     vec3 emissive = fs_in.EmissiveColor.rgb;
     if (fs_in.EmissiveMapIndex > -1) {
-        emissive *= texture(u_Textures[fs_in.EmissiveMapIndex], finalTexCoords).rgb;
+        emissive *= SampleMaterialTexture(fs_in.EmissiveMapIndex, finalTexCoords).rgb;
     }
 
+#ifdef DEFERRED_GBUFFER
+    // 只写入表面属性，光照在 Renderer3D_Model 的 DEFERRED_LIGHTING 变体中计算
+    vec3 shadingNormal = normalize(fs_in.NormalWS);
+    if (fs_in.NormalMapIndex > -1) {
+        vec3 normalFromMap = SampleMaterialTexture(fs_in.NormalMapIndex, finalTexCoords).rgb * 2.0 - 1.0;
+        shadingNormal = normalize(fs_in.TBN * normalFromMap);
+    }
+
+    int flags = 16 | (fs_in.ReceivesPBR == 1 ? 1 : 0) | (fs_in.ReceivesIBL == 1 ? 2 : 0) |
+                (fs_in.ReceivesLight == 1 ? 4 : 0) | (fs_in.ReceivesShadow == 1 ? 8 : 0);
+
+    o_GAlbedo = vec4(albedo, alpha);
+    o_GNormal = vec4(EncodeNormal(shadingNormal), EncodeNormal(normalize(fs_in.NormalWS)));
+    o_GMaterial = vec4(roughness, metallic, ao, float(flags) / GBufferFlagScale);
+    o_GEmissive = vec4(emissive, 1.0);
+    return;
+#endif
+
     vec3 finalColor;
 
     if (fs_in.ReceivesLight == 1)
@@ -503,14 +766,18 @@ void main()
         vec3 N = normalize(fs_in.NormalWS); // 默认使用世界空间法线
         if (fs_in.NormalMapIndex > -1) {
             // 假设法线贴图存储在 (0, 1) 范围，需要转换到 (-1, 1)
-            vec3 normalFromMap = texture(u_Textures[fs_in.NormalMapIndex], finalTexCoords).rgb;
+            vec3 normalFromMap = SampleMaterialTexture(fs_in.NormalMapIndex, finalTexCoords).rgb;
             normalFromMap = normalFromMap * 2.0 - 1.0;
             // 将法线从切线空间转换到世界空间
             N = normalize(fs_in.TBN * normalFromMap); 
         }
+#ifdef DEFERRED_LIGHTING
+        N = g_ShadingNormal;
+#endif
         // --- 遍历所有光源并累加贡献 ---
         vec3 Lo = vec3(0.0); // 累加所有直接光照
         vec3 ambient = 0.03 * albedo * ao;
+        uvec4 cluster = GetLightCluster(fs_in.WorldPos);
 
         if (fs_in.ReceivesPBR == 1)
         {
@@ -569,7 +836,7 @@ void main()
                     float shadow = 0.0;
                     if (fs_in.ReceivesShadow == 1 && light.CastsShadows == 1)
                     {
-                        shadow = CalculateDirectionalShadow(fs_in.WorldPos, L, light.LightSpaceMatrix, light.ShadowMapIndex);
+                        shadow = CalculateDirectionalShadow(fs_in.WorldPos, L, light);
                     }
 
                     Lo += directLightContribution * (1.0 - shadow);
@@ -577,9 +844,9 @@ void main()
             }
 
             // 点光源
-            for (int i = 0; i < NumPointLights; ++i)
+            for (uint i = 0u; i < cluster.y; ++i)
             {
-                PointLight light = PointLights[i];
+                PointLight light = PointLights[clusterLightIndices[cluster.x + i]];
 
                 vec3 lightToPixel = light.position - fs_in.WorldPos;
                 float distance = length(lightToPixel);
@@ -624,9 +891,9 @@ void main()
             }
             
             // 聚光灯
-            for (int i = 0; i < NumSpotLights; ++i)
+            for (uint i = 0u; i < cluster.z; ++i)
             {
-                SpotLight light = SpotLights[i];
+                SpotLight light = SpotLights[clusterLightIndices[cluster.x + cluster.y + i]];
                 
                 vec3 lightToPixel = light.position - fs_in.WorldPos;
                 float distance = length(lightToPixel);
@@ -667,7 +934,7 @@ void main()
                     float shadow = 0.0;
                     if (fs_in.ReceivesShadow == 1 && light.CastsShadows == 1)
                     {
-                        shadow = CalculateSpotShadow(fs_in.WorldPos, light.position, light.LightSpaceMatrix, light.ShadowMapIndex);
+                        shadow = CalculateSpotShadow(fs_in.WorldPos, light);
                     }
 
                     Lo += directLightContribution * (1.0 - shadow);
@@ -710,9 +977,9 @@ void main()
                 
                 Lo += albedo * light.color * light.intensity * NdotL;
             }
-            for (int i = 0; i < NumPointLights; ++i)
+            for (uint i = 0u; i < cluster.y; ++i)
             {
-                PointLight light = PointLights[i];
+                PointLight light = PointLights[clusterLightIndices[cluster.x + i]];
                 vec3 L = normalize(light.position - fs_in.WorldPos);
                 float NdotL = max(dot(N, L), 0.0);
                 
@@ -721,9 +988,9 @@ void main()
 
                 Lo += albedo * light.color * light.intensity * NdotL * attenuation;
             }
-            for (int i = 0; i < NumSpotLights; ++i)
+            for (uint i = 0u; i < cluster.z; ++i)
             {
-                SpotLight light = SpotLights[i];
+                SpotLight light = SpotLights[clusterLightIndices[cluster.x + cluster.y + i]];
                 vec3 L = normalize(light.position - fs_in.WorldPos);
                 float NdotL = max(dot(N, L), 0.0);
                 
@@ -0,0 +1,85 @@
+// GPU Skinning Shader
+// 每个 (动画实体, 网格) 每帧蒙皮一次，结果写入 SkinnedVertexBuffer
+// 主通道、深度预通道和所有阴影通道读取结果，当作静态几何使用
+// 每个工作组的 y 对应一个作业，x 覆盖作业的顶点
+
+#type compute
+#version 450 core
+layout (local_size_x = 64) in;
+
+#define MAX_BONES 100
+#define MAX_BONE_INFLUENCE 4
+
+// MeshManager 的共享顶点缓冲区 (与 C++ ModelVertex 一致，22 个 4 字节)
+// 0 Position, 3 Normal, 6 TexCoords, 8 Tangent, 11 Bitangent, 14 BoneIDs (int), 18 Weights
+#define VERTEX_STRIDE 22
+
+layout(std430, binding = 20) readonly buffer SourceVertexBuffer {
+    float sourceVertices[];
+};
+
+struct SkinningJob {
+    int BaseVertex;     // 网格在共享顶点缓冲区中的起始顶点
+    uint VertexCount;
+    uint OutputOffset;  // 在 SkinnedVertexBuffer 中的起始位置
+    int PaletteOffset;  // 骨骼调色板在 BonePaletteBuffer 中的起始位置
+};
+
+layout(std430, binding = 21) readonly buffer SkinningJobBuffer {
+    SkinningJob jobs[];
+};
+
+layout(std430, binding = 5) readonly buffer BonePaletteBuffer {
+    mat4 bonePalettes[];
+};
+
+// 与 Renderer3D_Model 等着色器中的声明一致
+struct SkinnedVertex {
+    vec4 Position;
+    vec4 Normal;
+    vec4 Tangent;
+};
+
+layout(std430, binding = 19) writeonly buffer SkinnedVertexBuffer {
+    SkinnedVertex skinnedVertices[];
+};
+
+uniform int u_JobOffset; // 作业数超过一次调度的上限时分多次调度
+
+vec3 ReadVec3(uint base, uint offset)
+{
+    return vec3(sourceVertices[base + offset], sourceVertices[base + offset + 1], sourceVertices[base + offset + 2]);
+}
+
+void main()
+{
+    SkinningJob job = jobs[u_JobOffset + int(gl_WorkGroupID.y)];
+    uint vertex = gl_GlobalInvocationID.x;
+    if (vertex >= job.VertexCount)
+        return;
+
+    uint base = uint(job.BaseVertex + int(vertex)) * VERTEX_STRIDE;
+
+    mat4 boneTransform = mat4(0.0);
+    float totalWeight = 0.0;
+    for (int i = 0; i < MAX_BONE_INFLUENCE; i++)
+    {
+        int boneID = floatBitsToInt(sourceVertices[base + 14 + i]);
+        float weight = sourceVertices[base + 18 + i];
+        if (boneID == -1) continue;
+        if (boneID >= MAX_BONES) break;
+
+        boneTransform += bonePalettes[job.PaletteOffset + boneID] * weight;
+        totalWeight += weight;
+    }
+    // 如果没有权重（静态物体），设为单位矩阵
+    if (totalWeight < 0.01) boneTransform = mat4(1.0);
+
+    mat3 boneMat3 = mat3(boneTransform);
+
+    SkinnedVertex result;
+    result.Position = vec4((boneTransform * vec4(ReadVec3(base, 0), 1.0)).xyz, 1.0);
+    result.Normal = vec4(boneMat3 * ReadVec3(base, 3), 0.0);
+    result.Tangent = vec4(boneMat3 * ReadVec3(base, 8), 0.0);
+    skinnedVertices[job.OutputOffset + vertex] = result;
+}
@@ -2,6 +2,7 @@
 
 #type vertex
 #version 450 core
+#extension GL_ARB_shader_draw_parameters : require
 layout (location = 0) in vec3 a_Position;
 layout (location = 1) in vec3 a_Normal;
 layout (location = 2) in vec2 a_TexCoords;
@@ -12,14 +13,21 @@ struct InstanceData {
     mat4 Transform;
     vec4 TintColor;
 
-    // PBR
-	vec4 AlbedoColor;
-	vec4 EmissiveColor;
-	float Roughness;
-	float Metallic;
-	float AO;
+    float TilingFactor;
+    int EntityID;
+    int MaterialIndex; // MaterialBuffer 中的下标
+    int padding_0;
+};
 
-	// 纹理贴图 (对应 Material.h 中的 TextureType 枚举)
+// 材质表，内容相同的材质只保存一份 (与 C++ MaterialData 一致)
+struct MaterialData {
+    vec4 AlbedoColor;
+    vec4 EmissiveColor;
+    float Roughness;
+    float Metallic;
+    float AO;
+
+	// 纹理贴图 (对应 Material.h 中的 TextureType 枚举)，全局纹理表的下标
 	int AlbedoMapIndex;	      // 0
 	int NormalMapIndex;	      // 1
 	int MetallicMapIndex;     // 2
@@ -28,13 +36,17 @@ struct InstanceData {
 	int EmissiveMapIndex;     // 5
 	int HeightMapIndex;	      // 6
 
-    float TilingFactor;
-    int EntityID;
-
     int ReceivesPBR;
 	int ReceivesIBL;
 	int ReceivesLight;
     int ReceivesShadow;
+
+    int padding_0;
+    int padding_1;
+};
+
+layout(std430, binding = 11) readonly buffer MaterialBuffer {
+    MaterialData materials[];
 };
 
 // SSBO Declaration
@@ -42,6 +54,11 @@ layout(std140, binding = 2) readonly buffer InstanceBuffer {
     InstanceData instances[];
 };
 
+// 视锥剔除后的可见实例下标，由 Renderer3D_Cull 或 CPU 写入
+layout(std430, binding = 6) readonly buffer VisibleBuffer {
+    uint visible[];
+};
+
 out VS_OUT 
 {
     vec3 WorldPos;    // 世界空间位置
@@ -76,11 +93,20 @@ out VS_OUT
     flat int ReceivesShadow;
 } vs_out;
 
-uniform mat4 u_ViewProjection;
+// 每帧由 Renderer3D::BeginScene 上传一次，所有程序共用 (与 C++ CameraData 一致)
+layout(std140, binding = 0) uniform Camera {
+    mat4 u_Projection;
+    mat4 u_View;
+    mat4 u_ViewProjection;
+    vec3 u_CameraPosition;
+};
+
+// 深度预通道之后以 GL_EQUAL 测试，位置必须与 Renderer3D_DepthPrepass 逐位一致
+invariant gl_Position;
 
 void main()
 {
-    InstanceData instance = instances[gl_InstanceID];
+    InstanceData instance = instances[visible[gl_BaseInstanceARB + gl_InstanceID]];
 
     mat4 transform  = instance.Transform;
 
@@ -108,36 +134,84 @@ void main()
     gl_Position = u_ViewProjection * worldPos4; // 最终裁剪空间位置
 
     // PBR
-	vs_out.AlbedoColor = instance.AlbedoColor;
-	vs_out.EmissiveColor = instance.EmissiveColor;
-	vs_out.Roughness = instance.Roughness;
-	vs_out.Metallic = instance.Metallic;
-	vs_out.AO = instance.AO;
-
-	vs_out.AlbedoMapIndex = instance.AlbedoMapIndex;
-	vs_out.NormalMapIndex = instance.NormalMapIndex;
-	vs_out.MetallicMapIndex = instance.MetallicMapIndex;
-	vs_out.RoughnessMapIndex = instance.RoughnessMapIndex;
-	vs_out.AoMapIndex = instance.AoMapIndex;
-	vs_out.EmissiveMapIndex = instance.EmissiveMapIndex;
-	vs_out.HeightMapIndex = instance.HeightMapIndex;
+    MaterialData material = materials[instance.MaterialIndex];
+
+	vs_out.AlbedoColor = material.AlbedoColor;
+	vs_out.EmissiveColor = material.EmissiveColor;
+	vs_out.Roughness = material.Roughness;
+	vs_out.Metallic = material.Metallic;
+	vs_out.AO = material.AO;
+
+	vs_out.AlbedoMapIndex = material.AlbedoMapIndex;
+	vs_out.NormalMapIndex = material.NormalMapIndex;
+	vs_out.MetallicMapIndex = material.MetallicMapIndex;
+	vs_out.RoughnessMapIndex = material.RoughnessMapIndex;
+	vs_out.AoMapIndex = material.AoMapIndex;
+	vs_out.EmissiveMapIndex = material.EmissiveMapIndex;
+	vs_out.HeightMapIndex = material.HeightMapIndex;
 
     vs_out.EntityID = instance.EntityID;
 
-    vs_out.ReceivesPBR = instance.ReceivesPBR;
-    vs_out.ReceivesIBL = instance.ReceivesIBL;
-    vs_out.ReceivesLight = instance.ReceivesLight;
-    vs_out.ReceivesShadow = instance.ReceivesShadow;
+    vs_out.ReceivesPBR = material.ReceivesPBR;
+    vs_out.ReceivesIBL = material.ReceivesIBL;
+    vs_out.ReceivesLight = material.ReceivesLight;
+    vs_out.ReceivesShadow = material.ReceivesShadow;
 }
 
 // ===================================================================================================================
 #type fragment
 #version 450 core
+#extension GL_ARB_bindless_texture : enable
+#ifdef DEFERRED_GBUFFER
+layout(location = 0) out vec4 o_GAlbedo;   // rgb: 线性反射率, a: alpha
+layout(location = 1) out vec4 o_GNormal;   // xy: 着色法线, zw: 几何法线 (八面体编码)
+layout(location = 2) out vec4 o_GMaterial; // r: 粗糙度, g: 金属度, b: AO, a: 标志
+layout(location = 3) out vec4 o_GEmissive;
+layout(location = 4) out int o_EntityID;
+#else
 layout(location = 0) out vec4 o_Color;
 layout(location = 1) out int o_EntityID;
+#endif
 
 uniform sampler2D u_Textures[32];
 
+// 贴图下标是全局纹理表的下标
+// 支持 GL_ARB_bindless_texture 时直接索引句柄表，否则先查到当前批次的纹理单元
+#ifdef GL_ARB_bindless_texture
+layout(std430, binding = 10) readonly buffer TextureHandleBuffer {
+    uvec2 textureHandles[];
+};
+uniform bool u_Bindless;
+#endif
+
+layout(std430, binding = 12) readonly buffer TextureSlotBuffer {
+    int textureSlots[];
+};
+
+vec4 SampleMaterialTexture(int index, vec2 texCoords)
+{
+#ifdef GL_ARB_bindless_texture
+    if (u_Bindless)
+        return texture(sampler2D(textureHandles[index]), texCoords);
+#endif
+    return texture(u_Textures[textureSlots[index]], texCoords);
+}
+
+#ifdef DEFERRED_GBUFFER
+// G-buffer 编码 (与 Renderer3D_Model 的 DEFERRED_LIGHTING 变体一致)
+// 法线使用八面体编码，两个法线共用一个 RGBA16F 附件
+vec2 EncodeNormal(vec3 n)
+{
+    n /= abs(n.x) + abs(n.y) + abs(n.z);
+    if (n.z < 0.0)
+        n.xy = (1.0 - abs(n.yx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+    return n.xy;
+}
+
+// 材质附件的 a 通道：低 4 位为 Receives* 标志，第 5 位表示该像素已写入
+const float GBufferFlagScale = 31.0;
+#endif
+
 // IBL
 uniform samplerCube irradianceMap;
 uniform samplerCube prefilterMap;
@@ -181,8 +255,8 @@ in VS_OUT {
 // 光源 Uniforms (与 C++ Renderer3DData 中的定义一致)
 #define MAXLIGHTS 8
 #define MAX_DIRECTIONAL_LIGHTS MAXLIGHTS
-#define MAX_POINT_LIGHTS       MAXLIGHTS
-#define MAX_SPOT_LIGHTS        MAXLIGHTS
+#define MAX_POINT_SHADOWS      MAXLIGHTS
+#define SHADOW_CASCADES        4 // 与 C++ ShadowCascadeCount 一致
 
 struct DirectionalLight {
     vec3 direction; // 光源方向 (通常是从物体指向光源，或约定为光线射来的方向的反方向)
@@ -190,8 +264,10 @@ struct DirectionalLight {
     vec3 color;
     int CastsShadows;
 
-	mat4 LightSpaceMatrix;
-	int ShadowMapIndex;
+	mat4 CascadeMatrices[SHADOW_CASCADES];
+	vec4 CascadeSplits; // 每级级联覆盖到的观察空间深度
+	vec4 CascadeRects[SHADOW_CASCADES]; // 每级级联在阴影图集中的区块 (UV: xy 偏移, zw 大小)
+	int ShadowMapIndex; // -1 表示没有阴影
 	float padding_0;
 	float padding_1;
 	float padding_2;
@@ -220,9 +296,19 @@ struct SpotLight {
 
     mat4 LightSpaceMatrix;
 	float outerConeCos; // 外锥角的余弦值 (cos(InnerConeAngle))
-    int ShadowMapIndex;
+    int ShadowMapIndex; // -1 表示没有阴影
     int CastsShadows;
     float padding_0;
+
+    vec4 AtlasRect; // 在阴影图集中的区块 (UV: xy 偏移, zw 大小)
+};
+
+// 级联选择需要观察空间深度，与顶点着色器共用 Camera 块
+layout(std140, binding = 0) uniform Camera {
+    mat4 u_Projection;
+    mat4 u_View;
+    mat4 u_ViewProjection;
+    vec3 u_CameraPosition;
 };
 
 // SSBO Light
@@ -234,12 +320,45 @@ layout(std430, binding = 1) readonly buffer LightData {
     int NumPointLights;
     int NumSpotLights;
     int padding2;
+
+    uvec4 ClusterDimensions; // xyz: 簇网格大小
+    vec4 ClusterDepthParams; // 深度层 slice = log(viewDepth) * x + y
     
     DirectionalLight DirectionalLights[MAX_DIRECTIONAL_LIGHTS];
-    PointLight PointLights[MAX_POINT_LIGHTS];
-    SpotLight SpotLights[MAX_SPOT_LIGHTS];
 };
 
+// 分簇光照：点光源与聚光灯数量不受限制，每个片元只遍历所在簇的光源
+layout(std430, binding = 15) readonly buffer PointLightBuffer {
+    PointLight PointLights[];
+};
+
+layout(std430, binding = 16) readonly buffer SpotLightBuffer {
+    SpotLight SpotLights[];
+};
+
+// x: 在 clusterLightIndices 中的起始位置, y: 点光源数量, z: 聚光灯数量 (紧跟点光源之后)
+layout(std430, binding = 17) readonly buffer ClusterBuffer {
+    uvec4 clusters[];
+};
+
+layout(std430, binding = 18) readonly buffer ClusterIndexBuffer {
+    uint clusterLightIndices[];
+};
+
+// 与 C++ LightClusterGrid 的划分一致：屏幕按 NDC 均分，深度按指数划分
+uvec4 GetLightCluster(vec3 fragPos)
+{
+    vec4 clip = u_ViewProjection * vec4(fragPos, 1.0);
+    vec2 ndc = clip.xy / clip.w;
+    ivec2 tile = clamp(ivec2(floor((ndc * 0.5 + 0.5) * vec2(ClusterDimensions.xy))), ivec2(0), ivec2(ClusterDimensions.xy) - 1);
+
+    float viewDepth = max(-(u_View * vec4(fragPos, 1.0)).z, 1e-4);
+    int slice = clamp(int(log(viewDepth) * ClusterDepthParams.x + ClusterDepthParams.y), 0, int(ClusterDimensions.z) - 1);
+
+    uint index = uint(tile.x) + ClusterDimensions.x * (uint(tile.y) + ClusterDimensions.y * uint(slice));
+    return clusters[index];
+}
+
 // ----------------------------------------------------------------------------
 // PBR Helper Functions (Cook-Torrance BRDF)
 // ----------------------------------------------------------------------------
@@ -286,9 +405,8 @@ vec3 FresnelSchlickRoughness(float cosTheta, vec3 F0, float roughness)
 }
 
 // ----------------------------------------------------------------------------
-uniform samplerCube u_PointShadowDepthMaps[MAXLIGHTS];
-uniform sampler2D u_DirectionalShadowMaps[MAXLIGHTS];
-uniform sampler2D u_SpotShadowMaps[MAXLIGHTS];
+uniform samplerCube u_PointShadowDepthMaps[MAX_POINT_SHADOWS];
+uniform sampler2D u_ShadowAtlas; // 方向光级联与聚光灯共用的深度图集
 
 vec3 gridSamplingDisk[20] = vec3[]
 (
@@ -301,6 +419,10 @@ vec3 gridSamplingDisk[20] = vec3[]
 
 float CalculatePointShadow(vec3 fragPos, vec3 lightPos, float farPlane, int shadowMapIndex)
 {
+    // 超出阴影数量上限的点光源没有阴影贴图
+    if (shadowMapIndex < 0)
+        return 0.0;
+
     // 从片元指向光源的向量
     vec3 fragToLight = fragPos - lightPos;
     
@@ -343,9 +465,47 @@ float CalculatePointShadow(vec3 fragPos, vec3 lightPos, float farPlane, int shad
 }
 
 
-float CalculateDirectionalShadow(vec3 fragPos, vec3 lightDirection, mat4 lightSpaceMatrix, int shadowMapIndex) 
+// 按观察空间深度选择级联
+int SelectShadowCascade(vec3 fragPos, vec4 cascadeSplits)
+{
+    float viewDepth = -(u_View * vec4(fragPos, 1.0)).z;
+    for (int i = 0; i < SHADOW_CASCADES - 1; ++i)
+    {
+        if (viewDepth < cascadeSplits[i])
+            return i;
+    }
+    return SHADOW_CASCADES - 1;
+}
+
+// 在图集的一个区块内做 3x3 PCF，采样坐标限制在区块内，不会读到相邻光源的深度
+float SampleShadowAtlasPCF(vec4 rect, vec2 uv, float currentDepth, float bias)
+{
+    vec2 texelSize = 1.0 / vec2(textureSize(u_ShadowAtlas, 0));
+    vec2 minUV = rect.xy + texelSize * 0.5;
+    vec2 maxUV = rect.xy + rect.zw - texelSize * 0.5;
+    vec2 center = rect.xy + uv * rect.zw;
+
+    float shadow = 0.0;
+    for (int x = -1; x <= 1; ++x)
+    {
+        for (int y = -1; y <= 1; ++y)
+        {
+            float pcfDepth = texture(u_ShadowAtlas, clamp(center + vec2(x, y) * texelSize, minUV, maxUV)).r;
+            shadow += currentDepth > pcfDepth + bias ? 1.0 : 0.0;
+        }
+    }
+    // 平均化阴影值 (0.0 表示全光照，1.0 表示全阴影)
+    return shadow / 9.0;
+}
+
+float CalculateDirectionalShadow(vec3 fragPos, vec3 lightDirection, DirectionalLight light) 
 { 
-    vec4 lightSpacePos = lightSpaceMatrix * vec4(fragPos, 1.0); 
+    if (light.ShadowMapIndex < 0)
+        return 0.0;
+
+    int cascade = SelectShadowCascade(fragPos, light.CascadeSplits);
+
+    vec4 lightSpacePos = light.CascadeMatrices[cascade] * vec4(fragPos, 1.0); 
     // vec3 projCoords = lightSpacePos.xyz / lightSpacePos.w; 
     vec3 projCoords = lightSpacePos.xyz; 
     projCoords = projCoords * 0.5 + 0.5; 
@@ -357,36 +517,22 @@ float CalculateDirectionalShadow(vec3 fragPos, vec3 lightDirection, mat4 lightSp
         return 1.0;
     }
     
-    float closestDepth = texture(u_DirectionalShadowMaps[shadowMapIndex], projCoords.xy).r; 
     float currentDepth = projCoords.z;
     vec3 n = normalize(fs_in.NormalWS);
     vec3 l = normalize(lightDirection);
     float bias = max(0.01 * (1.0 - dot(n, l)), 0.005);
 
     // --- PCF (Percentage Closer Filtering) 采样 ---
-    float shadow = 0.0;
-    // vec2 texelSize = vec2(1.0 / 2048.0);
-    vec2 texelSize = 1.0 / textureSize(u_DirectionalShadowMaps[shadowMapIndex], 0);
-    int samples = 9;
-    
-    // 3x3 采样循环
-    for (int x = -1; x <= 1; ++x)
-    {
-        for (int y = -1; y <= 1; ++y)
-        {
-            float pcfDepth = texture(u_DirectionalShadowMaps[shadowMapIndex], projCoords.xy + vec2(x, y) * texelSize).r;
-            shadow += currentDepth > pcfDepth + bias ? 1.0 : 0.0;
-        }    
-    }
-    // 平均化阴影值 (0.0 表示全阴影，1.0 表示全光照)
-    shadow /= float(samples);
-    
-    return shadow;
+    return SampleShadowAtlasPCF(light.CascadeRects[cascade], projCoords.xy, currentDepth, bias);
 }
 
-float CalculateSpotShadow(vec3 fragPos, vec3 lightPos, mat4 lightSpaceMatrix, int shadowMapIndex) 
+float CalculateSpotShadow(vec3 fragPos, SpotLight light) 
 { 
-    vec4 lightSpacePos = lightSpaceMatrix * vec4(fragPos, 1.0); 
+    if (light.ShadowMapIndex < 0)
+        return 0.0;
+
+    vec3 lightPos = light.position;
+    vec4 lightSpacePos = light.LightSpaceMatrix * vec4(fragPos, 1.0); 
     vec3 projCoords = lightSpacePos.xyz / lightSpacePos.w; 
     projCoords = projCoords * 0.5 + 0.5; 
 
@@ -397,7 +543,6 @@ float CalculateSpotShadow(vec3 fragPos, vec3 lightPos, mat4 lightSpaceMatrix, in
         return 1.0;
     }
     
-    float closestDepth = texture(u_SpotShadowMaps[shadowMapIndex], projCoords.xy).r; 
     float currentDepth = projCoords.z;
     
     vec3 n = normalize(fs_in.NormalWS);
@@ -405,24 +550,7 @@ float CalculateSpotShadow(vec3 fragPos, vec3 lightPos, mat4 lightSpaceMatrix, in
     float bias = max(0.01 * (1.0 - dot(n, l)), 0.005);
 
     // --- PCF (Percentage Closer Filtering) 采样 ---
-    float shadow = 0.0;
-    // vec2 texelSize = vec2(1.0 / 2048.0);
-    vec2 texelSize = 1.0 / textureSize(u_SpotShadowMaps[shadowMapIndex], 0);
-    int samples = 9;
-    
-    // 3x3 采样循环
-    for (int x = -1; x <= 1; ++x)
-    {
-        for (int y = -1; y <= 1; ++y)
-        {
-            float pcfDepth = texture(u_SpotShadowMaps[shadowMapIndex], projCoords.xy + vec2(x, y) * texelSize).r;
-            shadow += currentDepth > pcfDepth + bias ? 1.0 : 0.0;
-        }    
-    }
-    // 平均化阴影值 (0.0 表示全阴影，1.0 表示全光照)
-    shadow /= float(samples);
-    
-    return shadow;
+    return SampleShadowAtlasPCF(light.AtlasRect, projCoords.xy, currentDepth, bias);
 }
 
 // ----------------------------------------------------------------------------
@@ -436,38 +564,56 @@ void main()
     // 基础颜色 / 反射率 (Albedo)
     vec3 albedo = fs_in.AlbedoColor.rgb * fs_in.TintColor.rgb;
     if (fs_in.AlbedoMapIndex > -1) {
-        albedo *= pow(texture(u_Textures[fs_in.AlbedoMapIndex], fs_in.TexCoords * fs_in.TilingFactor).rgb, vec3(2.2));
+        albedo *= pow(SampleMaterialTexture(fs_in.AlbedoMapIndex, fs_in.TexCoords * fs_in.TilingFactor).rgb, vec3(2.2));
     }
     float alpha = fs_in.AlbedoColor.a * fs_in.TintColor.a;
 
     // 粗糙度：结合贴图和实例数据
     float roughness = fs_in.Roughness;
     if (fs_in.RoughnessMapIndex > -1) {
-        roughness *= texture(u_Textures[fs_in.RoughnessMapIndex], fs_in.TexCoords * fs_in.TilingFactor).r;
+        roughness *= SampleMaterialTexture(fs_in.RoughnessMapIndex, fs_in.TexCoords * fs_in.TilingFactor).r;
     }
     
     // 金属度：结合贴图和实例数据
     float metallic = fs_in.Metallic;
     if (fs_in.MetallicMapIndex > -1) {
-        metallic *= texture(u_Textures[fs_in.MetallicMapIndex], fs_in.TexCoords * fs_in.TilingFactor).r;
+        metallic *= SampleMaterialTexture(fs_in.MetallicMapIndex, fs_in.TexCoords * fs_in.TilingFactor).r;
     }
 
     // 环境光遮蔽 (AO)：结合贴图和实例数据
     float ao = fs_in.AO;
     if (fs_in.AoMapIndex > -1) {
-        ao *= texture(u_Textures[fs_in.AoMapIndex], fs_in.TexCoords * fs_in.TilingFactor).r;
+        ao *= SampleMaterialTexture(fs_in.AoMapIndex, fs_in.TexCoords * fs_in.TilingFactor).r;
     }
 
     // 自发光：结合贴图和实例数据
     vec3 emissive = fs_in.EmissiveColor.rgb;
     if (fs_in.EmissiveMapIndex > -1) {
-        emissive *= texture(u_Textures[fs_in.EmissiveMapIndex], fs_in.TexCoords * fs_in.TilingFactor).rgb;
+        emissive *= SampleMaterialTexture(fs_in.EmissiveMapIndex, fs_in.TexCoords * fs_in.TilingFactor).rgb;
     }
 
     // roughness = texture(u_Textures[fs_in.RoughnessMapIndex], fs_in.TexCoords * fs_in.TilingFactor).r;
     // metallic = texture(u_Textures[fs_in.MetallicMapIndex], fs_in.TexCoords * fs_in.TilingFactor).r;
     // ao = texture(u_Textures[fs_in.AoMapIndex], fs_in.TexCoords * fs_in.TilingFactor).r;
 
+#ifdef DEFERRED_GBUFFER
+    // 只写入表面属性，光照在 Renderer3D_Model 的 DEFERRED_LIGHTING 变体中计算
+    vec3 shadingNormal = normalize(fs_in.NormalWS);
+    if (fs_in.NormalMapIndex > -1) {
+        vec3 normalFromMap = SampleMaterialTexture(fs_in.NormalMapIndex, fs_in.TexCoords * fs_in.TilingFactor).rgb * 2.0 - 1.0;
+        shadingNormal = normalize(fs_in.TBN * normalFromMap);
+    }
+
+    int flags = 16 | (fs_in.ReceivesPBR == 1 ? 1 : 0) | (fs_in.ReceivesIBL == 1 ? 2 : 0) |
+                (fs_in.ReceivesLight == 1 ? 4 : 0) | (fs_in.ReceivesShadow == 1 ? 8 : 0);
+
+    o_GAlbedo = vec4(albedo, alpha);
+    o_GNormal = vec4(EncodeNormal(shadingNormal), EncodeNormal(normalize(fs_in.NormalWS)));
+    o_GMaterial = vec4(roughness, metallic, ao, float(flags) / GBufferFlagScale);
+    o_GEmissive = vec4(emissive, 1.0);
+    return;
+#endif
+
     vec3 finalColor;
 
     if (fs_in.ReceivesLight == 1)
@@ -478,7 +624,7 @@ void main()
 
         if (fs_in.NormalMapIndex > -1) {
             // 假设法线贴图存储在 (0, 1) 范围，需要转换到 (-1, 1)
-            vec3 normalFromMap = texture(u_Textures[fs_in.NormalMapIndex], fs_in.TexCoords * fs_in.TilingFactor).rgb;            
+            vec3 normalFromMap = SampleMaterialTexture(fs_in.NormalMapIndex, fs_in.TexCoords * fs_in.TilingFactor).rgb;            
             normalFromMap = normalFromMap * 2.0 - 1.0;
 
             // 将法线从切线空间转换到世界空间
@@ -487,6 +633,7 @@ void main()
         // --- 遍历所有光源并累加贡献 ---
         vec3 Lo = vec3(0.0); // 累加所有直接光照
         vec3 ambient = 0.03 * albedo * ao;
+        uvec4 cluster = GetLightCluster(fs_in.WorldPos);
 
         if (fs_in.ReceivesPBR == 1)
         {
@@ -544,7 +691,7 @@ void main()
                     float shadow = 0.0;
                     if (fs_in.ReceivesShadow == 1 && light.CastsShadows == 1)
                     {
-                        shadow = CalculateDirectionalShadow(fs_in.WorldPos, L, light.LightSpaceMatrix, light.ShadowMapIndex);
+                        shadow = CalculateDirectionalShadow(fs_in.WorldPos, L, light);
                     }
 
                     Lo += directLightContribution * (1.0 - shadow);
@@ -552,9 +699,9 @@ void main()
             }
 
             // 点光源
-            for (int i = 0; i < NumPointLights; ++i)
+            for (uint i = 0u; i < cluster.y; ++i)
             {
-                PointLight light = PointLights[i];
+                PointLight light = PointLights[clusterLightIndices[cluster.x + i]];
 
                 vec3 lightToPixel = light.position - fs_in.WorldPos;
                 float distance = length(lightToPixel);
@@ -600,9 +747,9 @@ void main()
             }
             
             // 聚光灯
-            for (int i = 0; i < NumSpotLights; ++i)
+            for (uint i = 0u; i < cluster.z; ++i)
             {
-                SpotLight light = SpotLights[i];
+                SpotLight light = SpotLights[clusterLightIndices[cluster.x + cluster.y + i]];
                 
                 vec3 lightToPixel = light.position - fs_in.WorldPos;
                 float distance = length(lightToPixel);
@@ -644,7 +791,7 @@ void main()
                     float shadow = 0.0;
                     if (fs_in.ReceivesShadow == 1 && light.CastsShadows == 1)
                     {
-                        shadow = CalculateSpotShadow(fs_in.WorldPos, light.position, light.LightSpaceMatrix, light.ShadowMapIndex);
+                        shadow = CalculateSpotShadow(fs_in.WorldPos, light);
                     }
 
                     Lo += directLightContribution * (1.0 - shadow);
@@ -687,9 +834,9 @@ void main()
                 
                 Lo += albedo * light.color * light.intensity * NdotL;
             }
-            for (int i = 0; i < NumPointLights; ++i)
+            for (uint i = 0u; i < cluster.y; ++i)
             {
-                PointLight light = PointLights[i];
+                PointLight light = PointLights[clusterLightIndices[cluster.x + i]];
                 vec3 L = normalize(light.position - fs_in.WorldPos);
                 float NdotL = max(dot(N, L), 0.0);
                 
@@ -698,9 +845,9 @@ void main()
 
                 Lo += albedo * light.color * light.intensity * NdotL * attenuation;
             }
-            for (int i = 0; i < NumSpotLights; ++i)
+            for (uint i = 0u; i < cluster.z; ++i)
             {
-                SpotLight light = SpotLights[i];
+                SpotLight light = SpotLights[clusterLightIndices[cluster.x + cluster.y + i]];
                 vec3 L = normalize(light.position - fs_in.WorldPos);
                 float NdotL = max(dot(N, L), 0.0);
                 
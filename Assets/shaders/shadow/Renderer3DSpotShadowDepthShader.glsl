@@ -1,35 +1,51 @@
 #type vertex
 #version 450 core
+#extension GL_ARB_shader_draw_parameters : require
 layout (location = 0) in vec3 a_Position;
 layout (location = 1) in vec3 a_Normal;
-layout (location = 5) in ivec4 a_BoneIDs;
-layout (location = 6) in vec4 a_Weights;
-
-#define MAX_BONES 100
-#define MAX_BONE_INFLUENCE 4
 
 uniform mat4 u_LightSpaceMatrix; 
-uniform mat4 u_Model;
-uniform mat4 u_FinalBoneMatrices[MAX_BONES];
+struct ShadowInstance {
+    mat4 Transform;
+    int SkinnedVertexOffset; // -1 为静态网格
+    int padding_0;
+    int padding_1;
+    int padding_2;
+};
+
+// 所有光源共用的投射阴影实例，按网格分组实例化绘制
+layout(std430, binding = 13) readonly buffer ShadowInstanceBuffer {
+    ShadowInstance shadowInstances[];
+};
+
+// 每个光源剔除后的可见实例，低 26 位为实例下标，高 6 位为点光源的立方体面掩码
+layout(std430, binding = 14) readonly buffer ShadowVisibleBuffer {
+    uint shadowVisible[];
+};
+
+// 与主渲染通道共用的蒙皮结果 (Renderer3D_Skinning)，阴影通道不再重复蒙皮
+struct SkinnedVertex {
+    vec4 Position;
+    vec4 Normal;
+    vec4 Tangent;
+};
+
+layout(std430, binding = 19) readonly buffer SkinnedVertexBuffer {
+    SkinnedVertex skinnedVertices[];
+};
 
 void main()
 {
-    mat4 boneTransform = mat4(0.0f);
-    float totalWeight = 0.0;
-    for (int i = 0; i < MAX_BONE_INFLUENCE; i++)
-    {
-        if (a_BoneIDs[i] == -1) continue;
-        if (a_BoneIDs[i] >= MAX_BONES) break;
-
-        boneTransform += u_FinalBoneMatrices[a_BoneIDs[i]] * a_Weights[i];
-        totalWeight += a_Weights[i];
-    }
-    // 如果没有权重（静态物体），设为单位矩阵
-    if (totalWeight < 0.01) boneTransform = mat4(1.0);
-
-    vec4 localAnimatedPos = boneTransform * vec4(a_Position, 1.0);
-
-    vec4 worldPos4 = u_Model * localAnimatedPos;
+    uint entry = shadowVisible[gl_BaseInstanceARB + gl_InstanceID];
+    ShadowInstance instance = shadowInstances[entry & 0x03FFFFFFu];
+
+    // gl_VertexID 包含 BaseVertex，减去后为网格内的顶点下标
+    vec3 animatedPosition = a_Position;
+    if (instance.SkinnedVertexOffset >= 0)
+        animatedPosition = skinnedVertices[instance.SkinnedVertexOffset + gl_VertexID - gl_BaseVertexARB].Position.xyz;
+    vec4 localAnimatedPos = vec4(animatedPosition, 1.0);
+
+    vec4 worldPos4 = instance.Transform * localAnimatedPos;
     gl_Position = u_LightSpaceMatrix * worldPos4;
 }
 
@@ -0,0 +1,120 @@
+// CPU 蒙皮的基准测试: 合成的蒙皮网格 (每个顶点 4 个骨骼影响) 用 CpuSkinner::Skin 蒙皮，输出每核每秒的顶点数
+// 不需要 GL 上下文，用法: CpuSkinningBenchmark [每个网格的顶点数] [网格数] [帧数] [线程数，0 为所有硬件线程]
+// MC_DISABLE_AVX=1 时使用标量路径，用于对比
+#include "src/Core/CpuFeatures.h"
+#include "src/Renderer/CpuSkinner.h"
+#include "src/Renderer/Mesh.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+using namespace Mc;
+
+namespace
+{
+    // 顶点随机分布在单位立方体内，骨骼和权重随机，权重和为 1
+    std::vector<ModelVertex> MakeMesh(uint32_t vertexCount, std::mt19937 &random)
+    {
+        std::uniform_real_distribution<float> position(-1.0f, 1.0f);
+        std::uniform_real_distribution<float> weight(0.0f, 1.0f);
+        std::uniform_int_distribution<int> bone(0, (int)CpuSkinner::MaxBones - 1);
+
+        std::vector<ModelVertex> vertices(vertexCount);
+        for (ModelVertex &vertex : vertices)
+        {
+            vertex.Position = glm::vec3(position(random), position(random), position(random));
+            vertex.Normal = glm::normalize(vertex.Position + glm::vec3(0.0f, 0.0f, 2.0f));
+            vertex.Tangent = glm::vec3(1.0f, 0.0f, 0.0f);
+
+            glm::vec4 weights(weight(random), weight(random), weight(random), weight(random));
+            vertex.Weights = weights / (weights.x + weights.y + weights.z + weights.w);
+            vertex.BoneIDs = glm::ivec4(bone(random), bone(random), bone(random), bone(random));
+        }
+        return vertices;
+    }
+
+    std::vector<glm::mat4> MakePalette(float time)
+    {
+        std::vector<glm::mat4> palette(CpuSkinner::MaxBones);
+        for (uint32_t i = 0; i < CpuSkinner::MaxBones; i++)
+        {
+            float angle = time + (float)i * 0.1f;
+            glm::mat4 &bone = palette[i];
+            bone = glm::mat4(1.0f);
+            bone[0][0] = std::cos(angle);
+            bone[0][2] = -std::sin(angle);
+            bone[2][0] = std::sin(angle);
+            bone[2][2] = std::cos(angle);
+            bone[3] = glm::vec4(0.0f, (float)i * 0.01f, 0.0f, 1.0f);
+        }
+        return palette;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t vertexCount = argc > 1 ? (uint32_t)std::atoi(argv[1]) : 20000;
+    uint32_t meshCount = argc > 2 ? (uint32_t)std::atoi(argv[2]) : 16;
+    uint32_t frames = argc > 3 ? (uint32_t)std::atoi(argv[3]) : 100;
+    uint32_t threads = argc > 4 ? (uint32_t)std::atoi(argv[4]) : 0;
+
+    // 固定种子，结果可复现
+    std::mt19937 random(1234);
+
+    CpuSkinner skinner;
+    skinner.SetThreadCount(threads);
+
+    for (uint32_t mesh = 0; mesh < meshCount; mesh++)
+    {
+        std::vector<ModelVertex> vertices = MakeMesh(vertexCount, random);
+        skinner.AddMesh(mesh + 1, vertices.data(), vertexCount);
+    }
+
+    // 每个网格一份调色板和输出，与 Renderer3D 中每个动画实体一份调色板相同
+    std::vector<std::vector<glm::mat4>> palettes(meshCount);
+    std::vector<std::vector<SkinnedVertex>> outputs(meshCount, std::vector<SkinnedVertex>(vertexCount));
+    std::vector<CpuSkinner::Job> jobs(meshCount);
+
+    // 预热: 启动工作线程
+    for (uint32_t mesh = 0; mesh < meshCount; mesh++)
+    {
+        palettes[mesh] = MakePalette((float)mesh);
+        jobs[mesh] = { mesh + 1, palettes[mesh].data(), outputs[mesh].data() };
+    }
+    skinner.Skin(jobs);
+
+    double milliseconds = 0.0;
+    uint64_t skinnedVertices = 0;
+    for (uint32_t frame = 0; frame < frames; frame++)
+    {
+        for (uint32_t mesh = 0; mesh < meshCount; mesh++)
+            palettes[mesh] = MakePalette((float)frame * 0.016f + (float)mesh);
+
+        skinner.Skin(jobs);
+        milliseconds += skinner.GetStats().Milliseconds;
+        skinnedVertices += skinner.GetStats().Vertices;
+    }
+
+    // 防止结果被优化掉，同时检查输出有效
+    double checksum = 0.0;
+    for (const auto &output : outputs)
+        checksum += output[0].Position.x + output[vertexCount - 1].Position.y;
+    if (!std::isfinite(checksum))
+    {
+        printf("CpuSkinningBenchmark: non-finite output\n");
+        return 1;
+    }
+
+    uint32_t cores = skinner.GetStats().Threads;
+    double verticesPerSecond = (double)skinnedVertices / (milliseconds * 0.001);
+
+    printf("CpuSkinningBenchmark: %u meshes x %u vertices, %u frames, %u threads, %s path\n",
+           meshCount, vertexCount, frames, cores, CpuFeatures::HasAVX2() ? "AVX2" : "scalar");
+    printf("  skin:      %.3f ms/frame\n", milliseconds / (double)frames);
+    printf("  vertices:  %.2f M/s, %.2f M/s/core\n", verticesPerSecond * 1e-6, verticesPerSecond * 1e-6 / (double)cores);
+
+    return 0;
+}
@@ -215,7 +215,6 @@ namespace Mc
         // ImGui::End();
         // ---------------------------------------------------------------------------------------------------------
 
-        /*
         ImGui::PushStyleColor(ImGuiCol_WindowBg, ImVec4(0.15f, 0.15f, 0.15f, 1.0f));
         ImGui::Begin("Stats");
         ImGui::PopStyleColor();
@@ -227,13 +226,87 @@ namespace Mc
         ImGui::Text("Hovered Entity: %s", name.c_str());
 
         auto stats = Renderer3D::GetStats();
-        ImGui::Text("Renderer2D Stats:");
+        ImGui::Text("Renderer3D Stats:");
         ImGui::Text("Draw Calls: %d", stats.DrawCalls);
-        ImGui::Text("Sphere: %d", stats.SphereCount / 2);
-        ImGui::Text("Model: %d", stats.ModelCount / 2);
+        ImGui::Text("Shadow Draw Calls: %d", stats.ShadowDrawCalls);
+        ImGui::Text("Sphere: %d", stats.SphereCount);
+        ImGui::Text("Model: %d", stats.ModelCount);
+        ImGui::Text("Mesh Batches: %d", stats.MeshCount);
+        ImGui::Text("Materials: %d", stats.MaterialCount);
+        ImGui::Text("GL Buffer Allocations: %d", stats.BufferAllocations);
+        ImGui::Text("GL State Calls: %d issued, %d filtered", stats.StateCallsIssued, stats.StateCallsFiltered);
+
+        uint32_t submitted = stats.SphereCount + stats.ModelCount;
+        ImGui::Text("Submit: %.3f ms (%.3f us/draw)", stats.SubmitTime, submitted ? stats.SubmitTime * 1000.0f / submitted : 0.0f);
+
+        bool bindless = Renderer3D::IsBindlessTextures();
+        if (ImGui::Checkbox("Bindless Textures", &bindless))
+            Renderer3D::SetBindlessTextures(bindless);
+
+        const char *cullingModes[] = {"None", "CPU", "GPU"};
+        int cullingMode = (int)Renderer3D::GetCullingMode();
+        if (ImGui::Combo("Culling", &cullingMode, cullingModes, IM_ARRAYSIZE(cullingModes)))
+            Renderer3D::SetCullingMode((Renderer3D::CullingMode)cullingMode);
+        ImGui::Text("Culled Instances (CPU): %d", stats.CulledInstances);
+
+        const char *renderPaths[] = {"Forward", "Deferred"};
+        int renderPath = (int)Renderer3D::GetRenderPath();
+        if (ImGui::Combo("Render Path", &renderPath, renderPaths, IM_ARRAYSIZE(renderPaths)))
+            Renderer3D::SetRenderPath((Renderer3D::RenderPath)renderPath);
+
+        bool depthPrepass = Renderer3D::IsDepthPrepass();
+        if (ImGui::Checkbox("Depth Pre-Pass", &depthPrepass))
+            Renderer3D::SetDepthPrepass(depthPrepass);
+        ImGui::Text("Overdraw: %.2fx", stats.Overdraw);
+        ImGui::Text("GPU: pre-pass %.3f ms, main pass %.3f ms", stats.DepthPrepassTime, stats.ForwardPassTime);
+
+        bool drawSorting = Renderer3D::IsDrawSorting();
+        if (ImGui::Checkbox("Draw Sorting", &drawSorting))
+            Renderer3D::SetDrawSorting(drawSorting);
+        ImGui::Text("Sorted Draws: %d (%d merged), sort %.3f ms", stats.SortedDraws, stats.MergedDraws, stats.DrawSortTime);
+
+        const char *skinningModes[] = {"GPU", "CPU"};
+        int skinningMode = (int)Renderer3D::GetSkinningMode();
+        if (ImGui::Combo("Skinning", &skinningMode, skinningModes, IM_ARRAYSIZE(skinningModes)))
+            Renderer3D::SetSkinningMode((Renderer3D::SkinningMode)skinningMode);
+        if (Renderer3D::GetSkinningMode() == Renderer3D::SkinningMode::CPU)
+        {
+            int skinningThreads = (int)Renderer3D::GetCpuSkinningThreads();
+            if (ImGui::SliderInt("Skinning Threads (0 = all)", &skinningThreads, 0, 64))
+                Renderer3D::SetCpuSkinningThreads((uint32_t)skinningThreads);
+
+            // 吞吐量: 顶点 / 秒 / 线程
+            float perCore = stats.CpuSkinningTime > 0.0f && stats.CpuSkinningThreads > 0
+                                ? stats.SkinnedVertices / (stats.CpuSkinningTime * 1e-3f) / stats.CpuSkinningThreads
+                                : 0.0f;
+            ImGui::Text("CPU Skinning: %d vertices, %.3f ms, %d threads, %.2f M vertices/s/core", stats.SkinnedVertices, stats.CpuSkinningTime,
+                        stats.CpuSkinningThreads, perCore * 1e-6f);
+        }
+        else
+            ImGui::Text("GPU Skinning: %d vertices, %d dispatches", stats.SkinnedVertices, stats.SkinningDispatches);
+        ImGui::Text("Scene Culled: %d", stats.SceneCulled);
+        for (uint32_t i = 0; i < stats.PassCount; i++)
+        {
+            if (stats.PassCpuTime[i] < 0.0f)
+                ImGui::Text("Pass %s: culled", stats.PassNames[i]);
+            else
+                ImGui::Text("Pass %s: CPU %.3f ms, GPU %.3f ms", stats.PassNames[i], stats.PassCpuTime[i], stats.PassGpuTime[i]);
+        }
+        ImGui::Text("Lights: %d point, %d spot, %d cluster indices", stats.PointLights, stats.SpotLights, stats.ClusterLightIndices);
+
+        ImGui::Text("Shadow Casters: %d", stats.ShadowCasters);
+        ImGui::Text("Shadow Maps: %d rendered, %d cached, %d deferred", stats.ShadowMapsRendered, stats.ShadowMapsCached, stats.ShadowMapsDeferred);
+
+        int shadowUpdateMaps = (int)Renderer3D::GetShadowUpdateMaxMaps();
+        float shadowUpdateBudget = Renderer3D::GetShadowUpdateBudgetMs();
+        bool shadowBudgetChanged = ImGui::DragInt("Shadow Updates / Frame", &shadowUpdateMaps, 1.0f, 0, 24);
+        shadowBudgetChanged |= ImGui::DragFloat("Shadow Budget (ms)", &shadowUpdateBudget, 0.05f, 0.0f, 16.0f, "%.2f");
+        if (shadowBudgetChanged)
+            Renderer3D::SetShadowUpdateBudget((uint32_t)shadowUpdateMaps, shadowUpdateBudget);
+        for (uint32_t i = 0; i < stats.ShadowLightCount; i++)
+            ImGui::Text("  %c Light %d: culled %d", stats.ShadowLightTypes[i], i, stats.ShadowCastersCulled[i]);
 
         ImGui::End();
-        */
 
         // ---------------------------------------------------------------------------------------------------------
         ImGui::PushStyleVar(ImGuiStyleVar_WindowPadding, ImVec2{0, 0});
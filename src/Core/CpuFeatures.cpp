@@ -0,0 +1,73 @@
+#include "CpuFeatures.h"
+
+#include <cstdlib>
+#include <cstring>
+
+#if defined(MC_SIMD_X86) && defined(_MSC_VER) && !defined(__clang__)
+    #include <intrin.h>
+    #include <immintrin.h>
+#endif
+
+namespace Mc::CpuFeatures
+{
+    namespace
+    {
+        struct Features
+        {
+            bool AVX = false;
+            bool AVX2 = false;
+        };
+
+        Features Detect()
+        {
+            Features features;
+
+            const char *disable = std::getenv("MC_DISABLE_AVX");
+            if (disable && strcmp(disable, "0") != 0)
+                return features;
+
+#if defined(MC_SIMD_X86)
+    #if defined(_MSC_VER) && !defined(__clang__)
+            int info[4];
+            __cpuid(info, 0);
+            int maxLeaf = info[0];
+
+            // CPUID.1:ECX 的 OSXSAVE (27) 与 AVX (28)，并且操作系统在上下文切换时保存 XMM/YMM
+            __cpuid(info, 1);
+            bool osxsave = (info[2] & (1 << 27)) != 0;
+            bool avx = (info[2] & (1 << 28)) != 0;
+            features.AVX = avx && osxsave && (_xgetbv(0) & 0x6) == 0x6;
+
+            // CPUID.7:EBX 的 AVX2 (5)
+            if (features.AVX && maxLeaf >= 7)
+            {
+                __cpuidex(info, 7, 0);
+                features.AVX2 = (info[1] & (1 << 5)) != 0;
+            }
+    #else
+            __builtin_cpu_init();
+            features.AVX = __builtin_cpu_supports("avx");
+            features.AVX2 = __builtin_cpu_supports("avx2");
+    #endif
+#endif
+
+            return features;
+        }
+
+        const Features &GetFeatures()
+        {
+            static const Features features = Detect();
+            return features;
+        }
+    }
+
+    bool HasAVX()
+    {
+        return GetFeatures().AVX;
+    }
+
+    bool HasAVX2()
+    {
+        return GetFeatures().AVX2;
+    }
+}
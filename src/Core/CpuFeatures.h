@@ -0,0 +1,24 @@
+#pragma once
+
+// x86 的 SIMD 指令集
+// 只靠编译期的 __AVX__ / __AVX2__ 判断时，默认构建 (没有 -mavx2 或 /arch:AVX2) 永远停留在基线指令集
+// 需要更宽指令集的代码单独写成以 MC_TARGET_AVX / MC_TARGET_AVX2 标记的函数，每次构建都会编译，
+// 运行时按这里的检测结果选择; 环境变量 MC_DISABLE_AVX=1 强制使用基线路径，用于对比与测试
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+    #define MC_SIMD_X86
+    #if defined(_MSC_VER) && !defined(__clang__)
+        // MSVC 的内建函数不需要为单个函数开启指令集
+        #define MC_TARGET_AVX
+        #define MC_TARGET_AVX2
+    #else
+        #define MC_TARGET_AVX __attribute__((target("avx")))
+        #define MC_TARGET_AVX2 __attribute__((target("avx2")))
+    #endif
+#endif
+
+namespace Mc::CpuFeatures
+{
+    // CPU 与操作系统 (保存 YMM 寄存器) 都支持时返回 true，结果在第一次调用时检测并缓存
+    bool HasAVX();
+    bool HasAVX2();
+}
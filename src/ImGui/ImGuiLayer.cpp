@@ -1,6 +1,7 @@
 #include "src/ImGui/ImGuiLayer.h"
 
 #include "src/Core/Application.h"
+#include "src/Renderer/GLState.h"
 
 #include <imgui.h>
 #include <backends/imgui_impl_glfw.h>
@@ -111,6 +112,9 @@ namespace Mc {
 			ImGui::RenderPlatformWindowsDefault();
 			glfwMakeContextCurrent(backup_current_context);
 		}
+
+		// ImGui 直接调用 GL，缓存的状态不再可信
+		GLState::Invalidate();
 	}
 
 	void ImGuiLayer::SetDarkThemeColors()
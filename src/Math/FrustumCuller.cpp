@@ -0,0 +1,215 @@
+#include "FrustumCuller.h"
+
+#include "src/Core/CpuFeatures.h"
+
+#include <limits>
+
+// SSE 是 x86-64 的基线，AVX 路径单独编译，运行时按 CPU 选择
+#if defined(MC_SIMD_X86)
+    #include <immintrin.h>
+    #define MC_FRUSTUM_AVX
+#endif
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+    #include <xmmintrin.h>
+    #define MC_FRUSTUM_SSE
+#endif
+
+namespace Mc::Math
+{
+    namespace
+    {
+        // 包围球按 SoA 存放，count 为 8 的整数倍
+        struct CullInput
+        {
+            const float *CenterX;
+            const float *CenterY;
+            const float *CenterZ;
+            const float *Radius;
+            uint8_t *Visible;
+            uint32_t Count;
+        };
+
+#if defined(MC_FRUSTUM_AVX)
+        MC_TARGET_AVX void CullAVX(const Frustum &frustum, const CullInput &input)
+        {
+            __m256 planeX[6], planeY[6], planeZ[6], planeW[6];
+            for (int p = 0; p < 6; p++)
+            {
+                planeX[p] = _mm256_set1_ps(frustum.Planes[p].x);
+                planeY[p] = _mm256_set1_ps(frustum.Planes[p].y);
+                planeZ[p] = _mm256_set1_ps(frustum.Planes[p].z);
+                planeW[p] = _mm256_set1_ps(frustum.Planes[p].w);
+            }
+
+            const __m256 zero = _mm256_setzero_ps();
+            for (uint32_t i = 0; i < input.Count; i += 8)
+            {
+                __m256 x = _mm256_loadu_ps(&input.CenterX[i]);
+                __m256 y = _mm256_loadu_ps(&input.CenterY[i]);
+                __m256 z = _mm256_loadu_ps(&input.CenterZ[i]);
+                __m256 negRadius = _mm256_sub_ps(zero, _mm256_loadu_ps(&input.Radius[i]));
+
+                // 到任意平面的距离小于 -radius 即在视锥外
+                __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+                for (int p = 0; p < 6; p++)
+                {
+                    __m256 distance = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(planeX[p], x), _mm256_mul_ps(planeY[p], y)),
+                                                    _mm256_add_ps(_mm256_mul_ps(planeZ[p], z), planeW[p]));
+                    inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, negRadius, _CMP_GE_OQ));
+                }
+
+                int mask = _mm256_movemask_ps(inside);
+                for (uint32_t k = 0; k < 8; k++)
+                    input.Visible[i + k] = (uint8_t)((mask >> k) & 1);
+            }
+        }
+#endif
+
+#if defined(MC_FRUSTUM_SSE)
+        void CullSSE(const Frustum &frustum, const CullInput &input)
+        {
+            __m128 planeX[6], planeY[6], planeZ[6], planeW[6];
+            for (int p = 0; p < 6; p++)
+            {
+                planeX[p] = _mm_set1_ps(frustum.Planes[p].x);
+                planeY[p] = _mm_set1_ps(frustum.Planes[p].y);
+                planeZ[p] = _mm_set1_ps(frustum.Planes[p].z);
+                planeW[p] = _mm_set1_ps(frustum.Planes[p].w);
+            }
+
+            const __m128 zero = _mm_setzero_ps();
+            for (uint32_t i = 0; i < input.Count; i += 4)
+            {
+                __m128 x = _mm_loadu_ps(&input.CenterX[i]);
+                __m128 y = _mm_loadu_ps(&input.CenterY[i]);
+                __m128 z = _mm_loadu_ps(&input.CenterZ[i]);
+                __m128 negRadius = _mm_sub_ps(zero, _mm_loadu_ps(&input.Radius[i]));
+
+                // 到任意平面的距离小于 -radius 即在视锥外
+                __m128 inside = _mm_cmpeq_ps(zero, zero);
+                for (int p = 0; p < 6; p++)
+                {
+                    __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(planeX[p], x), _mm_mul_ps(planeY[p], y)),
+                                                 _mm_add_ps(_mm_mul_ps(planeZ[p], z), planeW[p]));
+                    inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, negRadius));
+                }
+
+                int mask = _mm_movemask_ps(inside);
+                for (uint32_t k = 0; k < 4; k++)
+                    input.Visible[i + k] = (uint8_t)((mask >> k) & 1);
+            }
+        }
+#endif
+
+#if !defined(MC_FRUSTUM_SSE)
+        void CullScalar(const Frustum &frustum, const CullInput &input)
+        {
+            for (uint32_t i = 0; i < input.Count; i++)
+            {
+                bool inside = true;
+                for (int p = 0; p < 6 && inside; p++)
+                {
+                    const glm::vec4 &plane = frustum.Planes[p];
+                    inside = plane.x * input.CenterX[i] + plane.y * input.CenterY[i] + plane.z * input.CenterZ[i] + plane.w >= -input.Radius[i];
+                }
+                input.Visible[i] = (uint8_t)inside;
+            }
+        }
+#endif
+    }
+
+    Frustum Frustum::FromViewProjection(const glm::mat4 &viewProjection)
+    {
+        glm::vec4 row0(viewProjection[0][0], viewProjection[1][0], viewProjection[2][0], viewProjection[3][0]);
+        glm::vec4 row1(viewProjection[0][1], viewProjection[1][1], viewProjection[2][1], viewProjection[3][1]);
+        glm::vec4 row2(viewProjection[0][2], viewProjection[1][2], viewProjection[2][2], viewProjection[3][2]);
+        glm::vec4 row3(viewProjection[0][3], viewProjection[1][3], viewProjection[2][3], viewProjection[3][3]);
+
+        Frustum frustum;
+        frustum.Planes[0] = row3 + row0; // left
+        frustum.Planes[1] = row3 - row0; // right
+        frustum.Planes[2] = row3 + row1; // bottom
+        frustum.Planes[3] = row3 - row1; // top
+        frustum.Planes[4] = row3 + row2; // near
+        frustum.Planes[5] = row3 - row2; // far
+
+        for (auto &plane : frustum.Planes)
+            plane /= glm::length(glm::vec3(plane));
+
+        return frustum;
+    }
+
+    glm::vec4 TransformBoundingSphere(const glm::mat4 &transform, const glm::vec4 &localSphere)
+    {
+        glm::vec3 center = glm::vec3(transform * glm::vec4(glm::vec3(localSphere), 1.0f));
+        float scale = glm::max(glm::max(glm::length(glm::vec3(transform[0])), glm::length(glm::vec3(transform[1]))), glm::length(glm::vec3(transform[2])));
+        return glm::vec4(center, localSphere.w * scale);
+    }
+
+    void FrustumCuller::Clear()
+    {
+        m_CenterX.clear();
+        m_CenterY.clear();
+        m_CenterZ.clear();
+        m_Radius.clear();
+        m_Count = 0;
+    }
+
+    uint32_t FrustumCuller::Add(const glm::vec3 &center, float radius)
+    {
+        m_CenterX.push_back(center.x);
+        m_CenterY.push_back(center.y);
+        m_CenterZ.push_back(center.z);
+        m_Radius.push_back(radius);
+        return m_Count++;
+    }
+
+    uint32_t FrustumCuller::Add(const glm::mat4 &transform, const glm::vec4 &localSphere)
+    {
+        glm::vec4 sphere = TransformBoundingSphere(transform, localSphere);
+        return Add(glm::vec3(sphere), sphere.w);
+    }
+
+    uint32_t FrustumCuller::AddAlwaysVisible()
+    {
+        return Add(glm::vec3(0.0f), std::numeric_limits<float>::infinity());
+    }
+
+    uint32_t FrustumCuller::Cull(const Frustum &frustum)
+    {
+        // 补齐到 8 的整数倍，SIMD 循环不需要处理尾部
+        uint32_t padded = (m_Count + 7) & ~7u;
+        m_CenterX.resize(padded, 0.0f);
+        m_CenterY.resize(padded, 0.0f);
+        m_CenterZ.resize(padded, 0.0f);
+        m_Radius.resize(padded, 0.0f);
+        m_Visible.resize(padded);
+
+        CullInput input = { m_CenterX.data(), m_CenterY.data(), m_CenterZ.data(), m_Radius.data(), m_Visible.data(), padded };
+#if defined(MC_FRUSTUM_AVX)
+        if (CpuFeatures::HasAVX())
+        {
+            CullAVX(frustum, input);
+        }
+        else
+#endif
+        {
+#if defined(MC_FRUSTUM_SSE)
+            CullSSE(frustum, input);
+#else
+            CullScalar(frustum, input);
+#endif
+        }
+
+        uint32_t visibleCount = 0;
+        for (uint32_t i = 0; i < m_Count; i++)
+            visibleCount += m_Visible[i];
+
+        m_CenterX.resize(m_Count);
+        m_CenterY.resize(m_Count);
+        m_CenterZ.resize(m_Count);
+        m_Radius.resize(m_Count);
+
+        return m_Count - visibleCount;
+    }
+}
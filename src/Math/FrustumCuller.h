@@ -0,0 +1,48 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace Mc::Math
+{
+    // 六个视锥平面 (left, right, bottom, top, near, far)，法线指向视锥内侧并归一化
+    struct Frustum
+    {
+        glm::vec4 Planes[6];
+
+        static Frustum FromViewProjection(const glm::mat4 &viewProjection);
+    };
+
+    // 局部空间包围球 (xyz 球心, w 半径) 变换到世界空间，半径按最大缩放放大
+    glm::vec4 TransformBoundingSphere(const glm::mat4 &transform, const glm::vec4 &localSphere);
+
+    // 世界空间包围球按 SoA 存放，Cull 时每次迭代测试 4 个 (SSE) 或 8 个 (AVX，运行时按 CPU 选择)
+    class FrustumCuller
+    {
+    public:
+        void Clear();
+
+        // 返回包围球的下标，用于之后查询 IsVisible
+        uint32_t Add(const glm::vec3 &center, float radius);
+        // 局部空间包围球 (xyz 球心, w 半径) 经 transform 变换后加入，半径按最大缩放放大
+        uint32_t Add(const glm::mat4 &transform, const glm::vec4 &localSphere);
+        // 总是可见 (例如蒙皮网格，包围体未知)
+        uint32_t AddAlwaysVisible();
+
+        // 返回被剔除的数量
+        uint32_t Cull(const Frustum &frustum);
+
+        bool IsVisible(uint32_t index) const { return m_Visible[index] != 0; }
+        uint32_t GetCount() const { return m_Count; }
+
+    private:
+        std::vector<float> m_CenterX;
+        std::vector<float> m_CenterY;
+        std::vector<float> m_CenterZ;
+        std::vector<float> m_Radius;
+        std::vector<uint8_t> m_Visible;
+        uint32_t m_Count = 0;
+    };
+}
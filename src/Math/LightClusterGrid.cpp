@@ -0,0 +1,247 @@
+#include "LightClusterGrid.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+    #include <xmmintrin.h>
+    #define MC_CLUSTER_SSE
+#endif
+
+namespace Mc::Math
+{
+    void LightClusterGrid::LightSet::Clear()
+    {
+        CenterX.clear();
+        CenterY.clear();
+        CenterZ.clear();
+        Radius.clear();
+        Count = 0;
+    }
+
+    void LightClusterGrid::LightSet::Add(const glm::vec3 &center, float radius)
+    {
+        CenterX.push_back(center.x);
+        CenterY.push_back(center.y);
+        CenterZ.push_back(center.z);
+        Radius.push_back(radius);
+        Count++;
+    }
+
+    void LightClusterGrid::Clear()
+    {
+        m_PointLights.Clear();
+        m_SpotLights.Clear();
+    }
+
+    void LightClusterGrid::AddPointLight(const glm::vec3 &center, float radius)
+    {
+        m_PointLights.Add(center, radius);
+    }
+
+    void LightClusterGrid::AddSpotLight(const glm::vec3 &center, float radius)
+    {
+        m_SpotLights.Add(center, radius);
+    }
+
+    void LightClusterGrid::Build(const glm::mat4 &view, const glm::mat4 &projection, float nearPlane, float farPlane)
+    {
+        // 正交相机的近平面可能不为正，深度层从一个很小的正数开始
+        m_NearPlane = nearPlane;
+        m_FarPlane = farPlane;
+        float sliceNear = std::max(nearPlane, 0.1f);
+        float sliceFar = std::max(farPlane, sliceNear * 2.0f);
+        float logRatio = std::log(sliceFar / sliceNear);
+        m_DepthParams.x = (float)DimZ / logRatio;
+        m_DepthParams.y = -(float)DimZ * std::log(sliceNear) / logRatio;
+        m_SliceNear = sliceNear;
+
+        ComputeBounds(m_PointLights, view, projection);
+        ComputeBounds(m_SpotLights, view, projection);
+        ComputeClusterRanges(m_PointLights);
+        ComputeClusterRanges(m_SpotLights);
+
+        // 第一遍统计每个簇的光源数量，前缀和得到起始位置，第二遍写入下标
+        m_Clusters.assign(ClusterCount, Cluster(0u));
+        CountLights(m_PointLights, 1);
+        CountLights(m_SpotLights, 2);
+
+        uint32_t offset = 0;
+        for (auto &cluster : m_Clusters)
+        {
+            cluster.x = offset;
+            offset += cluster.y + cluster.z;
+        }
+        m_LightIndices.resize(offset);
+
+        m_Cursor.resize(ClusterCount);
+        for (uint32_t i = 0; i < ClusterCount; i++)
+            m_Cursor[i] = m_Clusters[i].x;
+        WriteLightIndices(m_PointLights);
+
+        for (uint32_t i = 0; i < ClusterCount; i++)
+            m_Cursor[i] = m_Clusters[i].x + m_Clusters[i].y;
+        WriteLightIndices(m_SpotLights);
+    }
+
+    void LightClusterGrid::ComputeBounds(LightSet &lights, const glm::mat4 &view, const glm::mat4 &projection)
+    {
+        // 透视投影: ndc = P[0][0] * x / depth - P[2][0]，正交投影: ndc = P[0][0] * x + P[3][0]
+        // 包围球的 x 范围除以最近、最远深度后取最小/最大值，得到保守的屏幕包围盒
+        bool perspective = projection[2][3] != 0.0f;
+        glm::vec2 scale(projection[0][0], projection[1][1]);
+        glm::vec2 bias = perspective ? -glm::vec2(projection[2][0], projection[2][1]) : glm::vec2(projection[3][0], projection[3][1]);
+
+        // 补齐到 4 的整数倍，SIMD 循环不需要处理尾部
+        uint32_t padded = (lights.Count + 3) & ~3u;
+        lights.CenterX.resize(padded, 0.0f);
+        lights.CenterY.resize(padded, 0.0f);
+        lights.CenterZ.resize(padded, 0.0f);
+        lights.Radius.resize(padded, 0.0f);
+        lights.ScreenBounds.resize(padded);
+        lights.DepthRange.resize(padded);
+
+#if defined(MC_CLUSTER_SSE)
+        __m128 viewRow[3][4];
+        for (int r = 0; r < 3; r++)
+            for (int c = 0; c < 4; c++)
+                viewRow[r][c] = _mm_set1_ps(view[c][r]);
+
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 one = _mm_set1_ps(1.0f);
+        const __m128 nearPlane = _mm_set1_ps(m_SliceNear);
+        const __m128 scaleX = _mm_set1_ps(scale.x), scaleY = _mm_set1_ps(scale.y);
+        const __m128 biasX = _mm_set1_ps(bias.x), biasY = _mm_set1_ps(bias.y);
+
+        alignas(16) float minX[4], minY[4], maxX[4], maxY[4], depthMin[4], depthMax[4];
+        for (uint32_t i = 0; i < padded; i += 4)
+        {
+            __m128 x = _mm_loadu_ps(&lights.CenterX[i]);
+            __m128 y = _mm_loadu_ps(&lights.CenterY[i]);
+            __m128 z = _mm_loadu_ps(&lights.CenterZ[i]);
+            __m128 radius = _mm_loadu_ps(&lights.Radius[i]);
+
+            __m128 v[3];
+            for (int r = 0; r < 3; r++)
+                v[r] = _mm_add_ps(_mm_add_ps(_mm_mul_ps(viewRow[r][0], x), _mm_mul_ps(viewRow[r][1], y)),
+                                  _mm_add_ps(_mm_mul_ps(viewRow[r][2], z), viewRow[r][3]));
+
+            __m128 depth = _mm_sub_ps(zero, v[2]);
+            __m128 nearDepth = _mm_sub_ps(depth, radius);
+            __m128 farDepth = _mm_add_ps(depth, radius);
+
+            __m128 invNear = one, invFar = one;
+            if (perspective)
+            {
+                invNear = _mm_div_ps(one, _mm_max_ps(nearDepth, nearPlane));
+                invFar = _mm_div_ps(one, _mm_max_ps(farDepth, nearPlane));
+            }
+
+            __m128 lowX = _mm_sub_ps(v[0], radius), highX = _mm_add_ps(v[0], radius);
+            __m128 lowY = _mm_sub_ps(v[1], radius), highY = _mm_add_ps(v[1], radius);
+
+            _mm_store_ps(minX, _mm_add_ps(_mm_mul_ps(scaleX, _mm_min_ps(_mm_mul_ps(lowX, invNear), _mm_mul_ps(lowX, invFar))), biasX));
+            _mm_store_ps(maxX, _mm_add_ps(_mm_mul_ps(scaleX, _mm_max_ps(_mm_mul_ps(highX, invNear), _mm_mul_ps(highX, invFar))), biasX));
+            _mm_store_ps(minY, _mm_add_ps(_mm_mul_ps(scaleY, _mm_min_ps(_mm_mul_ps(lowY, invNear), _mm_mul_ps(lowY, invFar))), biasY));
+            _mm_store_ps(maxY, _mm_add_ps(_mm_mul_ps(scaleY, _mm_max_ps(_mm_mul_ps(highY, invNear), _mm_mul_ps(highY, invFar))), biasY));
+            _mm_store_ps(depthMin, nearDepth);
+            _mm_store_ps(depthMax, farDepth);
+
+            for (uint32_t k = 0; k < 4; k++)
+            {
+                lights.ScreenBounds[i + k] = glm::vec4(minX[k], minY[k], maxX[k], maxY[k]);
+                lights.DepthRange[i + k] = glm::vec2(depthMin[k], depthMax[k]);
+            }
+        }
+#else
+        for (uint32_t i = 0; i < padded; i++)
+        {
+            glm::vec3 center = glm::vec3(view * glm::vec4(lights.CenterX[i], lights.CenterY[i], lights.CenterZ[i], 1.0f));
+            float radius = lights.Radius[i];
+
+            float depth = -center.z;
+            float invNear = 1.0f, invFar = 1.0f;
+            if (perspective)
+            {
+                invNear = 1.0f / std::max(depth - radius, m_SliceNear);
+                invFar = 1.0f / std::max(depth + radius, m_SliceNear);
+            }
+
+            glm::vec2 low = glm::vec2(center) - radius;
+            glm::vec2 high = glm::vec2(center) + radius;
+            glm::vec2 screenMin = scale * glm::min(low * invNear, low * invFar) + bias;
+            glm::vec2 screenMax = scale * glm::max(high * invNear, high * invFar) + bias;
+
+            lights.ScreenBounds[i] = glm::vec4(screenMin, screenMax);
+            lights.DepthRange[i] = glm::vec2(depth - radius, depth + radius);
+        }
+#endif
+
+        lights.CenterX.resize(lights.Count);
+        lights.CenterY.resize(lights.Count);
+        lights.CenterZ.resize(lights.Count);
+        lights.Radius.resize(lights.Count);
+    }
+
+    void LightClusterGrid::ComputeClusterRanges(LightSet &lights)
+    {
+        lights.ClusterMin.resize(lights.Count);
+        lights.ClusterMax.resize(lights.Count);
+
+        auto toTile = [](float ndc, uint32_t count) {
+            int tile = (int)std::floor((ndc * 0.5f + 0.5f) * (float)count);
+            return (uint32_t)std::clamp(tile, 0, (int)count - 1);
+        };
+
+        for (uint32_t i = 0; i < lights.Count; i++)
+        {
+            const glm::vec4 &bounds = lights.ScreenBounds[i];
+            const glm::vec2 &depth = lights.DepthRange[i];
+
+            bool visible = depth.y >= m_NearPlane && depth.x <= m_FarPlane &&
+                           bounds.z >= -1.0f && bounds.x <= 1.0f && bounds.w >= -1.0f && bounds.y <= 1.0f;
+            if (!visible)
+            {
+                lights.ClusterMin[i] = glm::uvec3(1u);
+                lights.ClusterMax[i] = glm::uvec3(0u);
+                continue;
+            }
+
+            lights.ClusterMin[i] = glm::uvec3(toTile(bounds.x, DimX), toTile(bounds.y, DimY), GetSlice(depth.x));
+            lights.ClusterMax[i] = glm::uvec3(toTile(bounds.z, DimX), toTile(bounds.w, DimY), GetSlice(std::min(depth.y, m_FarPlane)));
+        }
+    }
+
+    void LightClusterGrid::CountLights(const LightSet &lights, uint32_t component)
+    {
+        for (uint32_t i = 0; i < lights.Count; i++)
+        {
+            const glm::uvec3 &min = lights.ClusterMin[i];
+            const glm::uvec3 &max = lights.ClusterMax[i];
+            for (uint32_t z = min.z; z <= max.z; z++)
+                for (uint32_t y = min.y; y <= max.y; y++)
+                    for (uint32_t x = min.x; x <= max.x; x++)
+                        m_Clusters[x + DimX * (y + DimY * z)][component]++;
+        }
+    }
+
+    void LightClusterGrid::WriteLightIndices(const LightSet &lights)
+    {
+        for (uint32_t i = 0; i < lights.Count; i++)
+        {
+            const glm::uvec3 &min = lights.ClusterMin[i];
+            const glm::uvec3 &max = lights.ClusterMax[i];
+            for (uint32_t z = min.z; z <= max.z; z++)
+                for (uint32_t y = min.y; y <= max.y; y++)
+                    for (uint32_t x = min.x; x <= max.x; x++)
+                        m_LightIndices[m_Cursor[x + DimX * (y + DimY * z)]++] = i;
+        }
+    }
+
+    uint32_t LightClusterGrid::GetSlice(float viewDepth) const
+    {
+        // 与片元着色器 GetLightCluster 的计算一致
+        float slice = std::log(std::max(viewDepth, m_SliceNear)) * m_DepthParams.x + m_DepthParams.y;
+        return (uint32_t)std::clamp((int)slice, 0, (int)DimZ - 1);
+    }
+}
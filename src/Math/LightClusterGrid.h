@@ -0,0 +1,81 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace Mc::Math
+{
+    // 分簇光照 (clustered forward)
+    // 视锥在屏幕上划分为 DimX x DimY 个区块，观察空间深度按指数划分为 DimZ 层
+    // 每个簇记录与之相交的点光源和聚光灯下标，片元着色器只遍历所在簇的光源
+    class LightClusterGrid
+    {
+    public:
+        static const uint32_t DimX = 16;
+        static const uint32_t DimY = 9;
+        static const uint32_t DimZ = 24;
+        static const uint32_t ClusterCount = DimX * DimY * DimZ;
+
+        // x: 在 LightIndices 中的起始位置, y: 点光源数量, z: 聚光灯数量 (紧跟点光源之后), w: 未使用
+        using Cluster = glm::uvec4;
+
+        void Clear();
+
+        // 世界空间包围球，光源下标即加入的顺序 (点光源与聚光灯分别计数)
+        void AddPointLight(const glm::vec3 &center, float radius);
+        void AddSpotLight(const glm::vec3 &center, float radius);
+
+        // nearPlane / farPlane 为相机的观察空间深度范围
+        void Build(const glm::mat4 &view, const glm::mat4 &projection, float nearPlane, float farPlane);
+
+        const std::vector<Cluster> &GetClusters() const { return m_Clusters; }
+        const std::vector<uint32_t> &GetLightIndices() const { return m_LightIndices; }
+        // 深度层 slice = log(viewDepth) * x + y
+        glm::vec2 GetDepthParams() const { return m_DepthParams; }
+
+    private:
+        // 世界空间包围球按 SoA 存放，Build 时每次迭代变换 4 个 (SSE)
+        struct LightSet
+        {
+            std::vector<float> CenterX;
+            std::vector<float> CenterY;
+            std::vector<float> CenterZ;
+            std::vector<float> Radius;
+
+            // Build 时计算的 NDC 包围盒与观察空间深度范围
+            std::vector<glm::vec4> ScreenBounds; // xy: min, zw: max
+            std::vector<glm::vec2> DepthRange;
+
+            // 覆盖的簇范围 (闭区间)，Min.x > Max.x 表示不可见
+            std::vector<glm::uvec3> ClusterMin;
+            std::vector<glm::uvec3> ClusterMax;
+
+            uint32_t Count = 0;
+
+            void Clear();
+            void Add(const glm::vec3 &center, float radius);
+        };
+
+        void ComputeBounds(LightSet &lights, const glm::mat4 &view, const glm::mat4 &projection);
+        void ComputeClusterRanges(LightSet &lights);
+        void CountLights(const LightSet &lights, uint32_t component);
+        void WriteLightIndices(const LightSet &lights);
+
+        uint32_t GetSlice(float viewDepth) const;
+
+    private:
+        LightSet m_PointLights;
+        LightSet m_SpotLights;
+
+        std::vector<Cluster> m_Clusters;
+        std::vector<uint32_t> m_LightIndices;
+        std::vector<uint32_t> m_Cursor; // 写入下标时每个簇的当前位置
+
+        float m_NearPlane = 0.1f;
+        float m_FarPlane = 1000.0f;
+        float m_SliceNear = 0.1f; // 第 0 层的起始深度
+        glm::vec2 m_DepthParams = glm::vec2(0.0f);
+    };
+}
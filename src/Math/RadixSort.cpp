@@ -0,0 +1,62 @@
+#include "RadixSort.h"
+
+#include <cstring>
+
+namespace Mc::Math
+{
+    uint32_t RadixSorter::Sort()
+    {
+        uint32_t count = (uint32_t)m_Entries.size();
+        if (count < 2)
+            return 0;
+
+        // 一次遍历统计全部 8 个字节的直方图
+        static const uint32_t Passes = 8;
+        static const uint32_t Buckets = 256;
+        uint32_t histograms[Passes][Buckets];
+        memset(histograms, 0, sizeof(histograms));
+
+        for (const Entry &entry : m_Entries)
+        {
+            for (uint32_t pass = 0; pass < Passes; pass++)
+                histograms[pass][(entry.Key >> (pass * 8)) & 0xFF]++;
+        }
+
+        m_Scratch.resize(count);
+        Entry *source = m_Entries.data();
+        Entry *destination = m_Scratch.data();
+
+        uint32_t executed = 0;
+        for (uint32_t pass = 0; pass < Passes; pass++)
+        {
+            uint32_t *histogram = histograms[pass];
+            uint32_t shift = pass * 8;
+
+            // 所有键在这一字节上相同，顺序不变
+            if (histogram[(source[0].Key >> shift) & 0xFF] == count)
+                continue;
+
+            uint32_t offset = 0;
+            for (uint32_t bucket = 0; bucket < Buckets; bucket++)
+            {
+                uint32_t bucketCount = histogram[bucket];
+                histogram[bucket] = offset;
+                offset += bucketCount;
+            }
+
+            for (uint32_t i = 0; i < count; i++)
+                destination[histogram[(source[i].Key >> shift) & 0xFF]++] = source[i];
+
+            Entry *temp = source;
+            source = destination;
+            destination = temp;
+            executed++;
+        }
+
+        // 奇数趟时结果在临时缓冲区中
+        if (source != m_Entries.data())
+            m_Entries.swap(m_Scratch);
+
+        return executed;
+    }
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace Mc::Math
+{
+    // 64 位排序键的 LSD 基数排序，每趟处理 8 位，所有键在某一字节上相同时跳过该趟
+    // 稳定排序：键相同的元素保持加入的顺序
+    // 缓冲区在帧之间保留，Clear 只重置数量
+    class RadixSorter
+    {
+    public:
+        void Clear() { m_Entries.clear(); }
+        void Reserve(uint32_t count) { m_Entries.reserve(count); }
+
+        // value 一般是调用方数组中的下标
+        void Add(uint64_t key, uint32_t value) { m_Entries.push_back({ key, value }); }
+
+        // 返回实际执行的趟数
+        uint32_t Sort();
+
+        uint32_t GetCount() const { return (uint32_t)m_Entries.size(); }
+        uint64_t GetKey(uint32_t index) const { return m_Entries[index].Key; }
+        uint32_t GetValue(uint32_t index) const { return m_Entries[index].Value; }
+
+    private:
+        struct Entry
+        {
+            uint64_t Key;
+            uint32_t Value;
+        };
+
+        std::vector<Entry> m_Entries;
+        std::vector<Entry> m_Scratch;
+    };
+}
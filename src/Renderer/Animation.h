@@ -181,7 +181,7 @@ namespace Mc
         void CalculateBoneTransform(const AssimpNodeData *node, glm::mat4 parentTransform);
         float GetCurrentTime() { return m_CurrentTime; }
         float GetDuration() { return m_CurrentAnimation->GetDuration(); }
-        std::vector<glm::mat4> GetFinalBoneMatrices() { return m_FinalBoneMatrices; }
+        const std::vector<glm::mat4> &GetFinalBoneMatrices() const { return m_FinalBoneMatrices; }
         void SetProgress(float fraction);
         bool GetPaused() { return m_IsPaused; }
         void SetPaused(bool paused) { m_IsPaused = paused; }
@@ -0,0 +1,64 @@
+#include "BindlessTexture.h"
+
+#include <glad/glad.h>
+
+#include <cstring>
+
+namespace Mc
+{
+    typedef uint64_t (APIENTRYP PFNGLGETTEXTUREHANDLEARBPROC)(GLuint texture);
+    typedef void (APIENTRYP PFNGLMAKETEXTUREHANDLERESIDENTARBPROC)(uint64_t handle);
+    typedef void (APIENTRYP PFNGLMAKETEXTUREHANDLENONRESIDENTARBPROC)(uint64_t handle);
+
+    static PFNGLGETTEXTUREHANDLEARBPROC s_GetTextureHandle = nullptr;
+    static PFNGLMAKETEXTUREHANDLERESIDENTARBPROC s_MakeTextureHandleResident = nullptr;
+    static PFNGLMAKETEXTUREHANDLENONRESIDENTARBPROC s_MakeTextureHandleNonResident = nullptr;
+
+    static bool HasExtension(const char *name)
+    {
+        GLint count = 0;
+        glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+        for (GLint i = 0; i < count; i++)
+        {
+            const char *extension = (const char *)glGetStringi(GL_EXTENSIONS, i);
+            if (extension && strcmp(extension, name) == 0)
+                return true;
+        }
+        return false;
+    }
+
+    void BindlessTexture::Init(LoadProc loader)
+    {
+        s_Supported = false;
+
+        if (!HasExtension("GL_ARB_bindless_texture"))
+        {
+            LOG_CORE_INFO("  Bindless Texture: not supported, using texture slots");
+            return;
+        }
+
+        s_GetTextureHandle = (PFNGLGETTEXTUREHANDLEARBPROC)loader("glGetTextureHandleARB");
+        s_MakeTextureHandleResident = (PFNGLMAKETEXTUREHANDLERESIDENTARBPROC)loader("glMakeTextureHandleResidentARB");
+        s_MakeTextureHandleNonResident = (PFNGLMAKETEXTUREHANDLENONRESIDENTARBPROC)loader("glMakeTextureHandleNonResidentARB");
+
+        s_Supported = s_GetTextureHandle && s_MakeTextureHandleResident && s_MakeTextureHandleNonResident;
+        LOG_CORE_INFO("  Bindless Texture: {0}", s_Supported ? "enabled" : "failed to load functions");
+    }
+
+    uint64_t BindlessTexture::MakeResident(uint32_t texture)
+    {
+        if (!s_Supported)
+            return 0;
+
+        uint64_t handle = s_GetTextureHandle(texture);
+        if (handle)
+            s_MakeTextureHandleResident(handle);
+        return handle;
+    }
+
+    void BindlessTexture::MakeNonResident(uint64_t handle)
+    {
+        if (s_Supported && handle)
+            s_MakeTextureHandleNonResident(handle);
+    }
+}
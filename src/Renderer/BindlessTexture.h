@@ -0,0 +1,24 @@
+#pragma once
+
+#include "src/Core/Base.h"
+
+namespace Mc
+{
+    // GL_ARB_bindless_texture 的最小封装
+    // glad 只生成了核心函数，扩展函数在 GraphicsContext::Init 中通过 glfwGetProcAddress 加载
+    class BindlessTexture
+    {
+    public:
+        using LoadProc = void *(*)(const char *name);
+
+        static void Init(LoadProc loader);
+        static bool IsSupported() { return s_Supported; }
+
+        // 获取纹理句柄并设为常驻，纹理销毁前需调用 MakeNonResident
+        static uint64_t MakeResident(uint32_t texture);
+        static void MakeNonResident(uint64_t handle);
+
+    private:
+        static inline bool s_Supported = false;
+    };
+}
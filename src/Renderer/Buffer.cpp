@@ -1,7 +1,10 @@
 #include "Buffer.h"
+#include "GLState.h"
 
 #include <glad/glad.h>
 
+#include <cstring>
+
 namespace Mc
 {
 
@@ -12,8 +15,10 @@ namespace Mc
     VertexBuffer::VertexBuffer(uint32_t size)
     {
         glCreateBuffers(1, &m_RendererID);
-        glBindBuffer(GL_ARRAY_BUFFER, m_RendererID);
+        GLState::BindBuffer(GL_ARRAY_BUFFER, m_RendererID);
         glBufferData(GL_ARRAY_BUFFER, size, nullptr, GL_DYNAMIC_DRAW);
+
+        BufferStatistics::OnAllocate();
     }
 
     VertexBuffer::VertexBuffer(void *vertices, uint32_t size)
@@ -22,29 +27,32 @@ namespace Mc
         auto ptr = &vertices;
 
         glCreateBuffers(1, &m_RendererID);
-        glBindBuffer(GL_ARRAY_BUFFER, m_RendererID);
+        GLState::BindBuffer(GL_ARRAY_BUFFER, m_RendererID);
         glBufferData(GL_ARRAY_BUFFER, size, vertices, GL_STATIC_DRAW);
+
+        BufferStatistics::OnAllocate();
     }
 
     VertexBuffer::~VertexBuffer()
     {
         glDeleteBuffers(1, &m_RendererID);
+        GLState::OnDeleteBuffer(m_RendererID);
     }
 
     void VertexBuffer::Bind() const
     {
-        glBindBuffer(GL_ARRAY_BUFFER, m_RendererID);
+        GLState::BindBuffer(GL_ARRAY_BUFFER, m_RendererID);
     }
 
     void VertexBuffer::UnBind() const
     {
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        // 通用绑定点只影响之后的 glBufferData / glVertexAttribPointer，它们总是先 Bind
     }
 
-    void VertexBuffer::SetData(const void *data, uint32_t size)
+    void VertexBuffer::SetData(const void *data, uint32_t size, uint32_t offset)
     {
-        glBindBuffer(GL_ARRAY_BUFFER, m_RendererID);
-        glBufferSubData(GL_ARRAY_BUFFER, 0, size, data);
+        GLState::BindBuffer(GL_ARRAY_BUFFER, m_RendererID);
+        glBufferSubData(GL_ARRAY_BUFFER, offset, size, data);
     }
 
     Ref<VertexBuffer> VertexBuffer::Create(uint32_t size)
@@ -65,27 +73,29 @@ namespace Mc
         : m_Size(size)
     {
         glCreateBuffers(1, &m_RendererID);
-        glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_RendererID);
+        GLState::BindBuffer(GL_SHADER_STORAGE_BUFFER, m_RendererID);
         glBufferStorage(GL_SHADER_STORAGE_BUFFER, size, nullptr, GL_DYNAMIC_STORAGE_BIT);
 
-        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, m_RendererID);
-        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+        GLState::BindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, m_RendererID);
+
+        BufferStatistics::OnAllocate();
     }
 
     ShaderStorageBuffer::~ShaderStorageBuffer()
     {
         glDeleteBuffers(1, &m_RendererID);
+        GLState::OnDeleteBuffer(m_RendererID);
     }
 
 
     void ShaderStorageBuffer::Bind() const
     {
-        glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_RendererID);
+        GLState::BindBuffer(GL_SHADER_STORAGE_BUFFER, m_RendererID);
     }
 
     void ShaderStorageBuffer::UnBind() const
     {
-        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+        // 着色器只使用索引绑定点，通用绑定点保持不变不影响绘制
     }
 
     void ShaderStorageBuffer::SetData(const void *data, uint32_t size)
@@ -94,6 +104,8 @@ namespace Mc
         {
             glBufferData(GL_SHADER_STORAGE_BUFFER, size, data, GL_DYNAMIC_DRAW);
             m_Size = size;
+
+            BufferStatistics::OnAllocate();
         }
         else
         {
@@ -103,7 +115,7 @@ namespace Mc
 
     void ShaderStorageBuffer::BindBase(uint32_t bindingPoint) const
     {
-        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, bindingPoint, m_RendererID);
+        GLState::BindBufferBase(GL_SHADER_STORAGE_BUFFER, bindingPoint, m_RendererID);
     }
 
     void ShaderStorageBuffer::Destroy()
@@ -111,6 +123,7 @@ namespace Mc
         if (m_RendererID != 0) // 确保 ID 有效
         {
             glDeleteBuffers(1, &m_RendererID);
+            GLState::OnDeleteBuffer(m_RendererID);
             m_RendererID = 0; // 重置ID以防止悬空指针
         }
     }
@@ -120,23 +133,168 @@ namespace Mc
         return CreateRef<ShaderStorageBuffer>(size);
     }
 
+    // ========================================================================
+    // ShaderStorageRingBuffer
+    // ========================================================================
+
+    ShaderStorageRingBuffer::ShaderStorageRingBuffer(uint32_t frameSize)
+    {
+        GLint alignment = 1;
+        glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &alignment);
+        m_Alignment = alignment > 0 ? (uint32_t)alignment : 1;
+
+        CreateStorage(frameSize);
+    }
+
+    ShaderStorageRingBuffer::~ShaderStorageRingBuffer()
+    {
+        for (uint32_t i = 0; i < FrameCount; i++)
+        {
+            if (m_Fences[i])
+                glDeleteSync((GLsync)m_Fences[i]);
+        }
+
+        if (m_MappedData)
+            glUnmapNamedBuffer(m_RendererID);
+        glDeleteBuffers(1, &m_RendererID);
+        GLState::OnDeleteBuffer(m_RendererID);
+    }
+
+    void ShaderStorageRingBuffer::CreateStorage(uint32_t frameSize)
+    {
+        // 每个区域的起始位置都需要满足 SSBO 的偏移对齐
+        m_FrameSize = AlignOffset(frameSize);
+
+        // 只写映射，CPU 需要的数据 (剔除、排序) 在写入时另存一份，不从映射内存读回
+        const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+        glCreateBuffers(1, &m_RendererID);
+        glNamedBufferStorage(m_RendererID, (GLsizeiptr)m_FrameSize * FrameCount, nullptr, flags);
+        m_MappedData = (uint8_t *)glMapNamedBufferRange(m_RendererID, 0, (GLsizeiptr)m_FrameSize * FrameCount, flags);
+
+        if (m_MappedData == nullptr)
+            LOG_CORE_ERROR("ShaderStorageRingBuffer: failed to map buffer!");
+
+        BufferStatistics::OnAllocate();
+    }
+
+    void ShaderStorageRingBuffer::Grow(uint32_t frameSize)
+    {
+        if (AlignOffset(frameSize) <= m_FrameSize)
+            return;
+
+        uint32_t oldRendererID = m_RendererID;
+        uint8_t *oldData = m_MappedData;
+        uint32_t oldFrameStart = GetFrameStart();
+
+        for (uint32_t i = 0; i < FrameCount; i++)
+        {
+            if (m_Fences[i])
+                glDeleteSync((GLsync)m_Fences[i]);
+            m_Fences[i] = nullptr;
+        }
+
+        // 新缓冲区的其他区域从未被 GPU 使用，不需要 fence
+        // 映射是只写的，已写入的内容由 GPU 复制 (一致映射的写入对之后的 GL 命令可见)
+        CreateStorage(frameSize);
+        if (m_MappedData && oldData && m_FrameOffset > 0)
+            glCopyNamedBufferSubData(oldRendererID, m_RendererID, oldFrameStart, GetFrameStart(), m_FrameOffset);
+
+        if (oldData)
+            glUnmapNamedBuffer(oldRendererID);
+        glDeleteBuffers(1, &oldRendererID);
+        GLState::OnDeleteBuffer(oldRendererID);
+    }
+
+    void ShaderStorageRingBuffer::BeginFrame()
+    {
+        GLsync fence = (GLsync)m_Fences[m_FrameIndex];
+        if (fence)
+        {
+            // 该区域上一次的绘制尚未完成时阻塞等待
+            GLenum result = glClientWaitSync(fence, 0, 0);
+            while (result == GL_TIMEOUT_EXPIRED)
+                result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+
+            glDeleteSync(fence);
+            m_Fences[m_FrameIndex] = nullptr;
+        }
+
+        m_FrameOffset = 0;
+    }
+
+    void ShaderStorageRingBuffer::EndFrame()
+    {
+        if (m_Fences[m_FrameIndex])
+            glDeleteSync((GLsync)m_Fences[m_FrameIndex]);
+
+        m_Fences[m_FrameIndex] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        m_FrameIndex = (m_FrameIndex + 1) % FrameCount;
+        m_FrameOffset = 0;
+    }
+
+    void *ShaderStorageRingBuffer::Allocate(uint32_t size, uint32_t &offset, uint32_t alignment)
+    {
+        if (m_MappedData == nullptr || !CanAllocate(size, alignment))
+            return nullptr;
+
+        uint32_t start = AlignOffset(m_FrameOffset, alignment ? alignment : m_Alignment);
+        m_FrameOffset = start + size;
+
+        offset = m_FrameIndex * m_FrameSize + start;
+        return m_MappedData + offset;
+    }
+
+    bool ShaderStorageRingBuffer::CanAllocate(uint32_t size, uint32_t alignment) const
+    {
+        return AlignOffset(m_FrameOffset, alignment ? alignment : m_Alignment) + size <= m_FrameSize;
+    }
+
+    void ShaderStorageRingBuffer::BindRange(uint32_t bindingPoint, uint32_t offset, uint32_t size) const
+    {
+        GLState::BindBufferRange(GL_SHADER_STORAGE_BUFFER, bindingPoint, m_RendererID, offset, size);
+    }
+
+    void ShaderStorageRingBuffer::BindIndirect() const
+    {
+        GLState::BindBuffer(GL_DRAW_INDIRECT_BUFFER, m_RendererID);
+    }
+
+    Ref<ShaderStorageRingBuffer> ShaderStorageRingBuffer::Create(uint32_t frameSize)
+    {
+        return CreateRef<ShaderStorageRingBuffer>(frameSize);
+    }
+
     // ========================================================================
     // IndexBuffer
     // ========================================================================
 
+    IndexBuffer::IndexBuffer(uint32_t count)
+        : m_Count(count)
+    {
+        glCreateBuffers(1, &m_RendererID);
+        GLState::BindBuffer(GL_ARRAY_BUFFER, m_RendererID);
+
+        glBufferData(GL_ARRAY_BUFFER, count * sizeof(uint32_t), nullptr, GL_DYNAMIC_DRAW);
+
+        BufferStatistics::OnAllocate();
+    }
+
     IndexBuffer::IndexBuffer(uint32_t *indices, uint32_t count)
         : m_Count(count)
     {
         glCreateBuffers(1, &m_RendererID);
-        glBindBuffer(GL_ARRAY_BUFFER, m_RendererID);
+        GLState::BindBuffer(GL_ARRAY_BUFFER, m_RendererID);
 
         glBufferData(GL_ARRAY_BUFFER, count * sizeof(uint32_t), indices, GL_STATIC_DRAW);
 
+        BufferStatistics::OnAllocate();
     }
 
     IndexBuffer::~IndexBuffer()
     {
         glDeleteBuffers(1, &m_RendererID);
+        GLState::OnDeleteBuffer(m_RendererID);
     }
 
     void IndexBuffer::Bind() const
@@ -149,6 +307,16 @@ namespace Mc
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
     }
 
+    void IndexBuffer::SetData(const uint32_t *indices, uint32_t count, uint32_t offset)
+    {
+        glNamedBufferSubData(m_RendererID, offset * sizeof(uint32_t), count * sizeof(uint32_t), indices);
+    }
+
+    Ref<IndexBuffer> IndexBuffer::Create(uint32_t count)
+    {
+        return CreateRef<IndexBuffer>(count);
+    }
+
     Ref<IndexBuffer> IndexBuffer::Create(uint32_t *indices, uint32_t count)
     {
         return CreateRef<IndexBuffer>(indices, count);
@@ -105,6 +105,17 @@ namespace Mc
         uint32_t m_Stride = 0;
     };
 
+    // 统计 GL 缓冲区的分配次数，由 Renderer3D::ResetStats 每帧清零
+    class BufferStatistics
+    {
+    public:
+        static void OnAllocate() { s_Allocations++; }
+        static uint32_t GetAllocations() { return s_Allocations; }
+        static void Reset() { s_Allocations = 0; }
+    private:
+        static inline uint32_t s_Allocations = 0;
+    };
+
     class VertexBuffer
     {
     public:
@@ -115,10 +126,12 @@ namespace Mc
         void Bind() const;
         void UnBind() const;
 
-        void SetData(const void *data, uint32_t size);
+        void SetData(const void *data, uint32_t size, uint32_t offset = 0);
 
         const BufferLayout &GetLayout() const { return m_Layout; }
         void SetLayout(const BufferLayout &layout) { m_Layout = layout; }
+
+        uint32_t GetRendererID() const { return m_RendererID; }
     private:
         uint32_t m_RendererID;
         BufferLayout m_Layout;
@@ -148,20 +161,80 @@ namespace Mc
         static Ref<ShaderStorageBuffer> Create(uint32_t size);
     };
 
+    // 持久映射的环形 SSBO
+    // 存储被划分为 FrameCount 个区域，每个区域由 fence 保护
+    // CPU 直接写入映射内存，不再经过 glBufferSubData
+    class ShaderStorageRingBuffer
+    {
+    public:
+        static const uint32_t FrameCount = 3;
+
+        ShaderStorageRingBuffer(uint32_t frameSize);
+        ~ShaderStorageRingBuffer();
+
+        // 等待当前区域的 fence，并重置写入位置
+        void BeginFrame();
+        // 为当前区域插入 fence，并切换到下一个区域
+        void EndFrame();
+
+        // 在当前区域中分配 size 字节，返回映射地址，offset 为整个缓冲区内的偏移
+        // 区域剩余空间不足时返回 nullptr
+        // alignment 为 0 时使用 SSBO 的偏移对齐；
+        // 整个区域一次性绑定、按下标访问时可传入元素大小，保证相对偏移是元素大小的整数倍
+        void *Allocate(uint32_t size, uint32_t &offset, uint32_t alignment = 0);
+        bool CanAllocate(uint32_t size, uint32_t alignment = 0) const;
+
+        // 帧中途扩大每个区域，当前区域已分配的内容在 GPU 上复制到新缓冲区中相同的相对位置，写入位置不变
+        // 之前得到的 offset 与映射地址失效，需按 GetFrameStart 的变化重新计算
+        // 旧缓冲区仍可能被 GPU 读取，由驱动在使用结束后释放
+        void Grow(uint32_t frameSize);
+        void *GetMappedData(uint32_t offset) const { return m_MappedData ? m_MappedData + offset : nullptr; }
+
+        void BindRange(uint32_t bindingPoint, uint32_t offset, uint32_t size) const;
+        // 作为 GL_DRAW_INDIRECT_BUFFER 绑定，用于 glMultiDrawElementsIndirect
+        void BindIndirect() const;
+
+        uint32_t GetFrameSize() const { return m_FrameSize; }
+        uint32_t GetFrameStart() const { return m_FrameIndex * m_FrameSize; }
+        uint32_t GetRendererID() const { return m_RendererID; }
+    private:
+        uint32_t AlignOffset(uint32_t offset) const { return AlignOffset(offset, m_Alignment); }
+        static uint32_t AlignOffset(uint32_t offset, uint32_t alignment) { return (offset + alignment - 1) / alignment * alignment; }
+
+        // 创建并持久映射 FrameCount 个区域的存储
+        void CreateStorage(uint32_t frameSize);
+    private:
+        uint32_t m_RendererID = 0;
+        uint32_t m_FrameSize = 0;
+        uint32_t m_Alignment = 1;
+        uint8_t *m_MappedData = nullptr;
+
+        uint32_t m_FrameIndex = 0;
+        uint32_t m_FrameOffset = 0;
+        void *m_Fences[FrameCount] = {}; // GLsync
+    public:
+        static Ref<ShaderStorageRingBuffer> Create(uint32_t frameSize);
+    };
+
     class IndexBuffer
     {
     public:
+        IndexBuffer(uint32_t count);
         IndexBuffer(uint32_t *indices, uint32_t count);
         ~IndexBuffer();
 
         void Bind() const;
         void UnBind() const;
 
+        void SetData(const uint32_t *indices, uint32_t count, uint32_t offset = 0);
+
         uint32_t GetCount() const { return m_Count; };
+        uint32_t GetRendererID() const { return m_RendererID; }
     private:
         uint32_t m_RendererID;
         uint32_t m_Count;
     public:
+        static Ref<IndexBuffer> Create(uint32_t count);
         static Ref<IndexBuffer> Create(uint32_t *indices, uint32_t count);
     };
 
@@ -0,0 +1,299 @@
+#include "CpuSkinner.h"
+
+#include "src/Core/Timer.h"
+#include "src/Renderer/Mesh.h"
+
+#include <algorithm>
+
+// AVX2 路径单独编译，运行时按 CPU 选择
+#if defined(MC_SIMD_X86)
+    #include <immintrin.h>
+#endif
+
+namespace Mc
+{
+    CpuSkinner::~CpuSkinner()
+    {
+        StopWorkers();
+    }
+
+    void CpuSkinner::SetThreadCount(uint32_t count)
+    {
+        if (count == 0)
+            count = std::max(1u, std::thread::hardware_concurrency());
+
+        if (count == m_ThreadCount)
+            return;
+
+        StopWorkers();
+        m_ThreadCount = count;
+        StartWorkers();
+    }
+
+    void CpuSkinner::AddMesh(uint32_t meshID, const ModelVertex *vertices, uint32_t vertexCount)
+    {
+        SourceMesh &mesh = m_Meshes[meshID];
+        mesh.VertexCount = vertexCount;
+
+        // 补齐部分的骨骼为 -1、权重为 0，结果不会被写出
+        uint32_t padded = (vertexCount + 7) / 8 * 8;
+        for (int i = 0; i < 3; i++)
+        {
+            mesh.Position[i].assign(padded, 0.0f);
+            mesh.Normal[i].assign(padded, 0.0f);
+            mesh.Tangent[i].assign(padded, 0.0f);
+        }
+        for (int i = 0; i < 4; i++)
+        {
+            mesh.BoneIDs[i].assign(padded, -1);
+            mesh.Weights[i].assign(padded, 0.0f);
+        }
+
+        for (uint32_t v = 0; v < vertexCount; v++)
+        {
+            const ModelVertex &vertex = vertices[v];
+            for (int i = 0; i < 3; i++)
+            {
+                mesh.Position[i][v] = vertex.Position[i];
+                mesh.Normal[i][v] = vertex.Normal[i];
+                mesh.Tangent[i][v] = vertex.Tangent[i];
+            }
+            for (int i = 0; i < 4; i++)
+            {
+                mesh.BoneIDs[i][v] = vertex.BoneIDs[i];
+                mesh.Weights[i][v] = vertex.Weights[i];
+            }
+        }
+    }
+
+    uint32_t CpuSkinner::GetVertexCount(uint32_t meshID) const
+    {
+        auto it = m_Meshes.find(meshID);
+        return it != m_Meshes.end() ? it->second.VertexCount : 0;
+    }
+
+    void CpuSkinner::Skin(const std::vector<Job> &jobs)
+    {
+        if (m_ThreadCount == 0)
+            SetThreadCount(0);
+
+        Timer timer;
+
+        m_Blocks.clear();
+        uint32_t vertices = 0;
+        for (const Job &job : jobs)
+        {
+            auto it = m_Meshes.find(job.MeshID);
+            if (it == m_Meshes.end() || job.Palette == nullptr || job.Output == nullptr)
+                continue;
+
+            const SourceMesh &mesh = it->second;
+            for (uint32_t first = 0; first < mesh.VertexCount; first += BlockVertices)
+                m_Blocks.push_back({ &mesh, &job, first, std::min(BlockVertices, mesh.VertexCount - first) });
+            vertices += mesh.VertexCount;
+        }
+
+        if (!m_Blocks.empty())
+        {
+            m_NextBlock = 0;
+            {
+                std::lock_guard<std::mutex> lock(m_Mutex);
+                m_ActiveWorkers = (uint32_t)m_Workers.size();
+                m_Generation++;
+            }
+            m_WorkReady.notify_all();
+
+            RunBlocks();
+
+            std::unique_lock<std::mutex> lock(m_Mutex);
+            m_WorkDone.wait(lock, [this] { return m_ActiveWorkers == 0; });
+        }
+
+        m_Stats.Vertices = vertices;
+        m_Stats.Threads = (uint32_t)m_Workers.size() + 1;
+        m_Stats.Milliseconds = timer.ElapsedMillis();
+    }
+
+    void CpuSkinner::StartWorkers()
+    {
+        m_Stopping = false;
+
+        // 调用线程也参与计算，因此少创建一个
+        for (uint32_t i = 1; i < m_ThreadCount; i++)
+            m_Workers.emplace_back(&CpuSkinner::WorkerLoop, this, m_Generation);
+    }
+
+    void CpuSkinner::StopWorkers()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_Stopping = true;
+        }
+        m_WorkReady.notify_all();
+
+        for (auto &worker : m_Workers)
+            worker.join();
+        m_Workers.clear();
+    }
+
+    void CpuSkinner::WorkerLoop(uint64_t generation)
+    {
+        while (true)
+        {
+            {
+                std::unique_lock<std::mutex> lock(m_Mutex);
+                m_WorkReady.wait(lock, [&] { return m_Stopping || m_Generation != generation; });
+                if (m_Stopping)
+                    return;
+                generation = m_Generation;
+            }
+
+            RunBlocks();
+
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            if (--m_ActiveWorkers == 0)
+                m_WorkDone.notify_one();
+        }
+    }
+
+    void CpuSkinner::RunBlocks()
+    {
+        uint32_t index;
+        while ((index = m_NextBlock.fetch_add(1)) < (uint32_t)m_Blocks.size())
+            SkinBlock(m_Blocks[index]);
+    }
+
+    void CpuSkinner::SkinBlock(const Block &block)
+    {
+#if defined(MC_SIMD_X86)
+        if (CpuFeatures::HasAVX2())
+        {
+            SkinBlockAVX2(block);
+            return;
+        }
+#endif
+        SkinBlockScalar(block);
+    }
+
+#if defined(MC_SIMD_X86)
+    MC_TARGET_AVX2 void CpuSkinner::SkinBlockAVX2(const Block &block)
+    {
+        const SourceMesh &mesh = *block.Mesh;
+        const glm::mat4 *palette = block.Work->Palette;
+        SkinnedVertex *output = block.Work->Output;
+        uint32_t end = block.First + block.Count;
+
+        // SoA 数组补齐到 8 的倍数，最后一组读取补齐部分，只写出块内的顶点
+        // 8 个顶点一组: 4 个影响的骨骼矩阵 (列主序，只取前三行) 按权重累加后变换
+        const float *paletteData = &palette[0][0][0];
+        const __m256 zero = _mm256_setzero_ps();
+        const __m256 one = _mm256_set1_ps(1.0f);
+        const __m256 minWeight = _mm256_set1_ps(0.01f);
+        const __m256i minusOne = _mm256_set1_epi32(-1);
+        const __m256i lastBone = _mm256_set1_epi32((int)MaxBones - 1);
+
+        for (uint32_t v = block.First; v < end; v += 8)
+        {
+            __m256 m[12]; // m[col * 3 + row]
+            for (int e = 0; e < 12; e++)
+                m[e] = zero;
+
+            __m256 total = zero;
+            __m256i active = minusOne;
+            for (int i = 0; i < 4; i++)
+            {
+                __m256i ids = _mm256_loadu_si256((const __m256i *)&mesh.BoneIDs[i][v]);
+                __m256 weights = _mm256_loadu_ps(&mesh.Weights[i][v]);
+
+                // 着色器遇到 >= MAX_BONES 的骨骼后不再累加之后的影响，-1 只跳过当前影响
+                active = _mm256_andnot_si256(_mm256_cmpgt_epi32(ids, lastBone), active);
+                __m256i valid = _mm256_and_si256(active, _mm256_cmpgt_epi32(ids, minusOne));
+                __m256i base = _mm256_and_si256(valid, _mm256_slli_epi32(ids, 4));
+                __m256 weight = _mm256_and_ps(_mm256_castsi256_ps(valid), weights);
+                total = _mm256_add_ps(total, weight);
+
+                for (int col = 0; col < 4; col++)
+                {
+                    for (int row = 0; row < 3; row++)
+                    {
+                        __m256i index = _mm256_add_epi32(base, _mm256_set1_epi32(col * 4 + row));
+                        __m256 element = _mm256_i32gather_ps(paletteData, index, 4);
+                        m[col * 3 + row] = _mm256_add_ps(m[col * 3 + row], _mm256_mul_ps(element, weight));
+                    }
+                }
+            }
+
+            // 没有权重 (静态顶点) 时使用单位矩阵
+            __m256 unweighted = _mm256_cmp_ps(total, minWeight, _CMP_LT_OQ);
+            for (int col = 0; col < 4; col++)
+            {
+                for (int row = 0; row < 3; row++)
+                    m[col * 3 + row] = _mm256_blendv_ps(m[col * 3 + row], col == row ? one : zero, unweighted);
+            }
+
+            float result[9][8];
+            const std::vector<float> *sources[3] = { mesh.Position, mesh.Normal, mesh.Tangent };
+            for (int attribute = 0; attribute < 3; attribute++)
+            {
+                __m256 x = _mm256_loadu_ps(&sources[attribute][0][v]);
+                __m256 y = _mm256_loadu_ps(&sources[attribute][1][v]);
+                __m256 z = _mm256_loadu_ps(&sources[attribute][2][v]);
+                for (int row = 0; row < 3; row++)
+                {
+                    __m256 value = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m[row], x), _mm256_mul_ps(m[3 + row], y)), _mm256_mul_ps(m[6 + row], z));
+                    // 只有位置带平移
+                    if (attribute == 0)
+                        value = _mm256_add_ps(value, m[9 + row]);
+                    _mm256_storeu_ps(result[attribute * 3 + row], value);
+                }
+            }
+
+            uint32_t count = std::min(8u, end - v);
+            for (uint32_t lane = 0; lane < count; lane++)
+            {
+                SkinnedVertex &vertex = output[v + lane];
+                vertex.Position = glm::vec4(result[0][lane], result[1][lane], result[2][lane], 1.0f);
+                vertex.Normal = glm::vec4(result[3][lane], result[4][lane], result[5][lane], 0.0f);
+                vertex.Tangent = glm::vec4(result[6][lane], result[7][lane], result[8][lane], 0.0f);
+            }
+        }
+    }
+#endif
+
+    void CpuSkinner::SkinBlockScalar(const Block &block)
+    {
+        const SourceMesh &mesh = *block.Mesh;
+        const glm::mat4 *palette = block.Work->Palette;
+        SkinnedVertex *output = block.Work->Output;
+        uint32_t end = block.First + block.Count;
+
+        for (uint32_t v = block.First; v < end; v++)
+        {
+            glm::mat4 boneTransform(0.0f);
+            float totalWeight = 0.0f;
+            for (int i = 0; i < 4; i++)
+            {
+                int32_t id = mesh.BoneIDs[i][v];
+                if (id >= (int32_t)MaxBones)
+                    break;
+                if (id < 0)
+                    continue;
+
+                boneTransform += palette[id] * mesh.Weights[i][v];
+                totalWeight += mesh.Weights[i][v];
+            }
+            if (totalWeight < 0.01f)
+                boneTransform = glm::mat4(1.0f);
+
+            glm::mat3 boneMat3(boneTransform);
+            glm::vec3 position(mesh.Position[0][v], mesh.Position[1][v], mesh.Position[2][v]);
+            glm::vec3 normal(mesh.Normal[0][v], mesh.Normal[1][v], mesh.Normal[2][v]);
+            glm::vec3 tangent(mesh.Tangent[0][v], mesh.Tangent[1][v], mesh.Tangent[2][v]);
+
+            SkinnedVertex &vertex = output[v];
+            vertex.Position = glm::vec4(glm::vec3(boneTransform * glm::vec4(position, 1.0f)), 1.0f);
+            vertex.Normal = glm::vec4(boneMat3 * normal, 0.0f);
+            vertex.Tangent = glm::vec4(boneMat3 * tangent, 0.0f);
+        }
+    }
+}
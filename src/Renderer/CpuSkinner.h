@@ -0,0 +1,119 @@
+#pragma once
+
+#include "src/Core/CpuFeatures.h"
+
+#include <glm/glm.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace Mc
+{
+    struct ModelVertex;
+
+    // 蒙皮后的局部空间顶点，与着色器中的 SkinnedVertex 一致 (std430)
+    struct SkinnedVertex
+    {
+        glm::vec4 Position;
+        glm::vec4 Normal;
+        glm::vec4 Tangent;
+    };
+
+    static_assert(sizeof(SkinnedVertex) == 48, "SkinnedVertex size mismatch for std430 layout!");
+
+    // CPU 蒙皮 (没有 GPU 的节点，例如 Mesa llvmpipe，计算着色器与顶点着色器蒙皮都很慢)
+    // 网格的绑定姿势按 SoA 保存，按顶点块分给工作线程，调用线程也参与计算
+    // CPU 支持 AVX2 时 (运行时检测) 每次处理 8 个顶点 (调色板用 gather 读取)，否则逐顶点计算
+    // 结果与 Renderer3D_Skinning.glsl 一致，写入调用方提供的内存 (通常是持久映射的缓冲区)
+    class CpuSkinner
+    {
+    public:
+        static const uint32_t MaxBones = 100;       // 与着色器中的 MAX_BONES 一致
+        static const uint32_t BlockVertices = 2048; // 每个工作单元的顶点数 (8 的倍数)
+
+        struct Job
+        {
+            uint32_t MeshID = 0;
+            const glm::mat4 *Palette = nullptr; // MaxBones 个矩阵
+            SkinnedVertex *Output = nullptr;    // 网格的顶点数个
+        };
+
+        struct Statistics
+        {
+            uint32_t Vertices = 0;
+            uint32_t Threads = 0;      // 参与计算的线程数 (包括调用线程)
+            float Milliseconds = 0.0f; // Skin 的耗时
+        };
+
+        CpuSkinner() = default;
+        ~CpuSkinner();
+
+        CpuSkinner(const CpuSkinner &) = delete;
+        CpuSkinner &operator=(const CpuSkinner &) = delete;
+
+        // 0 表示使用 std::thread::hardware_concurrency，1 表示只在调用线程上计算
+        void SetThreadCount(uint32_t count);
+        uint32_t GetThreadCount() const { return m_ThreadCount; }
+
+        // 网格 ID 不会复用，绑定姿势只需读取一次
+        bool HasMesh(uint32_t meshID) const { return m_Meshes.count(meshID) != 0; }
+        void AddMesh(uint32_t meshID, const ModelVertex *vertices, uint32_t vertexCount);
+        uint32_t GetVertexCount(uint32_t meshID) const;
+
+        // 阻塞到所有作业完成
+        void Skin(const std::vector<Job> &jobs);
+
+        const Statistics &GetStats() const { return m_Stats; }
+
+    private:
+        // 绑定姿势，长度补齐到 8 的倍数，补齐部分的权重为 0
+        struct SourceMesh
+        {
+            uint32_t VertexCount = 0;
+            std::vector<float> Position[3];
+            std::vector<float> Normal[3];
+            std::vector<float> Tangent[3];
+            std::vector<int32_t> BoneIDs[4];
+            std::vector<float> Weights[4];
+        };
+
+        struct Block
+        {
+            const SourceMesh *Mesh;
+            const Job *Work;
+            uint32_t First;
+            uint32_t Count;
+        };
+
+        void StartWorkers();
+        void StopWorkers();
+        void WorkerLoop(uint64_t generation);
+        void RunBlocks();
+        static void SkinBlock(const Block &block);
+        static void SkinBlockScalar(const Block &block);
+#if defined(MC_SIMD_X86)
+        MC_TARGET_AVX2 static void SkinBlockAVX2(const Block &block);
+#endif
+
+    private:
+        std::unordered_map<uint32_t, SourceMesh> m_Meshes;
+        Statistics m_Stats;
+
+        uint32_t m_ThreadCount = 0; // 0 表示尚未设置
+        std::vector<std::thread> m_Workers;
+        std::mutex m_Mutex;
+        std::condition_variable m_WorkReady;
+        std::condition_variable m_WorkDone;
+        uint64_t m_Generation = 0;  // 每次 Skin 加一，唤醒工作线程
+        uint32_t m_ActiveWorkers = 0;
+        bool m_Stopping = false;
+
+        std::vector<Block> m_Blocks;
+        std::atomic<uint32_t> m_NextBlock{0};
+    };
+}
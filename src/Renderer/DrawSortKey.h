@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+namespace Mc::DrawSortKey
+{
+    // 模型间接绘制命令的排序键，高位优先:
+    // [63:62] 通道 [61:60] 着色器变体 [59:48] 深度 (指数与最高 3 位尾数，约 12% 的相对精度) [47:16] 网格 ID [15:0] 保留
+    // 深度放在网格之前: 所有命令在同一次 glMultiDrawElementsIndirect 中提交，命令之间没有状态切换，
+    // 由近到远的顺序让被遮挡的片元更早被深度测试丢弃; 同一深度层内相同网格相邻，便于合并
+    // 材质下标在实例数据中，同一条命令内可以不同，不参与排序
+    // 不依赖 GL，独立的基准测试也使用这里的实现
+    static const uint32_t PassOpaque = 0;
+    static const uint32_t VariantStatic = 0;
+    static const uint32_t VariantSkinned = 1;
+
+    // 非负浮点数的位模式与数值顺序一致，相机后方 (以及 NaN) 按 0 处理
+    inline uint32_t GetDepthBits(float depth)
+    {
+        depth = depth > 0.0f ? depth : 0.0f;
+        uint32_t bits;
+        memcpy(&bits, &depth, sizeof(bits));
+        return bits;
+    }
+
+    inline uint64_t Make(uint32_t pass, uint32_t variant, float viewDepth, uint32_t meshID)
+    {
+        return ((uint64_t)(pass & 0x3) << 62) |
+               ((uint64_t)(variant & 0x3) << 60) |
+               ((uint64_t)(GetDepthBits(viewDepth) >> 20) << 48) |
+               ((uint64_t)meshID << 16);
+    }
+}
@@ -23,6 +23,14 @@ namespace Mc
 		inline float GetDistance() const { return m_Distance; }
 		inline void SetDistance(float distance) { m_Distance = distance; }
 
+		const glm::vec3 &GetFocalPoint() const { return m_FocalPoint; }
+		// 不经过鼠标输入直接放置相机 (测试和基准程序)，先设置距离
+		inline void SetFocalPoint(const glm::vec3 &focalPoint)
+		{
+			m_FocalPoint = focalPoint;
+			UpdateView();
+		}
+
 		inline void SetViewportSize(float width, float height)
 		{
 			m_ViewportWidth = width;
@@ -0,0 +1,210 @@
+#include "FrameGraph.h"
+#include "GLState.h"
+
+#include "src/Core/Timer.h"
+
+#include <cstring>
+
+namespace Mc
+{
+    FrameGraph::Resource FrameGraph::Builder::Read(Resource resource)
+    {
+        m_Graph.m_Passes[m_Pass].Reads.push_back(resource);
+        return resource;
+    }
+
+    FrameGraph::Resource FrameGraph::Builder::Write(Resource resource)
+    {
+        m_Graph.m_Passes[m_Pass].Writes.push_back(resource);
+        return resource;
+    }
+
+    void FrameGraph::Builder::SideEffect()
+    {
+        m_Graph.m_Passes[m_Pass].SideEffect = true;
+    }
+
+    uint32_t FrameGraph::Resources::GetTexture(Resource resource) const
+    {
+        return m_Graph.m_Resources[resource].Texture;
+    }
+
+    FrameGraph::~FrameGraph()
+    {
+        for (auto &queries : m_TimerQueries)
+        {
+            if (!queries.empty())
+                glDeleteQueries((GLsizei)queries.size(), queries.data());
+        }
+    }
+
+    void FrameGraph::Reset()
+    {
+        m_Resources.clear();
+        m_Passes.clear();
+    }
+
+    FrameGraph::Resource FrameGraph::Import(const char *name, uint32_t texture)
+    {
+        ResourceNode node;
+        node.Name = name;
+        node.Texture = texture;
+        m_Resources.push_back(node);
+        return (Resource)m_Resources.size() - 1;
+    }
+
+    void FrameGraph::AddPass(const char *name, const SetupFn &setup, const ExecuteFn &execute)
+    {
+        PassNode pass;
+        pass.Name = name;
+        pass.Execute = execute;
+        m_Passes.push_back(pass);
+
+        Builder builder(*this, (uint32_t)m_Passes.size() - 1);
+        setup(builder);
+    }
+
+    void FrameGraph::Compile()
+    {
+        CullPasses();
+    }
+
+    void FrameGraph::CullPasses()
+    {
+        // 引用计数: 通道 = 输出的资源数，资源 = 读取它的通道数
+        // 从无人读取的资源出发，沿写入它的通道反向剔除，直到剩下的通道都有输出被使用
+        for (auto &resource : m_Resources)
+            resource.RefCount = 0;
+
+        for (auto &pass : m_Passes)
+        {
+            pass.Culled = false;
+            pass.RefCount = (uint32_t)pass.Writes.size();
+            for (Resource resource : pass.Reads)
+                m_Resources[resource].RefCount++;
+        }
+
+        std::vector<Resource> unreferenced;
+        for (uint32_t i = 0; i < (uint32_t)m_Resources.size(); i++)
+        {
+            if (m_Resources[i].RefCount == 0)
+                unreferenced.push_back(i);
+        }
+
+        auto releaseOutput = [&](PassNode &pass) {
+            if (pass.SideEffect || pass.Culled || pass.RefCount == 0 || --pass.RefCount > 0)
+                return;
+
+            pass.Culled = true;
+            for (Resource read : pass.Reads)
+            {
+                if (--m_Resources[read].RefCount == 0)
+                    unreferenced.push_back(read);
+            }
+        };
+
+        while (!unreferenced.empty())
+        {
+            Resource resource = unreferenced.back();
+            unreferenced.pop_back();
+
+            for (auto &pass : m_Passes)
+            {
+                for (Resource write : pass.Writes)
+                {
+                    if (write == resource)
+                        releaseOutput(pass);
+                }
+            }
+        }
+
+        // 没有任何输出的通道 (只有 SideEffect 时保留)
+        for (auto &pass : m_Passes)
+        {
+            if (!pass.SideEffect && pass.Writes.empty())
+                pass.Culled = true;
+        }
+    }
+
+    void FrameGraph::ReadTimerQueries()
+    {
+        // 这一组查询是 TimerFrames 帧之前发出的，还没完成就保留上次的结果
+        auto &queries = m_TimerQueries[m_TimerFrame];
+        auto &names = m_TimerPassNames[m_TimerFrame];
+        if (names.empty())
+            return;
+
+        GLuint ready = 0;
+        glGetQueryObjectuiv(queries[names.size() * 2 - 1], GL_QUERY_RESULT_AVAILABLE, &ready);
+        if (!ready)
+            return;
+
+        m_GpuTimings.clear();
+        for (uint32_t i = 0; i < (uint32_t)names.size(); i++)
+        {
+            GLuint64 begin = 0, end = 0;
+            glGetQueryObjectui64v(queries[i * 2], GL_QUERY_RESULT, &begin);
+            glGetQueryObjectui64v(queries[i * 2 + 1], GL_QUERY_RESULT, &end);
+
+            PassTiming timing;
+            timing.Name = names[i];
+            timing.GpuTime = (float)(end - begin) * 1e-6f;
+            m_GpuTimings.push_back(timing);
+        }
+    }
+
+    void FrameGraph::Execute()
+    {
+        ReadTimerQueries();
+
+        // 通道可以随意切换帧缓冲和视口，每个通道开始前恢复到场景的渲染目标
+        uint32_t framebuffer = GLState::GetFramebuffer();
+        int32_t viewport[4];
+        GLState::GetViewport(viewport);
+
+        auto &queries = m_TimerQueries[m_TimerFrame];
+        auto &names = m_TimerPassNames[m_TimerFrame];
+        names.clear();
+
+        m_Timings.clear();
+        Resources resources(*this);
+        for (auto &pass : m_Passes)
+        {
+            PassTiming timing;
+            timing.Name = pass.Name;
+            timing.Culled = pass.Culled;
+            for (auto &gpu : m_GpuTimings)
+            {
+                if (strcmp(gpu.Name, pass.Name) == 0)
+                    timing.GpuTime = gpu.GpuTime;
+            }
+
+            if (!pass.Culled)
+            {
+                uint32_t query = (uint32_t)names.size() * 2;
+                if (query + 2 > queries.size())
+                {
+                    queries.resize(query + 2);
+                    glGenQueries(2, &queries[query]);
+                }
+                names.push_back(pass.Name);
+
+                GLState::BindFramebuffer(framebuffer);
+                GLState::SetViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+
+                Timer timer;
+                glQueryCounter(queries[query], GL_TIMESTAMP);
+                pass.Execute(resources);
+                glQueryCounter(queries[query + 1], GL_TIMESTAMP);
+                timing.CpuTime = timer.ElapsedMillis();
+            }
+
+            m_Timings.push_back(timing);
+        }
+
+        GLState::BindFramebuffer(framebuffer);
+        GLState::SetViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+
+        m_TimerFrame = (m_TimerFrame + 1) % TimerFrames;
+    }
+}
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace Mc
+{
+    // 帧图 (frame graph)
+    // 每帧重新声明通道以及它们读写的资源，Compile 剔除输出无人读取的通道
+    // 所有资源都由外部导入: G-buffer 在批次中途的 Flush 里同样会用到，生命周期跨出帧图，不能作为临时资源
+    // 通道按加入的顺序执行 (读取的资源必须由之前的通道写入，加入顺序即拓扑顺序)
+    // 每个通道执行前恢复 Execute 开始时的帧缓冲与视口，并记录 CPU 时间和 GPU 时间戳
+    class FrameGraph
+    {
+    public:
+        using Resource = uint32_t;
+        static const Resource InvalidResource = ~0u;
+
+        // 通道的 setup 回调中声明资源的读写
+        class Builder
+        {
+        public:
+            Resource Read(Resource resource);
+            Resource Write(Resource resource);
+            // 有图形之外的作用 (例如写入最终的渲染目标)，不会被剔除
+            void SideEffect();
+
+        private:
+            Builder(FrameGraph &graph, uint32_t pass) : m_Graph(graph), m_Pass(pass) {}
+
+            FrameGraph &m_Graph;
+            uint32_t m_Pass;
+
+            friend class FrameGraph;
+        };
+
+        // 通道执行时查询资源对应的 GL 纹理
+        class Resources
+        {
+        public:
+            uint32_t GetTexture(Resource resource) const;
+
+        private:
+            Resources(const FrameGraph &graph) : m_Graph(graph) {}
+
+            const FrameGraph &m_Graph;
+
+            friend class FrameGraph;
+        };
+
+        using SetupFn = std::function<void(Builder &)>;
+        using ExecuteFn = std::function<void(const Resources &)>;
+
+        struct PassTiming
+        {
+            const char *Name = nullptr;
+            float CpuTime = 0.0f; // ms
+            float GpuTime = 0.0f; // ms，几帧之前的结果
+            bool Culled = false;
+        };
+
+        FrameGraph() = default;
+        ~FrameGraph();
+
+        FrameGraph(const FrameGraph &) = delete;
+        FrameGraph &operator=(const FrameGraph &) = delete;
+
+        // 清空上一帧的通道和资源，计时查询保留
+        void Reset();
+
+        // 外部资源 (阴影图集、光源缓冲区、场景的渲染目标)，texture 为 0 表示不是纹理
+        Resource Import(const char *name, uint32_t texture = 0);
+        // name 必须是字符串字面量，计时结果直接引用它
+        void AddPass(const char *name, const SetupFn &setup, const ExecuteFn &execute);
+
+        void Compile();
+        void Execute();
+
+        const std::vector<PassTiming> &GetPassTimings() const { return m_Timings; }
+
+    private:
+        struct ResourceNode
+        {
+            const char *Name = nullptr;
+            uint32_t Texture = 0; // 外部纹理，0 表示不是纹理
+
+            uint32_t RefCount = 0; // 读取它的未剔除通道数
+        };
+
+        struct PassNode
+        {
+            const char *Name = nullptr;
+            ExecuteFn Execute;
+            std::vector<Resource> Reads;
+            std::vector<Resource> Writes;
+            bool SideEffect = false;
+            uint32_t RefCount = 0; // 被读取的输出数
+            bool Culled = false;
+        };
+
+        void CullPasses();
+        void ReadTimerQueries();
+
+    private:
+        std::vector<ResourceNode> m_Resources;
+        std::vector<PassNode> m_Passes;
+
+        // 每个通道开始、结束各一个 GL_TIMESTAMP，不与通道内部的 GL_TIME_ELAPSED 查询冲突
+        static const uint32_t TimerFrames = 3;
+        std::vector<GLuint> m_TimerQueries[TimerFrames];
+        std::vector<const char *> m_TimerPassNames[TimerFrames];
+        uint32_t m_TimerFrame = 0;
+
+        std::vector<PassTiming> m_Timings;
+        std::vector<PassTiming> m_GpuTimings; // 最近一次读到的 GPU 时间
+    };
+}
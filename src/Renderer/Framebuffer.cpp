@@ -1,4 +1,5 @@
 #include "Framebuffer.h"
+#include "GLState.h"
 
 #include <iostream>
 #include <glad/glad.h>
@@ -22,10 +23,10 @@ namespace Mc
 
         static void BindTexture(bool multisampled, uint32_t id)
         {
-            glBindTexture(TextureTarget(multisampled), id);
+            GLState::BindTexture(TextureTarget(multisampled), id);
         }
 
-        static void AttachColorTexture(uint32_t id, int samples, GLenum internalFormat, GLenum format, uint32_t width, uint32_t height, int index)
+        static void AttachColorTexture(uint32_t id, int samples, GLenum internalFormat, GLenum format, uint32_t width, uint32_t height, int index, GLenum type = GL_UNSIGNED_BYTE)
         {
             bool multisampled = samples > 1;
             if (multisampled)
@@ -34,7 +35,7 @@ namespace Mc
             }
             else
             {
-                glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, format, GL_UNSIGNED_BYTE, nullptr);
+                glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, format, type, nullptr);
 
                 glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
                 glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
@@ -109,6 +110,8 @@ namespace Mc
             {
             case FramebufferTextureFormat::RGBA8:
                 return GL_RGBA8;
+            case FramebufferTextureFormat::RGBA16F:
+                return GL_RGBA;
             case FramebufferTextureFormat::RED_INTEGER:
                 return GL_RED_INTEGER;
             }
@@ -136,6 +139,10 @@ namespace Mc
         glDeleteFramebuffers(1, &m_RendererID);
         glDeleteTextures(m_ColorAttachments.size(), m_ColorAttachments.data());
         glDeleteTextures(1, &m_DepthAttachment);
+
+        GLState::OnDeleteFramebuffer(m_RendererID);
+        GLState::OnDeleteTextures(m_ColorAttachments.data(), (uint32_t)m_ColorAttachments.size());
+        GLState::OnDeleteTextures(&m_DepthAttachment, 1);
     }
 
     void Framebuffer::Invalidate()
@@ -146,12 +153,16 @@ namespace Mc
             glDeleteTextures(m_ColorAttachments.size(), m_ColorAttachments.data());
             glDeleteTextures(1, &m_DepthAttachment);
 
+            GLState::OnDeleteFramebuffer(m_RendererID);
+            GLState::OnDeleteTextures(m_ColorAttachments.data(), (uint32_t)m_ColorAttachments.size());
+            GLState::OnDeleteTextures(&m_DepthAttachment, 1);
+
             m_ColorAttachments.clear();
             m_DepthAttachment = 0;
         }
 
         glCreateFramebuffers(1, &m_RendererID);
-        glBindFramebuffer(GL_FRAMEBUFFER, m_RendererID);
+        GLState::BindFramebuffer(m_RendererID);
 
         bool multisample = m_Specification.Samples > 1;
 
@@ -169,6 +180,9 @@ namespace Mc
                 case FramebufferTextureFormat::RGBA8:
                     Utils::AttachColorTexture(m_ColorAttachments[i], m_Specification.Samples, GL_RGBA8, GL_RGBA, m_Specification.Width, m_Specification.Height, i);
                     break;
+                case FramebufferTextureFormat::RGBA16F:
+                    Utils::AttachColorTexture(m_ColorAttachments[i], m_Specification.Samples, GL_RGBA16F, GL_RGBA, m_Specification.Width, m_Specification.Height, i, GL_FLOAT);
+                    break;
                 case FramebufferTextureFormat::RED_INTEGER:
                     Utils::AttachColorTexture(m_ColorAttachments[i], m_Specification.Samples, GL_R32I, GL_RED_INTEGER, m_Specification.Width, m_Specification.Height, i);
                     break;
@@ -193,9 +207,11 @@ namespace Mc
 
         if (m_ColorAttachments.size() > 1)
         {
-            if (m_ColorAttachments.size() <= 4)
+            // G-buffer 需要 4 个以上的颜色附件
+            if (m_ColorAttachments.size() <= 8)
             {
-                GLenum buffers[4] = {GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1, GL_COLOR_ATTACHMENT2, GL_COLOR_ATTACHMENT3};
+                GLenum buffers[8] = {GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1, GL_COLOR_ATTACHMENT2, GL_COLOR_ATTACHMENT3,
+                                     GL_COLOR_ATTACHMENT4, GL_COLOR_ATTACHMENT5, GL_COLOR_ATTACHMENT6, GL_COLOR_ATTACHMENT7};
                 glDrawBuffers(m_ColorAttachments.size(), buffers);
             }
         }
@@ -209,18 +225,18 @@ namespace Mc
         if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
             std::cout << "Framebuffer not complete!" << std::endl;
 
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        GLState::BindFramebuffer(0);
     }
 
     void Framebuffer::Bind()
     {
-        glBindFramebuffer(GL_FRAMEBUFFER, m_RendererID);
-        glViewport(0, 0, m_Specification.Width, m_Specification.Height);
+        GLState::BindFramebuffer(m_RendererID);
+        GLState::SetViewport(0, 0, m_Specification.Width, m_Specification.Height);
     }
 
     void Framebuffer::UnBind()
     {
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        GLState::BindFramebuffer(0);
     }
 
     void Framebuffer::Resize(uint32_t width, uint32_t height)
@@ -262,8 +278,7 @@ namespace Mc
 
     void Framebuffer::BindDepthAttachment(int slot)
     {
-        glActiveTexture(GL_TEXTURE0 + slot);
-        glBindTexture(GL_TEXTURE_2D, m_DepthAttachment);
+        GLState::BindTextureUnit(slot, m_DepthAttachment);
     }
 
     const FramebufferSpecification &Framebuffer::GetSpecification() const
@@ -13,6 +13,7 @@ namespace Mc {
 
         // Color
         RGBA8,
+        RGBA16F,
         RED_INTEGER,
         // DirShadow Depth
         DIRSHADOW,
@@ -70,6 +71,7 @@ namespace Mc {
 
         uint32_t GetColorAttachmentRendererID(uint32_t index = 0) const;
         uint32_t GetDepthAttachmentRendererID() const { return m_DepthAttachment; };
+        uint32_t GetRendererID() const { return m_RendererID; }
 
         // 启动帧缓冲中的深度纹理
         void BindDepthAttachment(int slot = 0);
@@ -0,0 +1,524 @@
+#include "GLState.h"
+
+namespace Mc
+{
+    static const uint32_t s_Unknown = ~0u;
+
+    struct GLStateData
+    {
+        static const uint32_t MaxTextureUnits = 96;
+        static const uint32_t MaxIndexedBindings = 32;
+        static const uint32_t CapabilityCount = 6;
+
+        // 缓存的通用绑定点
+        enum BufferTarget
+        {
+            ArrayBuffer = 0,
+            ShaderStorageBuffer,
+            UniformBuffer,
+            DrawIndirectBuffer,
+            DispatchIndirectBuffer,
+            ParameterBuffer,
+            BufferTargetCount
+        };
+
+        struct IndexedBinding
+        {
+            uint32_t Buffer = s_Unknown;
+            GLintptr Offset = 0;
+            GLsizeiptr Size = 0; // 0 表示整个缓冲区 (glBindBufferBase)
+        };
+
+        uint32_t Program = s_Unknown;
+        uint32_t VertexArray = s_Unknown;
+        uint32_t Framebuffer = s_Unknown;
+
+        bool ViewportKnown = false;
+        bool ViewportArrayDirty = true;
+        int32_t Viewport[4] = {};
+
+        uint32_t Buffers[BufferTargetCount];
+        IndexedBinding ShaderStorageBindings[MaxIndexedBindings];
+        IndexedBinding UniformBindings[MaxIndexedBindings];
+
+        uint32_t ActiveTexture = s_Unknown;
+        uint32_t Textures[MaxTextureUnits];
+
+        // 0: 关闭, 1: 开启, s_Unknown: 未知
+        uint32_t Capabilities[CapabilityCount];
+
+        uint32_t DepthFunc = s_Unknown;
+        uint32_t DepthMask = s_Unknown;
+        uint32_t ColorMask = s_Unknown;
+        bool PolygonOffsetKnown = false;
+        float PolygonOffset[2] = {};
+        uint32_t BlendFunc[2] = {s_Unknown, s_Unknown};
+
+        GLState::Statistics Stats;
+
+        GLStateData() { Reset(); }
+
+        void Reset()
+        {
+            Program = s_Unknown;
+            VertexArray = s_Unknown;
+            Framebuffer = s_Unknown;
+            ViewportKnown = false;
+            ViewportArrayDirty = true;
+
+            for (auto &buffer : Buffers)
+                buffer = s_Unknown;
+            for (auto &binding : ShaderStorageBindings)
+                binding = IndexedBinding();
+            for (auto &binding : UniformBindings)
+                binding = IndexedBinding();
+
+            ActiveTexture = s_Unknown;
+            for (auto &texture : Textures)
+                texture = s_Unknown;
+            for (auto &capability : Capabilities)
+                capability = s_Unknown;
+
+            DepthFunc = s_Unknown;
+            DepthMask = s_Unknown;
+            ColorMask = s_Unknown;
+            PolygonOffsetKnown = false;
+            BlendFunc[0] = BlendFunc[1] = s_Unknown;
+        }
+    };
+
+    static GLStateData s_State;
+
+    // 返回 true 表示需要发出调用，同时统计
+    static bool Changed(bool changed)
+    {
+        if (changed)
+            s_State.Stats.Issued++;
+        else
+            s_State.Stats.Filtered++;
+        return changed;
+    }
+
+    static int GetBufferTarget(GLenum target)
+    {
+        switch (target)
+        {
+            case GL_ARRAY_BUFFER:             return GLStateData::ArrayBuffer;
+            case GL_SHADER_STORAGE_BUFFER:    return GLStateData::ShaderStorageBuffer;
+            case GL_UNIFORM_BUFFER:           return GLStateData::UniformBuffer;
+            case GL_DRAW_INDIRECT_BUFFER:     return GLStateData::DrawIndirectBuffer;
+            case GL_DISPATCH_INDIRECT_BUFFER: return GLStateData::DispatchIndirectBuffer;
+            case GL_PARAMETER_BUFFER:         return GLStateData::ParameterBuffer;
+        }
+        return -1;
+    }
+
+    static GLStateData::IndexedBinding *GetIndexedBinding(GLenum target, uint32_t index)
+    {
+        if (index >= GLStateData::MaxIndexedBindings)
+            return nullptr;
+        if (target == GL_SHADER_STORAGE_BUFFER)
+            return &s_State.ShaderStorageBindings[index];
+        if (target == GL_UNIFORM_BUFFER)
+            return &s_State.UniformBindings[index];
+        return nullptr;
+    }
+
+    static int GetCapability(GLenum capability)
+    {
+        switch (capability)
+        {
+            case GL_BLEND:               return 0;
+            case GL_DEPTH_TEST:          return 1;
+            case GL_CULL_FACE:           return 2;
+            case GL_POLYGON_OFFSET_FILL: return 3;
+            case GL_SCISSOR_TEST:        return 4;
+            case GL_LINE_SMOOTH:         return 5;
+        }
+        return -1;
+    }
+
+    void GLState::Invalidate()
+    {
+        Statistics stats = s_State.Stats;
+        s_State.Reset();
+        s_State.Stats = stats;
+    }
+
+    void GLState::UseProgram(uint32_t program)
+    {
+        if (Changed(s_State.Program != program))
+        {
+            glUseProgram(program);
+            s_State.Program = program;
+        }
+    }
+
+    void GLState::BindVertexArray(uint32_t vertexArray)
+    {
+        if (Changed(s_State.VertexArray != vertexArray))
+        {
+            glBindVertexArray(vertexArray);
+            s_State.VertexArray = vertexArray;
+        }
+    }
+
+    void GLState::BindFramebuffer(uint32_t framebuffer)
+    {
+        if (Changed(s_State.Framebuffer != framebuffer))
+        {
+            glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+            s_State.Framebuffer = framebuffer;
+        }
+    }
+
+    uint32_t GLState::GetFramebuffer()
+    {
+        if (s_State.Framebuffer == s_Unknown)
+        {
+            GLint framebuffer = 0;
+            glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &framebuffer);
+            s_State.Framebuffer = (uint32_t)framebuffer;
+            s_State.Stats.Issued++;
+        }
+        else
+        {
+            s_State.Stats.Filtered++;
+        }
+        return s_State.Framebuffer;
+    }
+
+    void GLState::SetViewport(int32_t x, int32_t y, int32_t width, int32_t height)
+    {
+        const int32_t *viewport = s_State.Viewport;
+        bool same = s_State.ViewportKnown && !s_State.ViewportArrayDirty &&
+                    viewport[0] == x && viewport[1] == y && viewport[2] == width && viewport[3] == height;
+        if (Changed(!same))
+        {
+            // glViewport 同时重置视口数组中的所有视口
+            glViewport(x, y, width, height);
+            s_State.Viewport[0] = x;
+            s_State.Viewport[1] = y;
+            s_State.Viewport[2] = width;
+            s_State.Viewport[3] = height;
+            s_State.ViewportKnown = true;
+            s_State.ViewportArrayDirty = false;
+        }
+    }
+
+    void GLState::SetViewportIndexed(uint32_t index, float x, float y, float width, float height)
+    {
+        glViewportIndexedf(index, x, y, width, height);
+        s_State.Stats.Issued++;
+
+        if (index == 0)
+        {
+            s_State.Viewport[0] = (int32_t)x;
+            s_State.Viewport[1] = (int32_t)y;
+            s_State.Viewport[2] = (int32_t)width;
+            s_State.Viewport[3] = (int32_t)height;
+            s_State.ViewportKnown = true;
+        }
+        else
+        {
+            s_State.ViewportArrayDirty = true;
+        }
+    }
+
+    void GLState::GetViewport(int32_t viewport[4])
+    {
+        if (!s_State.ViewportKnown)
+        {
+            glGetIntegerv(GL_VIEWPORT, s_State.Viewport);
+            s_State.ViewportKnown = true;
+            s_State.Stats.Issued++;
+        }
+        else
+        {
+            s_State.Stats.Filtered++;
+        }
+
+        for (int i = 0; i < 4; i++)
+            viewport[i] = s_State.Viewport[i];
+    }
+
+    void GLState::BindBuffer(GLenum target, uint32_t buffer)
+    {
+        int index = GetBufferTarget(target);
+        if (index < 0)
+        {
+            glBindBuffer(target, buffer);
+            s_State.Stats.Issued++;
+            return;
+        }
+
+        if (Changed(s_State.Buffers[index] != buffer))
+        {
+            glBindBuffer(target, buffer);
+            s_State.Buffers[index] = buffer;
+        }
+    }
+
+    void GLState::BindBufferBase(GLenum target, uint32_t index, uint32_t buffer)
+    {
+        GLStateData::IndexedBinding *binding = GetIndexedBinding(target, index);
+        if (binding && !Changed(binding->Buffer != buffer || binding->Size != 0))
+            return;
+        if (!binding)
+            s_State.Stats.Issued++;
+
+        glBindBufferBase(target, index, buffer);
+        if (binding)
+            *binding = {buffer, 0, 0};
+
+        int generic = GetBufferTarget(target);
+        if (generic >= 0)
+            s_State.Buffers[generic] = buffer;
+    }
+
+    void GLState::BindBufferRange(GLenum target, uint32_t index, uint32_t buffer, GLintptr offset, GLsizeiptr size)
+    {
+        GLStateData::IndexedBinding *binding = GetIndexedBinding(target, index);
+        if (binding && !Changed(binding->Buffer != buffer || binding->Offset != offset || binding->Size != size))
+            return;
+        if (!binding)
+            s_State.Stats.Issued++;
+
+        glBindBufferRange(target, index, buffer, offset, size);
+        if (binding)
+            *binding = {buffer, offset, size};
+
+        int generic = GetBufferTarget(target);
+        if (generic >= 0)
+            s_State.Buffers[generic] = buffer;
+    }
+
+    void GLState::BindTextureUnit(uint32_t unit, uint32_t texture)
+    {
+        if (unit >= GLStateData::MaxTextureUnits)
+        {
+            glBindTextureUnit(unit, texture);
+            s_State.Stats.Issued++;
+            return;
+        }
+
+        // 纹理单元上的每个目标各有绑定，缓存记录最后绑定的纹理，与之相同即说明它仍在自己的目标上
+        if (Changed(s_State.Textures[unit] != texture))
+        {
+            glBindTextureUnit(unit, texture);
+            s_State.Textures[unit] = texture;
+        }
+    }
+
+    void GLState::BindTexture(GLenum target, uint32_t texture)
+    {
+        if (s_State.ActiveTexture == s_Unknown)
+        {
+            GLint active = GL_TEXTURE0;
+            glGetIntegerv(GL_ACTIVE_TEXTURE, &active);
+            s_State.ActiveTexture = (uint32_t)(active - GL_TEXTURE0);
+        }
+
+        glBindTexture(target, texture);
+        s_State.Stats.Issued++;
+
+        if (s_State.ActiveTexture < GLStateData::MaxTextureUnits)
+            s_State.Textures[s_State.ActiveTexture] = texture;
+    }
+
+    void GLState::SetEnabled(GLenum capability, bool enabled)
+    {
+        int index = GetCapability(capability);
+        if (index >= 0 && !Changed(s_State.Capabilities[index] != (uint32_t)enabled))
+            return;
+        if (index < 0)
+            s_State.Stats.Issued++;
+
+        if (enabled)
+            glEnable(capability);
+        else
+            glDisable(capability);
+
+        if (index >= 0)
+            s_State.Capabilities[index] = (uint32_t)enabled;
+    }
+
+    bool GLState::IsEnabled(GLenum capability)
+    {
+        int index = GetCapability(capability);
+        if (index < 0)
+        {
+            s_State.Stats.Issued++;
+            return glIsEnabled(capability);
+        }
+
+        if (s_State.Capabilities[index] == s_Unknown)
+        {
+            s_State.Capabilities[index] = glIsEnabled(capability) ? 1 : 0;
+            s_State.Stats.Issued++;
+        }
+        else
+        {
+            s_State.Stats.Filtered++;
+        }
+        return s_State.Capabilities[index] != 0;
+    }
+
+    void GLState::SetDepthFunc(GLenum func)
+    {
+        if (Changed(s_State.DepthFunc != func))
+        {
+            glDepthFunc(func);
+            s_State.DepthFunc = func;
+        }
+    }
+
+    GLenum GLState::GetDepthFunc()
+    {
+        if (s_State.DepthFunc == s_Unknown)
+        {
+            GLint func = GL_LESS;
+            glGetIntegerv(GL_DEPTH_FUNC, &func);
+            s_State.DepthFunc = (uint32_t)func;
+            s_State.Stats.Issued++;
+        }
+        else
+        {
+            s_State.Stats.Filtered++;
+        }
+        return (GLenum)s_State.DepthFunc;
+    }
+
+    void GLState::SetDepthMask(bool enabled)
+    {
+        if (Changed(s_State.DepthMask != (uint32_t)enabled))
+        {
+            glDepthMask(enabled ? GL_TRUE : GL_FALSE);
+            s_State.DepthMask = (uint32_t)enabled;
+        }
+    }
+
+    bool GLState::GetDepthMask()
+    {
+        if (s_State.DepthMask == s_Unknown)
+        {
+            GLboolean mask = GL_TRUE;
+            glGetBooleanv(GL_DEPTH_WRITEMASK, &mask);
+            s_State.DepthMask = mask ? 1 : 0;
+            s_State.Stats.Issued++;
+        }
+        else
+        {
+            s_State.Stats.Filtered++;
+        }
+        return s_State.DepthMask != 0;
+    }
+
+    void GLState::SetColorMask(uint32_t mask)
+    {
+        mask &= ColorMaskAll;
+        if (Changed(s_State.ColorMask != mask))
+        {
+            glColorMask((mask & 0x1) ? GL_TRUE : GL_FALSE, (mask & 0x2) ? GL_TRUE : GL_FALSE,
+                        (mask & 0x4) ? GL_TRUE : GL_FALSE, (mask & 0x8) ? GL_TRUE : GL_FALSE);
+            s_State.ColorMask = mask;
+        }
+    }
+
+    uint32_t GLState::GetColorMask()
+    {
+        if (s_State.ColorMask == s_Unknown)
+        {
+            GLboolean mask[4] = {GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE};
+            glGetBooleanv(GL_COLOR_WRITEMASK, mask);
+            s_State.ColorMask = (mask[0] ? 0x1u : 0u) | (mask[1] ? 0x2u : 0u) | (mask[2] ? 0x4u : 0u) | (mask[3] ? 0x8u : 0u);
+            s_State.Stats.Issued++;
+        }
+        else
+        {
+            s_State.Stats.Filtered++;
+        }
+        return s_State.ColorMask;
+    }
+
+    void GLState::SetPolygonOffset(float factor, float units)
+    {
+        bool same = s_State.PolygonOffsetKnown && s_State.PolygonOffset[0] == factor && s_State.PolygonOffset[1] == units;
+        if (Changed(!same))
+        {
+            glPolygonOffset(factor, units);
+            s_State.PolygonOffset[0] = factor;
+            s_State.PolygonOffset[1] = units;
+            s_State.PolygonOffsetKnown = true;
+        }
+    }
+
+    void GLState::SetBlendFunc(GLenum source, GLenum destination)
+    {
+        if (Changed(s_State.BlendFunc[0] != source || s_State.BlendFunc[1] != destination))
+        {
+            glBlendFunc(source, destination);
+            s_State.BlendFunc[0] = source;
+            s_State.BlendFunc[1] = destination;
+        }
+    }
+
+    void GLState::OnDeleteProgram(uint32_t program)
+    {
+        if (s_State.Program == program)
+            s_State.Program = s_Unknown;
+    }
+
+    void GLState::OnDeleteVertexArray(uint32_t vertexArray)
+    {
+        if (s_State.VertexArray == vertexArray)
+            s_State.VertexArray = s_Unknown;
+    }
+
+    void GLState::OnDeleteFramebuffer(uint32_t framebuffer)
+    {
+        if (s_State.Framebuffer == framebuffer)
+            s_State.Framebuffer = s_Unknown;
+    }
+
+    void GLState::OnDeleteBuffer(uint32_t buffer)
+    {
+        for (auto &bound : s_State.Buffers)
+        {
+            if (bound == buffer)
+                bound = s_Unknown;
+        }
+        for (auto &binding : s_State.ShaderStorageBindings)
+        {
+            if (binding.Buffer == buffer)
+                binding.Buffer = s_Unknown;
+        }
+        for (auto &binding : s_State.UniformBindings)
+        {
+            if (binding.Buffer == buffer)
+                binding.Buffer = s_Unknown;
+        }
+    }
+
+    void GLState::OnDeleteTextures(const uint32_t *textures, uint32_t count)
+    {
+        for (uint32_t i = 0; i < count; i++)
+        {
+            for (auto &bound : s_State.Textures)
+            {
+                if (bound == textures[i])
+                    bound = s_Unknown;
+            }
+        }
+    }
+
+    GLState::Statistics GLState::GetStats()
+    {
+        return s_State.Stats;
+    }
+
+    void GLState::ResetStats()
+    {
+        s_State.Stats = Statistics();
+    }
+}
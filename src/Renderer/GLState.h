@@ -0,0 +1,77 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <cstdint>
+
+namespace Mc
+{
+    // OpenGL 状态的影子副本
+    // 与缓存相同的设置不发出 GL 调用，视口、帧缓冲、开关状态的查询直接返回缓存的值，不再 glGet
+    // 渲染器中所有绑定都应经过这里，直接调用 GL 修改状态的代码 (ImGui) 之后调用 Invalidate
+    class GLState
+    {
+    public:
+        // 所有缓存标记为未知，下一次设置一定发出，查询时读取一次 GL
+        static void Invalidate();
+
+        // Program / Vertex Array
+        static void UseProgram(uint32_t program);
+        static void BindVertexArray(uint32_t vertexArray);
+
+        // Framebuffer (GL_FRAMEBUFFER，读写同时绑定)
+        static void BindFramebuffer(uint32_t framebuffer);
+        static uint32_t GetFramebuffer();
+
+        static void SetViewport(int32_t x, int32_t y, int32_t width, int32_t height);
+        // 视口数组 (阴影级联)，只缓存 0 号视口，其余视口修改后下一次 SetViewport 一定发出
+        static void SetViewportIndexed(uint32_t index, float x, float y, float width, float height);
+        static void GetViewport(int32_t viewport[4]);
+
+        // Buffer
+        // GL_ELEMENT_ARRAY_BUFFER 属于 VAO 的状态，不缓存
+        static void BindBuffer(GLenum target, uint32_t buffer);
+        // 同时修改 target 的通用绑定点
+        static void BindBufferBase(GLenum target, uint32_t index, uint32_t buffer);
+        static void BindBufferRange(GLenum target, uint32_t index, uint32_t buffer, GLintptr offset, GLsizeiptr size);
+
+        // Texture
+        static void BindTextureUnit(uint32_t unit, uint32_t texture);
+        // 创建纹理时使用 (非 DSA)，绑定到当前激活的纹理单元
+        static void BindTexture(GLenum target, uint32_t texture);
+
+        // Capability (GL_BLEND, GL_DEPTH_TEST, GL_CULL_FACE, GL_POLYGON_OFFSET_FILL, GL_SCISSOR_TEST, GL_LINE_SMOOTH)
+        static void SetEnabled(GLenum capability, bool enabled);
+        static void Enable(GLenum capability) { SetEnabled(capability, true); }
+        static void Disable(GLenum capability) { SetEnabled(capability, false); }
+        static bool IsEnabled(GLenum capability);
+
+        static void SetDepthFunc(GLenum func);
+        static GLenum GetDepthFunc();
+        static void SetDepthMask(bool enabled);
+        static bool GetDepthMask();
+
+        // 颜色写入掩码按 RGBA 打包为 4 位 (R 为最低位)，便于保存后原样恢复
+        static const uint32_t ColorMaskNone = 0x0;
+        static const uint32_t ColorMaskAll = 0xF;
+        static void SetColorMask(uint32_t mask);
+        static uint32_t GetColorMask();
+        static void SetPolygonOffset(float factor, float units);
+        static void SetBlendFunc(GLenum source, GLenum destination);
+
+        // 对象删除后 ID 可能被新对象复用，缓存中引用它的项标记为未知
+        static void OnDeleteProgram(uint32_t program);
+        static void OnDeleteVertexArray(uint32_t vertexArray);
+        static void OnDeleteFramebuffer(uint32_t framebuffer);
+        static void OnDeleteBuffer(uint32_t buffer);
+        static void OnDeleteTextures(const uint32_t *textures, uint32_t count);
+
+        struct Statistics
+        {
+            uint32_t Issued = 0;   // 实际发出的状态调用
+            uint32_t Filtered = 0; // 与缓存相同而省略的调用 (包括由缓存回答的查询)
+        };
+        static Statistics GetStats();
+        static void ResetStats();
+    };
+}
@@ -1,4 +1,5 @@
 #include "GraphicsContext.h"
+#include "BindlessTexture.h"
 
 #include <GLFW/glfw3.h>
 #include <glad/glad.h>
@@ -20,6 +21,8 @@ namespace Mc
 		LOG_CORE_INFO("  Vendor: {0}", glGetString(GL_VENDOR));
 		LOG_CORE_INFO("  Renderer: {0}", glGetString(GL_RENDERER));
 		LOG_CORE_INFO("  Version: {0}", glGetString(GL_VERSION));
+
+		BindlessTexture::Init((BindlessTexture::LoadProc)glfwGetProcAddress);
 	}
 
 	void GraphicsContext::SwapBuffers()
@@ -2,6 +2,7 @@
 
 #include "src/Core/Application.h"
 #include "src/Renderer/Framebuffer.h"
+#include "src/Renderer/GLState.h"
 
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
@@ -48,6 +49,10 @@ namespace Mc
         glDeleteTextures(1, &m_BrdfLUTMap);
         glDeleteFramebuffers(1, &m_CaptureFBO);
         glDeleteRenderbuffers(1, &m_CaptureRBO);
+
+        const uint32_t textures[] = {m_HdrTexture, m_EnvCubemap, m_IrradianceMap, m_PrefilterMap, m_BrdfLUTMap};
+        GLState::OnDeleteTextures(textures, 5);
+        GLState::OnDeleteFramebuffer(m_CaptureFBO);
     }
 
     void HDRSkybox::LoadHDRMap(const std::string &filepath)
@@ -55,10 +60,9 @@ namespace Mc
         path = filepath;
 
         // --- 状态保存 ---
-        GLint viewport[4];
-        glGetIntegerv(GL_VIEWPORT, viewport);
-        GLint currentFBO;
-        glGetIntegerv(GL_FRAMEBUFFER_BINDING, &currentFBO);
+        int32_t viewport[4];
+        GLState::GetViewport(viewport);
+        uint32_t currentFBO = GLState::GetFramebuffer();
         // --- 状态保存结束 ---
         
         // pbr: load the HDR environment map
@@ -69,7 +73,7 @@ namespace Mc
         if (data)
         {
             glGenTextures(1, &m_HdrTexture);
-            glBindTexture(GL_TEXTURE_2D, m_HdrTexture);
+            GLState::BindTexture(GL_TEXTURE_2D, m_HdrTexture);
             glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB16F, width, height, 0, GL_RGB, GL_FLOAT, data);
 
             glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
@@ -87,7 +91,7 @@ namespace Mc
         // pbr: setup cubemap to render to and attach to framebuffer
         // ---------------------------------------------------------
         glGenTextures(1, &m_EnvCubemap);
-        glBindTexture(GL_TEXTURE_CUBE_MAP, m_EnvCubemap);
+        GLState::BindTexture(GL_TEXTURE_CUBE_MAP, m_EnvCubemap);
         for (unsigned int i = 0; i < 6; ++i)
         {
             glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_RGB16F, 512, 512, 0, GL_RGB, GL_FLOAT, nullptr);
@@ -104,11 +108,10 @@ namespace Mc
         m_EquirectangularToCubemapShader->Bind();
         m_EquirectangularToCubemapShader->SetInt("equirectangularMap", 0);
         m_EquirectangularToCubemapShader->SetMat4("projection", captureProjection);
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, m_HdrTexture);
+        GLState::BindTextureUnit(0, m_HdrTexture);
 
-        glViewport(0, 0, 512, 512); // don't forget to configure the viewport to the capture dimensions.
-        glBindFramebuffer(GL_FRAMEBUFFER, m_CaptureFBO);
+        GLState::SetViewport(0, 0, 512, 512); // don't forget to configure the viewport to the capture dimensions.
+        GLState::BindFramebuffer(m_CaptureFBO);
         for (unsigned int i = 0; i < 6; ++i)
         {
             m_EquirectangularToCubemapShader->SetMat4("view", captureViews[i]);
@@ -120,12 +123,12 @@ namespace Mc
         }
         
         // --- 状态恢复 ---
-        glBindFramebuffer(GL_FRAMEBUFFER, currentFBO);
-        glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+        GLState::BindFramebuffer(currentFBO);
+        GLState::SetViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
         // --- 状态恢复结束 ---
 
         // then let OpenGL generate mipmaps from first mip face (combatting visible dots artifact)
-        glBindTexture(GL_TEXTURE_CUBE_MAP, m_EnvCubemap);
+        GLState::BindTexture(GL_TEXTURE_CUBE_MAP, m_EnvCubemap);
         glGenerateMipmap(GL_TEXTURE_CUBE_MAP);
 
         // 预计算辐射度图
@@ -140,14 +143,13 @@ namespace Mc
 
     void HDRSkybox::Render(const glm::mat4 &projection, const glm::mat4 &view)
     {
-        glDepthFunc(GL_LEQUAL);
+        GLState::SetDepthFunc(GL_LEQUAL);
         
         // render skybox (render as last to prevent overdraw)
         m_BackgroundShader->Bind();
         m_BackgroundShader->SetMat4("projection", projection);
         m_BackgroundShader->SetMat4("view", view);
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_CUBE_MAP, m_EnvCubemap);
+        GLState::BindTextureUnit(0, m_EnvCubemap);
         // glBindTexture(GL_TEXTURE_CUBE_MAP, irradianceMap);
         // glBindTexture(GL_TEXTURE_CUBE_MAP, prefilterMap);
         m_BackgroundShader->SetInt("environmentMap", 0);
@@ -157,23 +159,20 @@ namespace Mc
         // brdfShader->Bind();
         // quadArray->Bind();
         // glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
-        glDepthFunc(GL_LESS);
+        GLState::SetDepthFunc(GL_LESS);
     }
 
     void HDRSkybox::Bind(Ref<Shader> shader)
     {
         shader->Bind();
 
-        glActiveTexture(GL_TEXTURE0 + 32);
-        glBindTexture(GL_TEXTURE_CUBE_MAP, m_IrradianceMap);
+        GLState::BindTextureUnit(32, m_IrradianceMap);
         shader->SetInt("irradianceMap", 32);
 
-        glActiveTexture(GL_TEXTURE0 + 33);
-        glBindTexture(GL_TEXTURE_CUBE_MAP, m_PrefilterMap);
+        GLState::BindTextureUnit(33, m_PrefilterMap);
         shader->SetInt("prefilterMap", 33);
 
-        glActiveTexture(GL_TEXTURE0 + 34);
-        glBindTexture(GL_TEXTURE_2D, m_BrdfLUTMap);
+        GLState::BindTextureUnit(34, m_BrdfLUTMap);
         shader->SetInt("brdfLUT", 34);
 
         shader->Unbind();
@@ -181,30 +180,24 @@ namespace Mc
 
     void HDRSkybox::Unbind()
     {
-        glActiveTexture(GL_TEXTURE0 + 32);
-        glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
-
-        glActiveTexture(GL_TEXTURE0 + 33);
-        glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
-
-        glActiveTexture(GL_TEXTURE0 + 34);
-        glBindTexture(GL_TEXTURE_2D, 0);
+        GLState::BindTextureUnit(32, 0);
+        GLState::BindTextureUnit(33, 0);
+        GLState::BindTextureUnit(34, 0);
     }
 
     void HDRSkybox::PrecomputeIrradianceMap()
     {
         // --- 状态保存 ---
-        GLint viewport[4];
-        glGetIntegerv(GL_VIEWPORT, viewport);
-        GLint currentFBO;
-        glGetIntegerv(GL_FRAMEBUFFER_BINDING, &currentFBO);
+        int32_t viewport[4];
+        GLState::GetViewport(viewport);
+        uint32_t currentFBO = GLState::GetFramebuffer();
         // --- 状态保存结束 ---
         
         // pbr: create an irradiance cubemap, and re-scale capture FBO to irradiance scale.
         // --------------------------------------------------------------------------------
         // unsigned int irradianceMap;
         glGenTextures(1, &m_IrradianceMap);
-        glBindTexture(GL_TEXTURE_CUBE_MAP, m_IrradianceMap);
+        GLState::BindTexture(GL_TEXTURE_CUBE_MAP, m_IrradianceMap);
         for (unsigned int i = 0; i < 6; ++i)
         {
             glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_RGB16F, 32, 32, 0, GL_RGB, GL_FLOAT, nullptr);
@@ -215,7 +208,7 @@ namespace Mc
         glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
         glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
-        glBindFramebuffer(GL_FRAMEBUFFER, m_CaptureFBO);
+        GLState::BindFramebuffer(m_CaptureFBO);
         glBindRenderbuffer(GL_RENDERBUFFER, m_CaptureRBO);
         glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, 32, 32);
 
@@ -224,11 +217,10 @@ namespace Mc
         m_IrradianceShader->Bind();
         m_IrradianceShader->SetInt("environmentMap", 0);
         m_IrradianceShader->SetMat4("projection", captureProjection);
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_CUBE_MAP, m_EnvCubemap);
+        GLState::BindTextureUnit(0, m_EnvCubemap);
 
-        glViewport(0, 0, 32, 32); // don't forget to configure the viewport to the capture dimensions.
-        glBindFramebuffer(GL_FRAMEBUFFER, m_CaptureFBO);
+        GLState::SetViewport(0, 0, 32, 32); // don't forget to configure the viewport to the capture dimensions.
+        GLState::BindFramebuffer(m_CaptureFBO);
         for (unsigned int i = 0; i < 6; ++i)
         {
             m_IrradianceShader->SetMat4("view", captureViews[i]);
@@ -240,25 +232,24 @@ namespace Mc
         }
         
         // --- 状态恢复 ---
-        glBindFramebuffer(GL_FRAMEBUFFER, currentFBO);
-        glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+        GLState::BindFramebuffer(currentFBO);
+        GLState::SetViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
         // --- 状态恢复结束 ---
     }
 
     void HDRSkybox::PrecomputePrefilterMap()
     {
         // --- 状态保存 ---
-        GLint viewport[4];
-        glGetIntegerv(GL_VIEWPORT, viewport);
-        GLint currentFBO;
-        glGetIntegerv(GL_FRAMEBUFFER_BINDING, &currentFBO);
+        int32_t viewport[4];
+        GLState::GetViewport(viewport);
+        uint32_t currentFBO = GLState::GetFramebuffer();
         // --- 状态保存结束 ---
         
         // pbr: create a pre-filter cubemap, and re-scale capture FBO to pre-filter scale.
         // --------------------------------------------------------------------------------
         // unsigned int prefilterMap;
         glGenTextures(1, &m_PrefilterMap);
-        glBindTexture(GL_TEXTURE_CUBE_MAP, m_PrefilterMap);
+        GLState::BindTexture(GL_TEXTURE_CUBE_MAP, m_PrefilterMap);
         for (unsigned int i = 0; i < 6; ++i)
         {
             glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_RGB16F, 128, 128, 0, GL_RGB, GL_FLOAT, nullptr);
@@ -276,10 +267,9 @@ namespace Mc
         m_PrefilterShader->Bind();
         m_PrefilterShader->SetInt("environmentMap", 0);
         m_PrefilterShader->SetMat4("projection", captureProjection);
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_CUBE_MAP, m_EnvCubemap);
+        GLState::BindTextureUnit(0, m_EnvCubemap);
 
-        glBindFramebuffer(GL_FRAMEBUFFER, m_CaptureFBO);
+        GLState::BindFramebuffer(m_CaptureFBO);
         unsigned int maxMipLevels = 5;
         for (unsigned int mip = 0; mip < maxMipLevels; ++mip)
         {
@@ -288,7 +278,7 @@ namespace Mc
             unsigned int mipHeight = static_cast<unsigned int>(128 * std::pow(0.5, mip));
             glBindRenderbuffer(GL_RENDERBUFFER, m_CaptureRBO);
             glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, mipWidth, mipHeight);
-            glViewport(0, 0, mipWidth, mipHeight);
+            GLState::SetViewport(0, 0, mipWidth, mipHeight);
 
             float roughness = (float)mip / (float)(maxMipLevels - 1);
             m_PrefilterShader->SetFloat("roughness", roughness);
@@ -304,18 +294,17 @@ namespace Mc
         }
         
         // --- 状态恢复 ---
-        glBindFramebuffer(GL_FRAMEBUFFER, currentFBO);
-        glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+        GLState::BindFramebuffer(currentFBO);
+        GLState::SetViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
         // --- 状态恢复结束 ---
     }
 
     void HDRSkybox::PrecomputeBRDFLUT()
     {
         // --- 状态保存 ---
-        GLint viewport[4];
-        glGetIntegerv(GL_VIEWPORT, viewport);
-        GLint currentFBO;
-        glGetIntegerv(GL_FRAMEBUFFER_BINDING, &currentFBO);
+        int32_t viewport[4];
+        GLState::GetViewport(viewport);
+        uint32_t currentFBO = GLState::GetFramebuffer();
         // --- 状态保存结束 ---
         
         // pbr: generate a 2D LUT from the BRDF equations used.
@@ -324,7 +313,7 @@ namespace Mc
         glGenTextures(1, &m_BrdfLUTMap);
 
         // pre-allocate enough memory for the LUT texture.
-        glBindTexture(GL_TEXTURE_2D, m_BrdfLUTMap);
+        GLState::BindTexture(GL_TEXTURE_2D, m_BrdfLUTMap);
         glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, 512, 512, 0, GL_RGBA, GL_FLOAT, 0);
         // be sure to set wrapping mode to GL_CLAMP_TO_EDGE
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
@@ -333,12 +322,12 @@ namespace Mc
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
         // then re-configure capture framebuffer object and render screen-space quad with BRDF shader.
-        glBindFramebuffer(GL_FRAMEBUFFER, m_CaptureFBO);
+        GLState::BindFramebuffer(m_CaptureFBO);
         glBindRenderbuffer(GL_RENDERBUFFER, m_CaptureRBO);
         glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, 512, 512);
         glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_BrdfLUTMap, 0);
 
-        glViewport(0, 0, 512, 512);
+        GLState::SetViewport(0, 0, 512, 512);
         m_BrdfShader->Bind();
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
@@ -346,8 +335,8 @@ namespace Mc
         glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
 
         // --- 状态恢复 ---
-        glBindFramebuffer(GL_FRAMEBUFFER, currentFBO);
-        glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+        GLState::BindFramebuffer(currentFBO);
+        GLState::SetViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
         // --- 状态恢复结束 ---
     }
 
@@ -0,0 +1,63 @@
+#include "HeadlessContext.h"
+
+#include "src/Renderer/Renderer.h"
+#include "src/Renderer/Renderer3D.h"
+
+#include "src/Renderer/Manager/TextureManager.h"
+#include "src/Renderer/Manager/MaterialManager.h"
+#include "src/Renderer/Manager/ModelManager.h"
+#include "src/Renderer/Manager/MeshManager.h"
+#include "src/Renderer/Manager/HdrManager.h"
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+namespace Mc
+{
+	HeadlessContext::HeadlessContext(uint32_t width, uint32_t height)
+		: m_Width(width), m_Height(height)
+	{
+		if (!glfwInit())
+		{
+			LOG_CORE_ERROR("HeadlessContext: glfwInit failed");
+			return;
+		}
+
+		// 与 Window 使用相同的上下文参数，只是不显示
+		glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+		m_Window = glfwCreateWindow((int)width, (int)height, "Headless", nullptr, nullptr);
+		if (!m_Window)
+		{
+			LOG_CORE_ERROR("HeadlessContext: failed to create a hidden window");
+			glfwTerminate();
+			return;
+		}
+
+		m_Context = GraphicsContext::Create(m_Window);
+		m_Context->Init();
+		glfwSwapInterval(0);
+
+		Renderer::Init();
+		Renderer3D::Init();
+		Renderer::SetViewport(0, 0, width, height);
+	}
+
+	HeadlessContext::~HeadlessContext()
+	{
+		if (!m_Window)
+			return;
+
+		Renderer::Shutdown();
+		Renderer3D::Shutdown();
+
+		TextureManager::Get().Shutdown();
+		MaterialManager::Get().Shutdown();
+		ModelManager::Get().Shutdown();
+		MeshManager::Get().Shutdown();
+		HdrManager::Get().UnloadAll();
+
+		m_Context.reset();
+		glfwDestroyWindow(m_Window);
+		glfwTerminate();
+	}
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "src/Core/Base.h"
+#include "src/Renderer/GraphicsContext.h"
+
+struct GLFWwindow;
+
+namespace Mc
+{
+	// 不显示窗口的 GL 上下文，供测试和基准程序使用，构造后 Renderer3D 与各 Manager 可以直接使用
+	// 无显示器的节点上用 xvfb-run 运行，LIBGL_ALWAYS_SOFTWARE=1 强制使用 llvmpipe
+	// 析构时按 Application 的顺序关闭渲染器并释放所有 Manager 的资源，Scene 需在此之前销毁
+	class HeadlessContext
+	{
+	public:
+		HeadlessContext(uint32_t width, uint32_t height);
+		~HeadlessContext();
+
+		HeadlessContext(const HeadlessContext &) = delete;
+		HeadlessContext &operator=(const HeadlessContext &) = delete;
+
+		// 创建窗口或上下文失败时为 false (例如没有 DISPLAY)
+		bool IsValid() const { return m_Window != nullptr; }
+
+		uint32_t GetWidth() const { return m_Width; }
+		uint32_t GetHeight() const { return m_Height; }
+
+	private:
+		GLFWwindow *m_Window = nullptr;
+		Scope<GraphicsContext> m_Context;
+		uint32_t m_Width = 0, m_Height = 0;
+	};
+}
@@ -1,5 +1,9 @@
 #include "MeshManager.h"
 
+#include <glad/glad.h>
+#include <algorithm>
+#include <utility>
+
 namespace Mc
 {
     uint32_t MeshManager::AddMesh(Ref<Mesh> mesh)
@@ -12,6 +16,29 @@ namespace Mc
         m_Meshes[meshID] = mesh;
         mesh->SetID(meshID);
 
+        // 写入共享缓冲区
+        const auto &vertices = mesh->GetVertices();
+        const auto &indices = mesh->GetIndices();
+
+        Reserve((uint32_t)vertices.size(), (uint32_t)indices.size());
+
+        m_VertexBuffer->SetData(vertices.data(), (uint32_t)(vertices.size() * sizeof(ModelVertex)), m_VertexCount * sizeof(ModelVertex));
+        m_IndexBuffer->SetData(indices.data(), (uint32_t)indices.size(), m_IndexCount);
+
+        mesh->SetGeometryRange((int32_t)m_VertexCount, m_IndexCount);
+
+        bool skinned = std::any_of(vertices.begin(), vertices.end(), [](const ModelVertex &vertex) {
+            return vertex.BoneIDs[0] >= 0 && vertex.Weights[0] > 0.0f;
+        });
+        if (skinned)
+            m_BindPoses[meshID] = vertices;
+
+        // vertices / indices 引用网格自己的数据，释放之前先推进写入位置
+        m_VertexCount += (uint32_t)vertices.size();
+        m_IndexCount += (uint32_t)indices.size();
+
+        mesh->ReleaseGeometry();
+
         return meshID;
     }
     
@@ -25,9 +52,87 @@ namespace Mc
         return nullptr;
     }
 
+    bool MeshManager::TakeBindPoseVertices(uint32_t id, std::vector<ModelVertex> &vertices)
+    {
+        auto it = m_BindPoses.find(id);
+        if (it == m_BindPoses.end())
+            return false;
+
+        vertices = std::move(it->second);
+        m_BindPoses.erase(it);
+        return true;
+    }
+
+    Ref<VertexArray> MeshManager::GetVertexArray()
+    {
+        if (!m_VertexArray)
+            Reserve(0, 0);
+
+        return m_VertexArray;
+    }
+
+    Ref<VertexBuffer> MeshManager::GetVertexBuffer()
+    {
+        if (!m_VertexBuffer)
+            Reserve(0, 0);
+
+        return m_VertexBuffer;
+    }
+
+    void MeshManager::Reserve(uint32_t vertexCount, uint32_t indexCount)
+    {
+        if (m_VertexArray && m_VertexCount + vertexCount <= m_VertexCapacity && m_IndexCount + indexCount <= m_IndexCapacity)
+            return;
+
+        uint32_t vertexCapacity = std::max(m_VertexCapacity, InitialVertexCapacity);
+        while (vertexCapacity < m_VertexCount + vertexCount)
+            vertexCapacity *= 2;
+
+        uint32_t indexCapacity = std::max(m_IndexCapacity, InitialIndexCapacity);
+        while (indexCapacity < m_IndexCount + indexCount)
+            indexCapacity *= 2;
+
+        Ref<VertexBuffer> vertexBuffer = VertexBuffer::Create(vertexCapacity * sizeof(ModelVertex));
+        vertexBuffer->SetLayout({
+            {ShaderDataType::Float3, "a_Position"},
+            {ShaderDataType::Float3, "a_Normal"},
+            {ShaderDataType::Float2, "a_TexCoords"},
+            {ShaderDataType::Float3, "a_Tangent"},
+            {ShaderDataType::Float3, "a_Bitangent"},
+            {ShaderDataType::Int4,   "a_BoneIDs"},
+            {ShaderDataType::Float4, "a_Weights"}
+        });
+
+        Ref<IndexBuffer> indexBuffer = IndexBuffer::Create(indexCapacity);
+
+        // 把已有的几何数据拷贝到新的缓冲区，网格的 BaseVertex / FirstIndex 保持不变
+        if (m_VertexBuffer && m_VertexCount > 0)
+            glCopyNamedBufferSubData(m_VertexBuffer->GetRendererID(), vertexBuffer->GetRendererID(), 0, 0, m_VertexCount * sizeof(ModelVertex));
+        if (m_IndexBuffer && m_IndexCount > 0)
+            glCopyNamedBufferSubData(m_IndexBuffer->GetRendererID(), indexBuffer->GetRendererID(), 0, 0, m_IndexCount * sizeof(uint32_t));
+
+        m_VertexArray = VertexArray::Create();
+        m_VertexArray->Bind();
+        m_VertexArray->AddVertexBuffer(vertexBuffer);
+        m_VertexArray->SetIndexBuffer(indexBuffer);
+        m_VertexArray->UnBind();
+
+        m_VertexBuffer = vertexBuffer;
+        m_IndexBuffer = indexBuffer;
+        m_VertexCapacity = vertexCapacity;
+        m_IndexCapacity = indexCapacity;
+    }
+
     void MeshManager::Shutdown()
     {
         m_Meshes.clear();
+        m_BindPoses.clear();
         m_NextMeshID = 1;
+
+        m_VertexArray.reset();
+        m_VertexBuffer.reset();
+        m_IndexBuffer.reset();
+        m_VertexCount = m_VertexCapacity = 0;
+        m_IndexCount = m_IndexCapacity = 0;
     }
-}
\ No newline at end of file
+}
@@ -16,18 +16,46 @@ namespace Mc
         MeshManager(const MeshManager &) = delete;
         MeshManager &operator=(const MeshManager &) = delete;
 
-        // 为一个网格分配ID并将其添加到管理器
+        // 为一个网格分配ID，并将其几何数据写入共享缓冲区
         uint32_t AddMesh(Ref<Mesh> mesh);
 
         // 通过ID获取网格
         Ref<Mesh> GetMeshByID(uint32_t id);
 
+        // 所有模型网格共用的 VAO (顶点/索引缓冲区)
+        Ref<VertexArray> GetVertexArray();
+        // 共享顶点缓冲区，GPU 蒙皮时作为 SSBO 读取 (布局为 ModelVertex)
+        Ref<VertexBuffer> GetVertexBuffer();
+
+        // 带骨骼权重的网格上传时保留一份绑定姿势，随时切换到 CPU 蒙皮都能使用
+        // CpuSkinner 第一次使用网格时取走这份数据，之后只保存在 CpuSkinner 中
+        // 静态网格或已被取走时返回 false
+        bool TakeBindPoseVertices(uint32_t id, std::vector<ModelVertex> &vertices);
+
         void Shutdown();
 
     private:
         MeshManager() = default;
 
+        // 保证共享缓冲区能再容纳指定数量的顶点和索引，不足时按两倍扩容
+        void Reserve(uint32_t vertexCount, uint32_t indexCount);
+
         std::unordered_map<uint32_t, Ref<Mesh>> m_Meshes;
         uint32_t m_NextMeshID = 1;
+
+        std::unordered_map<uint32_t, std::vector<ModelVertex>> m_BindPoses;
+
+        // Geometry Arena
+        static constexpr uint32_t InitialVertexCapacity = 256 * 1024;
+        static constexpr uint32_t InitialIndexCapacity = 1024 * 1024;
+
+        Ref<VertexArray> m_VertexArray;
+        Ref<VertexBuffer> m_VertexBuffer;
+        Ref<IndexBuffer> m_IndexBuffer;
+
+        uint32_t m_VertexCount = 0;
+        uint32_t m_VertexCapacity = 0;
+        uint32_t m_IndexCount = 0;
+        uint32_t m_IndexCapacity = 0;
     };
-}
\ No newline at end of file
+}
@@ -1,6 +1,7 @@
 #include "Mesh.h"
 
 #include "src/Renderer/Manager/MaterialManager.h"
+#include "src/Renderer/Manager/MeshManager.h"
 
 namespace Mc
 {
@@ -8,40 +9,34 @@ namespace Mc
     {
         m_Name = name;
 
-        m_VertexArray = VertexArray::Create();
-        m_VertexArray->Bind();
+        m_VertexCount = (uint32_t)vertices.size();
+        m_IndexCount = (uint32_t)indices.size();
 
-        m_VertexBuffer = VertexBuffer::Create(vertices.data(), (uint32_t)(vertices.size() * sizeof(ModelVertex)));
-
-        m_VertexBuffer->SetLayout({
-            {ShaderDataType::Float3, "a_Position"},
-            {ShaderDataType::Float3, "a_Normal"},
-            {ShaderDataType::Float2, "a_TexCoords"},
-            {ShaderDataType::Float3, "a_Tangent"},
-            {ShaderDataType::Float3, "a_Bitangent"},
-            {ShaderDataType::Int4,   "a_BoneIDs"},
-            {ShaderDataType::Float4, "a_Weights"}
-        });
-        m_VertexArray->AddVertexBuffer(m_VertexBuffer);
-
-        m_IndexBuffer = IndexBuffer::Create(indices.data(), (uint32_t)indices.size());
-        m_VertexArray->SetIndexBuffer(m_IndexBuffer);
-
-        m_VertexArray->UnBind(); // 解绑 VAO
+        // 等待 MeshManager::AddMesh 写入共享缓冲区
+        m_Vertices = std::move(vertices);
+        m_Indices = std::move(indices);
     }
 
     void Mesh::Draw(Ref<Shader> &shader)
     {
-        m_VertexArray->Bind();
-        glDrawElements(GL_TRIANGLES, m_IndexBuffer->GetCount(), GL_UNSIGNED_INT, nullptr);
-        m_VertexArray->UnBind();
+        MeshManager::Get().GetVertexArray()->Bind();
+        glDrawElementsBaseVertex(GL_TRIANGLES, m_IndexCount, GL_UNSIGNED_INT, (const void *)(uintptr_t)(m_FirstIndex * sizeof(uint32_t)), m_BaseVertex);
+        MeshManager::Get().GetVertexArray()->UnBind();
     }
 
     void Mesh::DrawInstanced(Ref<Shader> &shader, uint32_t instanceCount)
     {       
-        m_VertexArray->Bind();
-        glDrawElementsInstanced(GL_TRIANGLES, m_IndexBuffer->GetCount(), GL_UNSIGNED_INT, nullptr, instanceCount);
-        m_VertexArray->UnBind();
+        MeshManager::Get().GetVertexArray()->Bind();
+        glDrawElementsInstancedBaseVertex(GL_TRIANGLES, m_IndexCount, GL_UNSIGNED_INT, (const void *)(uintptr_t)(m_FirstIndex * sizeof(uint32_t)), instanceCount, m_BaseVertex);
+        MeshManager::Get().GetVertexArray()->UnBind();
+    }
+
+    void Mesh::ReleaseGeometry()
+    {
+        m_Vertices.clear();
+        m_Vertices.shrink_to_fit();
+        m_Indices.clear();
+        m_Indices.shrink_to_fit();
     }
 
     Ref<Mesh> Mesh::Create(std::string name, std::vector<ModelVertex> vertices, std::vector<uint32_t> indices)
@@ -22,6 +22,8 @@ namespace Mc
         glm::vec4 Weights = glm::vec4(0.0f);
     };
 
+    // 网格的几何数据由 MeshManager 统一放入共享的顶点/索引缓冲区
+    // Mesh 只记录自己在其中的位置
     class Mesh
     {
     public:
@@ -32,13 +34,29 @@ namespace Mc
         void Draw(Ref<Shader> &shader);
         void DrawInstanced(Ref<Shader> &shader, uint32_t instanceCount);
 
-        Ref<VertexArray> GetVertexArray() { return m_VertexArray; }
-        Ref<IndexBuffer> GetIndexBuffer() { return m_IndexBuffer; }
         std::string GetName() { return m_Name; }
 
         void SetID(uint32_t id) { m_ID = id; }
         uint32_t GetID() const { return m_ID; }
 
+        // 共享缓冲区中的位置
+        void SetGeometryRange(int32_t baseVertex, uint32_t firstIndex) { m_BaseVertex = baseVertex; m_FirstIndex = firstIndex; }
+        int32_t GetBaseVertex() const { return m_BaseVertex; }
+        uint32_t GetFirstIndex() const { return m_FirstIndex; }
+        uint32_t GetIndexCount() const { return m_IndexCount; }
+        uint32_t GetVertexCount() const { return m_VertexCount; }
+
+        // 局部空间包围体，由 Model::ProcessMesh 计算，用于视锥剔除
+        void SetBounds(const glm::vec3 &min, const glm::vec3 &max, const glm::vec4 &boundingSphere) { m_AABBMin = min; m_AABBMax = max; m_BoundingSphere = boundingSphere; }
+        const glm::vec3 &GetAABBMin() const { return m_AABBMin; }
+        const glm::vec3 &GetAABBMax() const { return m_AABBMax; }
+        const glm::vec4 &GetBoundingSphere() const { return m_BoundingSphere; } // xyz 球心, w 半径
+
+        // 上传到共享缓冲区之前的 CPU 数据，上传后释放
+        const std::vector<ModelVertex> &GetVertices() const { return m_Vertices; }
+        const std::vector<uint32_t> &GetIndices() const { return m_Indices; }
+        void ReleaseGeometry();
+
         static Ref<Mesh> Create(std::string name, std::vector<ModelVertex> vertices, std::vector<uint32_t> indicescount);
 
     private:
@@ -46,11 +64,17 @@ namespace Mc
         std::string m_Name;
         // mesh Data
         std::vector<ModelVertex> m_Vertices;
-        uint32_t* m_Indices;
+        std::vector<uint32_t> m_Indices;
+
+        uint32_t m_VertexCount = 0;
+        uint32_t m_IndexCount = 0;
+
+        glm::vec3 m_AABBMin = glm::vec3(0.0f);
+        glm::vec3 m_AABBMax = glm::vec3(0.0f);
+        glm::vec4 m_BoundingSphere = glm::vec4(0.0f);
 
         // render data
-        Ref<VertexArray> m_VertexArray;
-        Ref<VertexBuffer> m_VertexBuffer;
-        Ref<IndexBuffer> m_IndexBuffer;
+        int32_t m_BaseVertex = 0;
+        uint32_t m_FirstIndex = 0;
     };
 }
\ No newline at end of file
@@ -8,6 +8,8 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
+#include <limits>
+
 namespace Mc
 {
     // --- 数据结构定义 ---
@@ -93,12 +95,18 @@ namespace Mc
 
         std::string name = mesh->mName.C_Str();
 
+        // 局部空间 AABB
+        glm::vec3 aabbMin = glm::vec3(std::numeric_limits<float>::max());
+        glm::vec3 aabbMax = glm::vec3(std::numeric_limits<float>::lowest());
+
         for (unsigned int i = 0; i < mesh->mNumVertices; ++i)
         {
             ModelVertex node;
             // position
             aiVector3D pos = mesh->mVertices[i];
             node.Position = glm::vec3(pos.x, pos.y, pos.z);
+            aabbMin = glm::min(aabbMin, node.Position);
+            aabbMax = glm::max(aabbMax, node.Position);
             // normal
             if (mesh->HasNormals())
             {
@@ -172,7 +180,25 @@ namespace Mc
                 indices.push_back(face.mIndices[j]);
         }
 
-        return Mesh::Create(name, vertices, indices);
+        // 包围球: 以 AABB 中心为球心，取最远顶点的距离为半径
+        glm::vec4 boundingSphere = glm::vec4(0.0f);
+        if (!vertices.empty())
+        {
+            glm::vec3 center = (aabbMin + aabbMax) * 0.5f;
+            float radius = 0.0f;
+            for (const auto &vertex : vertices)
+                radius = glm::max(radius, glm::length(vertex.Position - center));
+
+            boundingSphere = glm::vec4(center, radius);
+        }
+        else
+        {
+            aabbMin = aabbMax = glm::vec3(0.0f);
+        }
+
+        Ref<Mesh> result = Mesh::Create(name, vertices, indices);
+        result->SetBounds(aabbMin, aabbMax, boundingSphere);
+        return result;
     }
 
     void Model::AddBoneDataToVertex(ModelVertex &vertex, int boneID, float weight)
@@ -1,4 +1,5 @@
 #include "Renderer.h"
+#include "GLState.h"
 
 #include <glad/glad.h>
 
@@ -6,11 +7,11 @@ namespace Mc
 {
 	void Renderer::Init()
 	{
-		glEnable(GL_BLEND);
-		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+		GLState::Enable(GL_BLEND);
+		GLState::SetBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-		glEnable(GL_DEPTH_TEST);
-		glEnable(GL_LINE_SMOOTH);
+		GLState::Enable(GL_DEPTH_TEST);
+		GLState::Enable(GL_LINE_SMOOTH);
 
 		
 	}
@@ -22,7 +23,7 @@ namespace Mc
 
     void Renderer::SetViewport(uint32_t x, uint32_t y, uint32_t width, uint32_t height)
 	{
-		glViewport(x, y, width, height);
+		GLState::SetViewport(x, y, width, height);
 	}
 
 	void Renderer::SetClearColor(const glm::vec4& color)
@@ -7,16 +7,30 @@
 #include "src/Renderer/Sphere.h"
 
 #include "src/Renderer/UniformBuffer.h"
+#include "src/Renderer/Framebuffer.h"
+#include "src/Renderer/FrameGraph.h"
+#include "src/Renderer/GLState.h"
 #include "src/Renderer/HDRSkybox.h"
 #include "src/Renderer/Manager/TextureManager.h"
 #include "src/Renderer/Manager/MeshManager.h"
 #include "src/Renderer/Manager/HdrManager.h"
 
 #include "src/Renderer/Shadow.h"
+#include "src/Renderer/BindlessTexture.h"
+#include "src/Renderer/DrawSortKey.h"
+#include "src/Renderer/CpuSkinner.h"
+#include "src/Core/Timer.h"
+#include "src/Math/FrustumCuller.h"
+#include "src/Math/LightClusterGrid.h"
+#include "src/Math/RadixSort.h"
 #include <entt/entt.hpp>
 
 #include <glad/glad.h>
 #include <iostream>
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <string>
 
 #include <glm/gtx/matrix_decompose.hpp>
 
@@ -40,33 +54,14 @@ namespace Mc
 		glm::mat4 Transform;
 		glm::vec4 TintColor;
 
-		// PBR
-		glm::vec4 AlbedoColor;
-		glm::vec4 EmissiveColor;
-		float Roughness;
-		float Metallic;
-		float AO;
-
-		// 纹理贴图 (对应 Material.h 中的 TextureType 枚举)
-		int AlbedoMapIndex;	   // 0
-		int NormalMapIndex;	   // 1
-		int MetallicMapIndex;  // 2
-		int RoughnessMapIndex; // 3
-		int AoMapIndex;		   // 4
-		int EmissiveMapIndex;  // 5
-		int HeightMapIndex;	   // 6
-
 		float TilingFactor;
 		int EntityID;
-
-		int ReceivesPBR;
-		int ReceivesIBL;
-		int ReceivesLight;
-		int ReceivesShadow;
+		int MaterialIndex; // MaterialBuffer 中的下标
+		int padding_0;
 	};
 
 	// 静态断言来验证 SphereInstanceData 的大小，确保符合 std140 布局
-	// 128
+	// 96
 	static_assert(sizeof(SphereInstanceData) % 16 == 0, "SphereInstanceData size mismatch for std140 layout!");
 
 	struct MeshInstanceData
@@ -74,7 +69,18 @@ namespace Mc
 		glm::mat4 Transform;
 		glm::vec4 TintColor;
 
-		// PBR
+		int EntityID;
+		int FlipUV;
+		int MaterialIndex; // MaterialBuffer 中的下标
+		int SkinnedVertexOffset; // 蒙皮后的顶点在 SkinnedVertexBuffer 中的起始位置，静态网格为 -1
+	};
+
+	static_assert(sizeof(MeshInstanceData) % 16 == 0, "MeshInstanceData size mismatch for std140 layout!");
+
+	// 材质表中的一项，内容相同的材质只保存一份，实例通过 MaterialIndex 引用
+	// 贴图下标是全局纹理表的下标，与批次无关
+	struct MaterialData
+	{
 		glm::vec4 AlbedoColor;
 		glm::vec4 EmissiveColor;
 		float Roughness;
@@ -90,18 +96,91 @@ namespace Mc
 		int EmissiveMapIndex;  // 5
 		int HeightMapIndex;	   // 6
 
-		int EntityID;
-		int FlipUV;
-
 		int ReceivesPBR;
 		int ReceivesIBL;
 		int ReceivesLight;
 		int ReceivesShadow;
 
-		glm::mat4 FinalBoneMatrices[MAX_BONES];
+		int padding_0;
+		int padding_1;
+
+		// 按字节比较，填充字段总是为 0
+		bool operator==(const MaterialData &other) const { return memcmp(this, &other, sizeof(MaterialData)) == 0; }
 	};
 
-	static_assert(sizeof(MeshInstanceData) % 16 == 0, "MeshInstanceData size mismatch for std140 layout!");
+	static_assert(sizeof(MaterialData) % 16 == 0, "MaterialData size mismatch for std430 layout!");
+
+	// FNV-1a 的变体，按 8 字节处理，每步再把高位折回低位
+	static const uint64_t HashSeed = 14695981039346656037ull;
+
+	static uint64_t HashBytes(uint64_t hash, const void *data, size_t size)
+	{
+		const uint8_t *bytes = (const uint8_t *)data;
+		size_t i = 0;
+		for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t))
+		{
+			uint64_t word;
+			memcpy(&word, bytes + i, sizeof(uint64_t));
+			hash = (hash ^ word) * 1099511628211ull;
+			hash ^= hash >> 29;
+		}
+		for (; i < size; i++)
+			hash = (hash ^ bytes[i]) * 1099511628211ull;
+		return hash;
+	}
+
+	struct MaterialDataHash
+	{
+		size_t operator()(const MaterialData &data) const
+		{
+			return (size_t)HashBytes(HashSeed, &data, sizeof(MaterialData));
+		}
+	};
+
+	// 投射阴影的实例，所有光源的阴影通道共用
+	struct ShadowInstanceData
+	{
+		glm::mat4 Transform;
+		int SkinnedVertexOffset; // 静态网格为 -1
+		int padding_0;
+		int padding_1;
+		int padding_2;
+	};
+
+	static_assert(sizeof(ShadowInstanceData) % 16 == 0, "ShadowInstanceData size mismatch for std430 layout!");
+
+	// glMultiDrawElementsIndirect 的命令格式
+	struct DrawElementsIndirectCommand
+	{
+		uint32_t Count;
+		uint32_t InstanceCount;
+		uint32_t FirstIndex;
+		int32_t BaseVertex;
+		uint32_t BaseInstance; // 可见实例列表中的起始下标 (gl_BaseInstanceARB)
+	};
+
+	// Renderer3D_Cull.glsl 的输入，每条对应一个工作组
+	struct CullCommandData
+	{
+		glm::vec4 BoundingSphere; // xyz 局部空间球心, w 半径
+		uint32_t FirstInstance;	  // 实例在绑定区域中的起始下标
+		uint32_t InstanceCount;
+		uint32_t CommandIndex;	  // 对应的间接绘制命令
+		uint32_t VisibleBase;	  // 可见实例写入可见列表的起始位置
+	};
+
+	static_assert(sizeof(CullCommandData) % 16 == 0, "CullCommandData size mismatch for std430 layout!");
+
+	// Renderer3D_Skinning.glsl 的输入，每个 (动画实体, 网格) 一项
+	struct SkinningJobData
+	{
+		int32_t BaseVertex;	   // 网格在共享顶点缓冲区中的起始顶点
+		uint32_t VertexCount;
+		uint32_t OutputOffset; // 在 SkinnedVertexBuffer 中的起始位置
+		int32_t PaletteOffset; // 骨骼调色板在 BonePaletteBuffer 中的起始位置
+	};
+
+	static_assert(sizeof(SkinningJobData) == 16, "SkinningJobData size mismatch for std430 layout!");
 
 	static const uint32_t MAXLIGHTS = 8;
 	// Light
@@ -112,13 +191,17 @@ namespace Mc
 		glm::vec3 Color;
 		int CastsShadows;
 
-		glm::mat4 LightSpaceMatrix;
+		glm::mat4 CascadeMatrices[ShadowCascadeCount];
+		glm::vec4 CascadeSplits; // 每级级联覆盖到的观察空间深度
+		glm::vec4 CascadeRects[ShadowCascadeCount]; // 每级级联在阴影图集中的区块 (UV)
 		int ShadowMapIndex;
 		float padding_0;
 		float padding_1;
 		float padding_2;
 	};
 
+	static_assert(sizeof(StoredDirectionalLight) % 16 == 0, "StoredDirectionalLight size mismatch for std430 layout!");
+
 	struct StoredPointLight
 	{
 		glm::vec3 Position;
@@ -146,6 +229,8 @@ namespace Mc
 		int ShadowMapIndex;
 		int CastsShadows;
 		float padding_0;
+
+		glm::vec4 AtlasRect; // 在阴影图集中的区块 (UV)
 	};
 
 	struct LightData
@@ -160,9 +245,11 @@ namespace Mc
 		int NumSpotLights;
 		int padding2;
 
+		// 分簇参数，点光源与聚光灯按簇遍历
+		glm::uvec4 ClusterDimensions; // xyz: 簇网格大小
+		glm::vec4 ClusterDepthParams; // x: scale, y: bias, 深度层 slice = log(viewDepth) * x + y
+
 		StoredDirectionalLight DirectionalLights[MAXLIGHTS];
-		StoredPointLight PointLights[MAXLIGHTS];
-		StoredSpotLight SpotLights[MAXLIGHTS];
 	};
 
 	static_assert(sizeof(LightData) % 16 == 0, "LightData size mismatch for std140 layout!");
@@ -173,10 +260,41 @@ namespace Mc
 		// Texture
 		static const uint32_t MaxTextureSlots = 32;
 		std::array<Ref<Texture2D>, MaxTextureSlots> TextureSlots;
+		std::array<int, MaxTextureSlots> TextureSlotTextureIndices = {}; // 纹理单元 -> 全局纹理下标
 		uint32_t TextureSlotIndex = 1;
 
 		Ref<Texture2D> WhiteTexture;
 
+		// 全局纹理表: 每个纹理有固定的下标 (0 为白色纹理)，材质表中的贴图下标指向这里
+		static const uint32_t InitialTextureCapacity = 1024;
+		std::unordered_map<uint32_t, int> RegisteredTextureIndices; // GL 纹理 ID -> 全局下标
+		std::vector<Ref<Texture2D>> RegisteredTextures;
+
+		// 纹理单元模式下，着色器通过该表把全局下标转换为当前批次的纹理单元，0 表示未绑定 (白色纹理)
+		std::vector<int> TextureSlotMap;
+		bool TextureSlotMapDirty = true;
+		uint32_t TextureSlotMapCapacity = 0;
+		Ref<ShaderStorageBuffer> TextureSlotMapSSBO;
+
+		// Bindless
+		// 支持 GL_ARB_bindless_texture 时，全局下标直接索引句柄表，不受纹理单元数量限制，也不会触发 NextBatch
+		bool UseBindlessTextures = false;
+		std::vector<uint64_t> BindlessTextureHandles; // 与 RegisteredTextures 一一对应
+		bool BindlessTexturesDirty = false;
+		uint32_t BindlessTextureCapacity = 0;
+		Ref<ShaderStorageBuffer> BindlessTextureSSBO;
+
+		// Material
+		// -------------------------------------------------------------------------------
+		static const uint32_t InitialMaterialCapacity = 256;
+		static const uint32_t MaxMaterials = 4096; // 超过后在下一批次开始时重建材质表
+
+		std::unordered_map<MaterialData, int, MaterialDataHash> MaterialIndices;
+		std::vector<MaterialData> Materials;
+		bool MaterialsDirty = false;
+		uint32_t MaterialCapacity = 0;
+		Ref<ShaderStorageBuffer> MaterialSSBO;
+
 		// hdr
 		// -------------------------------------------------------------------------------
 		Ref<HDRSkybox> HdrSkybox;
@@ -184,29 +302,170 @@ namespace Mc
 		// -------------------------------------------------------------------------------
 		// Sphere
 		// -------------------------------------------------------------------------------
-		static const uint32_t MaxSphereCount = 20000;
+		// 球体实例写满时在帧中途翻倍并保留已写入的实例，不触发 Flush
+		static const uint32_t InitialSphereCapacity = 20000;
+		uint32_t SphereCapacity = InitialSphereCapacity;
 		uint32_t SphereCount = 0;
 
 		Ref<Sphere> DefaultSphereMesh;
 		Ref<Shader> SphereShader;
 
 		// ==== SSBO ====
-		Ref<ShaderStorageBuffer> SphereInstanceSSBO;
-		std::vector<SphereInstanceData> SphereInstances;
+		Ref<ShaderStorageRingBuffer> SphereInstanceRing;
+		SphereInstanceData *SphereInstances = nullptr; // 指向环形缓冲区当前区域的映射内存
+		uint32_t SphereInstanceOffset = 0;
 
 		// Model
 		// -------------------------------------------------------------------------------
 		uint32_t ModelCount = 0;
-		static const uint32_t MaxUniqueModels = 32;		   // 最多支持多少种不同的模型文件
-		static const uint32_t MaxInstancesPerModel = 2000; // 每种模型最多支持多少个实例
+		static const uint32_t MaxUniqueModels = 32;				   // 最多支持多少种不同的模型文件
+		static const uint32_t ModelInstancesPerChunk = 64;		   // 批次第一次申请的实例数
+		static constexpr uint32_t MaxModelInstancesPerChunk = 4096;	   // 单块实例数的上限
+		static const uint32_t MaxModelInstanceRingSize = 128 * 1024 * 1024; // GL_MAX_SHADER_STORAGE_BLOCK_SIZE 的最小保证值，球体实例同样受此限制
+		// 每块至少 ModelInstancesPerChunk 个实例，块数不会超过该值 (另加一条球体命令)
+		static constexpr uint32_t MaxDrawCommands = MaxModelInstanceRingSize / (ModelInstancesPerChunk * sizeof(MeshInstanceData)) + 1;
+		static const uint32_t ModelBatchTrimFrames = 120;		   // 批次连续多少帧未使用后被回收
+
+		uint32_t ModelInstanceRingSize = 32 * 1024 * 1024; // 每帧可用的模型实例内存，不足时在帧中途翻倍
+
+		// 一个批次的实例分布在若干块连续的映射内存中，每块单独绘制
+		struct ModelInstanceChunk
+		{
+			MeshInstanceData *Instances = nullptr;
+			uint32_t Offset = 0;
+			uint32_t Count = 0;
+			uint32_t Capacity = 0;
+			uint32_t FirstInstance = 0; // 第一个实例在批次中的序号 (CullInstances 的下标)
+
+			// 排序使用，提交时累积
+			float NearestDepth = std::numeric_limits<float>::max();
+			bool Skinned = false;
+		};
+
+		// CPU 剔除使用的实例副本，提交时记录，映射内存是只写的，不从中读回
+		struct ModelCullInstance
+		{
+			glm::mat4 Transform;
+			bool Skinned;
+		};
 
+		// 批次在帧之间保留，只重置计数
 		struct ModelCallBatch
 		{
-			std::vector<MeshInstanceData> Instances; // MeshInstanceData 包含 Transform, TintColor 等
-			Ref<ShaderStorageBuffer> InstanceSSBO;	 // 为该批次准备的 SSBO
+			std::vector<ModelInstanceChunk> Chunks;
+			std::vector<ModelCullInstance> CullInstances; // 只在 CPU 剔除时记录
 			uint32_t InstanceCount = 0;
+
+			uint32_t ChunkCapacity = ModelInstancesPerChunk; // 按几何级数增长，下一帧直接申请足够大的块
+			uint64_t LastUsedFrame = 0;
+		};
+
+		Ref<ShaderStorageRingBuffer> ModelInstanceRing;
+		Ref<ShaderStorageRingBuffer> DrawCommandRing;
+		uint64_t FrameIndex = 0;
+
+		// Culling
+		// -------------------------------------------------------------------------------
+		static constexpr uint32_t SphereInstancesPerCullGroup = 256; // 球体按组拆分为多条剔除命令
+		static inline const glm::vec4 SphereBoundingSphere = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f); // 默认球体为单位球
+
+		Renderer3D::CullingMode CullingMode = Renderer3D::CullingMode::GPU;
+		Renderer3D::CullingMode BatchCullingMode = Renderer3D::CullingMode::GPU; // StartBatch 时锁定，提交与 Flush 使用同一种模式
+		Ref<Shader> CullShader;
+		std::vector<glm::mat4> SphereTransforms; // 非 GPU 剔除时球体变换的副本，用于剔除与深度排序
+
+		// Draw Sorting
+		// -------------------------------------------------------------------------------
+		bool UseDrawSorting = true;
+		Math::RadixSorter DrawSorter; // 球体与模型先后使用
+
+		// 排序键的值指向这里
+		struct ModelDrawItem
+		{
+			const ModelCallBatch *Batch = nullptr;
+			const ModelInstanceChunk *Chunk = nullptr;
+			Ref<Mesh> ChunkMesh;
+		};
+		std::vector<ModelDrawItem> ModelDrawItems;
+
+		// Depth Pre-Pass
+		// 开启后先只写深度，主通道以 GL_EQUAL 测试且不写深度，被遮挡的片元不再运行 PBR 着色
+		bool UseDepthPrepass = false;
+		Ref<Shader> DepthPrepassShader;
+
+		// 每次 Flush 一组查询，结果在 ForwardQueryFrames 帧后读取，避免等待 GPU
+		struct ForwardPassQuery
+		{
+			uint32_t PrepassTimer = 0;
+			uint32_t MainTimer = 0;
+			uint32_t SamplesPassed = 0; // 主通道通过深度测试 (即运行了片元着色) 的采样数
+			uint32_t Pixels = 0;		// 视口像素数
+			bool Prepass = false;
+		};
+		static const uint32_t ForwardQueryFrames = 3;
+		std::vector<ForwardPassQuery> ForwardQueries[ForwardQueryFrames];
+		uint32_t ForwardQueryCount[ForwardQueryFrames] = {};
+		// Deferred
+		// G-buffer: 0 反射率, 1 着色/几何法线, 2 粗糙度/金属度/AO/标志, 3 自发光, 4 实体 ID, 深度
+		Renderer3D::RenderPath RenderPath = Renderer3D::RenderPath::Forward;
+		Ref<Framebuffer> GBuffer;
+		Ref<Shader> SphereGBufferShader;
+		Ref<Shader> ModelGBufferShader;
+		Ref<Shader> DeferredLightingShader; // Renderer3D_Model 的 DEFERRED_LIGHTING 变体，与前向路径共用光照代码
+		Ref<VertexArray> FullscreenVertexArray; // 全屏三角形由 gl_VertexID 生成，不需要顶点缓冲
+		static const uint32_t GBufferColorAttachments = 5;
+		uint32_t GBufferTextureStart = 0;
+
+		// G-buffer 通道之前的绘制目标，光照通道写回这里
+		struct DeferredTarget
+		{
+			uint32_t Framebuffer = 0;
+			int32_t Viewport[4] = {};
+			bool Blend = false;
 		};
 
+		// 最近一次读到的结果
+		float DepthPrepassTime = 0.0f;
+		float ForwardPassTime = 0.0f;
+		float Overdraw = 0.0f;
+
+		Ref<ShaderStorageRingBuffer> CullCommandRing;
+		Ref<ShaderStorageRingBuffer> VisibleInstanceRing; // 剔除后可见实例的下标
+		Math::Frustum Frustum;
+
+		// Bone Palette
+		// -------------------------------------------------------------------------------
+		static const uint32_t MaxBonePalettes = 256; // 每帧最多支持多少个带动画的实体
+
+		// 每个动画实体每帧只写入一次调色板，所有子网格和阴影共用
+		Ref<ShaderStorageRingBuffer> BonePaletteRing;
+		std::unordered_map<int, int> BonePaletteOffsets; // entityID -> PaletteOffset
+
+		// GPU Skinning
+		// 每个 (动画实体, 网格) 每帧由计算着色器蒙皮一次，主通道、深度预通道和所有阴影通道读取结果
+		static const uint32_t MaxSkinningJobsPerDispatch = 65535; // glDispatchCompute 的 y 维上限
+		Ref<Shader> SkinningShader;
+		std::vector<SkinningJobData> SkinningJobs;
+		std::unordered_map<uint64_t, int> SkinnedVertexOffsets; // (entityID, MeshID) -> 输出的起始顶点
+		uint32_t SkinnedVertexCount = 0;	  // 本帧所有作业的输出顶点数
+		uint32_t SkinningJobsDispatched = 0; // 已调度的作业，NextBatch 之后只调度新增的部分
+
+		Ref<ShaderStorageBuffer> SkinnedVertexSSBO; // binding 19，只由 GPU 写入
+		uint32_t SkinnedVertexCapacity = 0;
+		Ref<ShaderStorageBuffer> SkinningJobSSBO; // binding 21
+		uint32_t SkinningJobCapacity = 0;
+
+		// CPU Skinning
+		// 结果写入持久映射的环形缓冲区，同样绑定到 19，着色器不区分两种模式
+		Renderer3D::SkinningMode SkinningMode = Renderer3D::SkinningMode::GPU;
+		Renderer3D::SkinningMode FrameSkinningMode = Renderer3D::SkinningMode::GPU; // BeginScene 时锁定
+		uint32_t CpuSkinningThreads = 0;
+		Scope<CpuSkinner> Skinner;								// 第一次使用 CPU 模式时创建
+		Ref<ShaderStorageRingBuffer> SkinnedVertexRing;
+		std::vector<uint32_t> SkinningJobMeshIDs;				// 与 SkinningJobs 一一对应
+		std::vector<glm::mat4> BonePaletteCopies;				// 调色板的 CPU 副本 (映射内存只写)，按 PaletteOffset 索引
+		std::vector<CpuSkinner::Job> CpuSkinningJobs;
+
 		struct ModelCallKey
 		{
 			uint32_t MeshID;
@@ -234,12 +493,25 @@ namespace Mc
 		// Light
 		// -------------------------------------------------------------------------------
 		static const uint32_t MAX_DIRECTIONAL_LIGHTS = MAXLIGHTS; // 着色器中定义的数组大小
-		static const uint32_t MAX_POINT_LIGHTS = MAXLIGHTS;
-		static const uint32_t MAX_SPOT_LIGHTS = MAXLIGHTS;
+		// 点光源与聚光灯位于各自的 SSBO 中，数量不受着色器数组限制，只有投射阴影的数量受限
+		static const uint32_t MAX_POINT_SHADOWS = MAXLIGHTS; // u_PointShadowDepthMaps 的大小
+		static const uint32_t MAX_SPOT_SHADOWS = MAXLIGHTS;
 
 		// ssbo
 		Ref<ShaderStorageBuffer> LightInstanceSSBO;
 
+		// 分簇光照 (binding 15 点光源, 16 聚光灯, 17 簇, 18 簇光源下标)，不足时翻倍
+		static const uint32_t InitialLightCapacity = 256;
+		uint32_t PointLightCapacity = 0;
+		uint32_t SpotLightCapacity = 0;
+		uint32_t ClusterCapacity = 0;
+		uint32_t ClusterIndexCapacity = 0;
+		Ref<ShaderStorageBuffer> PointLightSSBO;
+		Ref<ShaderStorageBuffer> SpotLightSSBO;
+		Ref<ShaderStorageBuffer> ClusterSSBO;
+		Ref<ShaderStorageBuffer> ClusterIndexSSBO;
+		Math::LightClusterGrid LightClusters;
+
 		// 用于收集数据的C++容器
 		std::vector<StoredDirectionalLight> DirectionalLights;
 		std::vector<StoredPointLight> PointLights;
@@ -247,14 +519,82 @@ namespace Mc
 
 		// shadow
 		// -------------------------------------------------------------------------------
-		struct ProjectionShadowData
+		// 投射阴影的物体按网格分组，每个网格每个光源一次实例化绘制
+		struct ShadowCasterBatch
 		{
-			glm::mat4 Transform;
 			uint32_t VertexArrayID = 0;
 			uint32_t IndexCount = 0;
-			glm::mat4 FinalBoneMatrices[MAX_BONES];
+
+			// 模型网格位于 MeshManager 的共享缓冲区中
+			uint32_t FirstIndex = 0;
+			int32_t BaseVertex = 0;
+			uint32_t Mode = GL_TRIANGLES;
+
+			std::vector<ShadowInstanceData> Instances;
+			std::vector<glm::vec4> Bounds; // 世界空间包围球，与 Instances 一一对应，用于按光源剔除
+			uint32_t BaseInstance = 0;	   // 在 ShadowInstanceRing 当前区域中的起始下标
 		};
-		std::vector<ProjectionShadowData> ProjectionShadowDatas;
+		// (VAO << 32 | FirstIndex) -> 批次，空批次在帧末回收
+		std::unordered_map<uint64_t, ShadowCasterBatch> ShadowCasterBatches;
+
+		uint32_t ShadowInstanceCapacity = 4096; // 每帧可用的阴影实例数，不足时翻倍
+		Ref<ShaderStorageRingBuffer> ShadowInstanceRing;
+		uint32_t ShadowInstanceOffset = 0;
+		uint32_t ShadowInstanceCount = 0;
+
+		// 每个光源剔除后的可见实例列表，低位为实例下标，高 6 位为点光源的立方体面掩码
+		static const uint32_t ShadowFaceMaskShift = 26;
+		static const uint32_t ShadowInstanceIndexMask = (1u << ShadowFaceMaskShift) - 1;
+		static const uint32_t MaxShadowLights = MAXLIGHTS * 3;
+		Ref<ShaderStorageRingBuffer> ShadowVisibleRing;
+
+		// 所有投射物的世界空间包围球，按实例下标排列
+		Math::FrustumCuller ShadowCasterCuller;
+		std::vector<glm::vec4> ShadowCasterBounds;
+		std::vector<uint8_t> ShadowCascadeMasks; // 方向光每个投射物相交的级联
+
+		// 当前光源每个网格的可见实例范围 (ShadowVisibleRing 中的位置)
+		struct ShadowDrawRange
+		{
+			const ShadowCasterBatch *Batch;
+			uint32_t BaseInstance;
+			uint32_t Count;
+		};
+		std::vector<ShadowDrawRange> ShadowDrawRanges;
+
+		// 阴影更新调度
+		// 内容变化的阴影贴图先排队，按优先级在预算内渲染，其余推迟到之后的帧
+		enum class ShadowType
+		{
+			Point = 0, Directional, Spot, Count
+		};
+
+		struct ShadowUpdateJob
+		{
+			ShadowType Type;
+			uint32_t Index; // 在 PointShadows / DirectionalShadows / SpotShadows 中的下标
+			ShadowMapState *State;
+			uint64_t ContentHash;
+			float Priority;
+			std::vector<ShadowDrawRange> Ranges;
+		};
+		std::vector<ShadowUpdateJob> ShadowUpdateJobs; // 只增长，复用 Ranges 的内存
+		uint32_t ShadowUpdateJobCount = 0;
+
+		uint32_t MaxShadowUpdates = 0;	  // 每帧最多渲染的阴影贴图数量，0 表示不限制
+		float ShadowUpdateBudget = 0.0f; // 每帧阴影渲染的 GPU 时间上限 (ms)，0 表示不限制
+		Math::Frustum ShadowViewFrustum;  // 计算光源屏幕影响用的相机视锥
+
+		// 每张贴图的 GPU 计时，结果在 ShadowTimerFrames 帧后读取，避免等待 GPU
+		struct ShadowTimerQuery
+		{
+			uint32_t Query = 0;
+			int Type = -1; // ShadowType，-1 表示本帧未使用
+		};
+		static const uint32_t ShadowTimerFrames = 3;
+		ShadowTimerQuery ShadowTimerQueries[ShadowTimerFrames][MaxShadowLights];
+		uint32_t ShadowTimerFrame = 0;
+		float ShadowMapCost[(int)ShadowType::Count] = {}; // 每类贴图渲染一次的平均 GPU 时间 (ms)，0 表示尚未测量
 
 		// Point Shadow
 		std::unordered_map<int, Ref<PointShadowMap>> PointShadowMaps;
@@ -286,17 +626,18 @@ namespace Mc
 		// shader
 		Ref<Shader> DirectionalShadowShader;
 
+		// 实用分割中对数分割的权重，其余为均匀分割
+		static constexpr float CascadeSplitLambda = 0.75f;
+
 		struct StoredDirectionalShadowCPU
 		{
-			glm::mat4 LightSpaceMatrix;
+			glm::mat4 CascadeMatrices[ShadowCascadeCount];
+			uint32_t LightIndex; // 在 DirectionalLights 中的下标
 
 			Ref<DirectionalShadowMap> Shadow;
-			int Slot;
 		};
 
 		std::vector<StoredDirectionalShadowCPU> DirectionalShadows;
-		uint32_t DirectionalShadowTextureSlotIndex = 0;
-		uint32_t DirectionalShadowTextureStart = 0;
 
 		// Spot Shadow
 		std::unordered_map<int, Ref<SpotShadowMap>> SpotShadowMaps;
@@ -306,14 +647,32 @@ namespace Mc
 		struct StoredSpotShadowCPU
 		{
 			glm::mat4 LightSpaceMatrix;
+			glm::vec4 BoundingSphere; // xyz 位置, w 阴影远平面
+			uint32_t LightIndex;	  // 在 SpotLights 中的下标
 
 			Ref<SpotShadowMap> Shadow;
-			int Slot;
 		};
 
 		std::vector<StoredSpotShadowCPU> SpotShadows;
-		uint32_t SpotShadowTextureSlotIndex = 0;
-		uint32_t SpotShadowTextureStart = 0;
+
+		// Shadow Atlas
+		// 方向光级联与聚光灯的阴影共用一张固定大小的深度图集
+		static const uint32_t ShadowAtlasSize = 4096;
+		static const uint32_t MinShadowTileSize = 128;
+		Ref<ShadowAtlas> ShadowAtlas;
+		uint32_t ShadowAtlasTextureSlot = 0;
+
+		// 区块大小为 2 的幂，从大到小按 Z 序排列即可无缝隙地放进图集 (四叉树)
+		struct ShadowTileRequest
+		{
+			ShadowMapState *State;
+			uint32_t Tile;		 // 光源内的第几个区块 (级联)
+			uint32_t Size;
+			float Influence;	 // 放不下时先缩小影响小的区块
+			glm::vec4 *LightRect; // 写回光源数据的 UV 区块
+			int *ShadowMapIndex; // 分配失败时置为 -1
+		};
+		std::vector<ShadowTileRequest> ShadowTileRequests;
 
 		// Camera
 		// -------------------------------------------------------------------------------
@@ -323,9 +682,16 @@ namespace Mc
 			glm::mat4 View;
 			glm::mat4 ViewProjection;
 			glm::vec3 CameraPosition;
+			float padding_0;
 		};
 		CameraData CameraBuffer;
-		// Ref<UniformBuffer> CameraUniformBuffer;
+
+		// BeginScene 到 EndScene 之间提交绘制的 CPU 时间
+		Timer SubmitTimer;
+		// EndScene 中的通道 (阴影、光源、场景) 每帧在帧图中重新声明
+		FrameGraph Graph;
+		// std140 uniform block "Camera" (binding 0)，所有程序共用，每帧上传一次
+		Ref<UniformBuffer> CameraUniformBuffer;
 
 		Renderer3D::Statistics Stats;
 	};
@@ -334,9 +700,76 @@ namespace Mc
 
 	namespace Utils
 	{
-		std::vector<int> GetMaterialTextureIndices(const Ref<Material> &material)
+		// 全局纹理下标，0 为白色纹理
+		// 下标在纹理的生命周期内不变，bindless 与纹理单元两种模式共用
+		int GetTextureIndex(const Ref<Texture2D> &texture)
+		{
+			if (!texture || texture == s_Data.WhiteTexture)
+				return 0;
+
+			auto it = s_Data.RegisteredTextureIndices.find(texture->GetRendererID());
+			if (it != s_Data.RegisteredTextureIndices.end())
+				return it->second;
+
+			int index = (int)s_Data.RegisteredTextures.size();
+			s_Data.RegisteredTextures.push_back(texture);
+			s_Data.RegisteredTextureIndices[texture->GetRendererID()] = index;
+			s_Data.TextureSlotMap.push_back(0);
+			return index;
+		}
+
+		// 数据大小超过容量时按两倍重建 SSBO，再整体上传
+		void UploadStorageBuffer(Ref<ShaderStorageBuffer> &ssbo, uint32_t &capacity, const void *data, uint32_t size)
+		{
+			if (size > capacity)
+			{
+				while (capacity < size)
+					capacity *= 2;
+				ssbo = ShaderStorageBuffer::Create(capacity);
+			}
+
+			ssbo->Bind();
+			ssbo->SetData(data, size);
+			ssbo->UnBind();
+		}
+
+		// 句柄表有新增时上传
+		void FlushBindlessTextures()
+		{
+			for (size_t i = s_Data.BindlessTextureHandles.size(); i < s_Data.RegisteredTextures.size(); i++)
+			{
+				s_Data.BindlessTextureHandles.push_back(s_Data.RegisteredTextures[i]->GetBindlessHandle());
+				s_Data.BindlessTexturesDirty = true;
+			}
+
+			if (s_Data.BindlessTexturesDirty)
+			{
+				UploadStorageBuffer(s_Data.BindlessTextureSSBO, s_Data.BindlessTextureCapacity,
+									s_Data.BindlessTextureHandles.data(), (uint32_t)(s_Data.BindlessTextureHandles.size() * sizeof(uint64_t)));
+				s_Data.BindlessTexturesDirty = false;
+			}
+
+			s_Data.BindlessTextureSSBO->BindBase(10);
+		}
+
+		// 当前批次的 全局下标 -> 纹理单元 映射
+		void FlushTextureSlots()
+		{
+			if (s_Data.TextureSlotMapDirty)
+			{
+				UploadStorageBuffer(s_Data.TextureSlotMapSSBO, s_Data.TextureSlotMapCapacity,
+									s_Data.TextureSlotMap.data(), (uint32_t)(s_Data.TextureSlotMap.size() * sizeof(int)));
+				s_Data.TextureSlotMapDirty = false;
+			}
+
+			s_Data.TextureSlotMapSSBO->BindBase(12);
+		}
+
+		using TextureIndices = std::array<int, (int)TextureType::Count>;
+
+		TextureIndices GetMaterialTextureIndices(const Ref<Material> &material)
 		{
-			std::vector<int> indices((int)TextureType::Count, 0);
+			TextureIndices indices{};
 
 			if (!material)
 				return indices;
@@ -348,44 +781,15 @@ namespace Mc
 				TextureType type = (TextureType)textureTypeIndex;
 				const Ref<Texture2D> &texture = textures.at(type);
 
-				if (texture && texture != s_Data.WhiteTexture)
-				{
-					int foundSlotIndex = -1;
-
-					for (uint32_t slotIndex = 1; slotIndex < s_Data.TextureSlotIndex; ++slotIndex)
-					{
-						if (*s_Data.TextureSlots[slotIndex] == *texture)
-						{
-							foundSlotIndex = slotIndex;
-							break;
-						}
-					}
-
-					if (foundSlotIndex != -1)
-					{
-						indices[textureTypeIndex] = foundSlotIndex;
-					}
-					else
-					{
-						if (s_Data.TextureSlotIndex >= Renderer3DData::MaxTextureSlots)
-							Renderer3D::NextBatch();
-
-						indices[textureTypeIndex] = s_Data.TextureSlotIndex;
-						s_Data.TextureSlots[s_Data.TextureSlotIndex] = texture;
-						s_Data.TextureSlotIndex++;
-					}
-				}
+				indices[textureTypeIndex] = GetTextureIndex(texture);
 			}
 			return indices;
 		}
 
-		std::vector<int> GetMaterialTextureIndices(MaterialComponent &material)
+		// 贴图路径与缓存中记录的路径不一致时才经 TextureManager 重新解析，否则直接使用缓存
+		void ResolveMaterialTextures(MaterialComponent &material)
 		{
-			int TextureSize = 7;
-
-			std::vector<int> indices(TextureSize, 0);
-
-			std::string *mapPointers[] = {
+			const std::string *mapPointers[] = {
 				&material.AlbedoMap,
 				&material.NormalMap,
 				&material.MetallicMap,
@@ -395,159 +799,268 @@ namespace Mc
 				&material.HeightMap
 			};
 
-			for (int textureTypeIndex = 0; textureTypeIndex < TextureSize; ++textureTypeIndex)
+			for (int textureTypeIndex = 0; textureTypeIndex < (int)TextureType::Count; ++textureTypeIndex)
 			{
-				std::string *currentMapPath = mapPointers[textureTypeIndex];
-				if (currentMapPath->empty())
+				const std::string &currentMapPath = *mapPointers[textureTypeIndex];
+				std::string &resolvedPath = material.ResolvedPaths[textureTypeIndex];
+
+				// 空路径且从未解析过时句柄本来就是 nullptr，比较结果相等，不会进入
+				if (currentMapPath == resolvedPath)
 					continue;
 
-				const Ref<Texture2D> &texture = TextureManager::Get().GetTexture(*currentMapPath);
+				// 加载失败的路径同样记下，避免每帧重复尝试
+				material.ResolvedTextures[textureTypeIndex] = currentMapPath.empty() ? nullptr : TextureManager::Get().GetTexture(currentMapPath);
+				resolvedPath = currentMapPath;
+			}
+		}
+
+		TextureIndices GetMaterialTextureIndices(MaterialComponent &material)
+		{
+			ResolveMaterialTextures(material);
 
-				if (texture && texture != s_Data.WhiteTexture)
-				{
-					int foundSlotIndex = -1;
+			TextureIndices indices{};
+			for (int textureTypeIndex = 0; textureTypeIndex < (int)TextureType::Count; ++textureTypeIndex)
+				indices[textureTypeIndex] = GetTextureIndex(material.ResolvedTextures[textureTypeIndex]);
 
-					for (uint32_t slotIndex = 1; slotIndex < s_Data.TextureSlotIndex; ++slotIndex)
-					{
-						if (*s_Data.TextureSlots[slotIndex] == *texture)
-						{
-							foundSlotIndex = slotIndex;
-							break;
-						}
-					}
+			return indices;
+		}
 
-					if (foundSlotIndex != -1)
-					{
-						indices[textureTypeIndex] = foundSlotIndex;
-					}
-					else
-					{
-						if (s_Data.TextureSlotIndex >= Renderer3DData::MaxTextureSlots)
-							Renderer3D::NextBatch();
+		// 纹理单元模式下为材质的贴图分配当前批次的纹理单元，剩余单元不足时先 NextBatch
+		void BindMaterialTextures(const TextureIndices &indices)
+		{
+			if (s_Data.UseBindlessTextures)
+				return;
 
-						indices[textureTypeIndex] = s_Data.TextureSlotIndex;
-						s_Data.TextureSlots[s_Data.TextureSlotIndex] = texture;
-						s_Data.TextureSlotIndex++;
-					}
-				}
+			uint32_t missing = 0;
+			for (int index : indices)
+			{
+				if (index != 0 && s_Data.TextureSlotMap[index] == 0)
+					missing++;
 			}
-			return indices;
+
+			if (missing == 0)
+				return;
+
+			if (s_Data.TextureSlotIndex + missing > Renderer3DData::MaxTextureSlots)
+				Renderer3D::NextBatch();
+
+			for (int index : indices)
+			{
+				if (index == 0 || s_Data.TextureSlotMap[index] != 0)
+					continue;
+
+				uint32_t slot = s_Data.TextureSlotIndex++;
+				s_Data.TextureSlots[slot] = s_Data.RegisteredTextures[index];
+				s_Data.TextureSlotTextureIndices[slot] = index;
+				s_Data.TextureSlotMap[index] = (int)slot;
+			}
+			s_Data.TextureSlotMapDirty = true;
+		}
+
+		// 由材质组件和渲染组件的 Receives 开关生成材质表项，返回它在材质表中的下标
+		// 没有材质组件时使用默认参数
+		int GetMaterialIndex(MaterialComponent *material, bool receivesPBR, bool receivesIBL, bool receivesLight, bool receivesShadow)
+		{
+			MaterialData data{};
+			data.AlbedoColor = glm::vec4(1.0f);
+			data.EmissiveColor = glm::vec4(0.0f);
+			data.Roughness = 0.5f;
+			data.Metallic = 0.0f;
+			data.AO = 1.0f;
+
+			TextureIndices arrIndex{};
+
+			if (material != nullptr)
+			{
+				arrIndex = GetMaterialTextureIndices(*material);
+				data.AlbedoColor = glm::vec4(material->Albedo, 1.0f);
+				data.EmissiveColor = glm::vec4(material->Emissive, 1.0f);
+				data.Roughness = material->Roughness;
+				data.Metallic = material->Metallic;
+				data.AO = material->Ao;
+			}
+
+			// Texture
+			data.AlbedoMapIndex = arrIndex[0];
+			data.NormalMapIndex = arrIndex[1];
+			data.MetallicMapIndex = arrIndex[2];
+			data.RoughnessMapIndex = arrIndex[3];
+			data.AoMapIndex = arrIndex[4];
+			data.EmissiveMapIndex = arrIndex[5];
+			data.HeightMapIndex = arrIndex[6];
+
+			data.ReceivesPBR = (int)receivesPBR;
+			data.ReceivesIBL = (int)receivesIBL;
+			data.ReceivesLight = (int)receivesLight;
+			data.ReceivesShadow = (int)receivesShadow;
+
+			// 可能触发 NextBatch (及材质表重建)，因此在查表之前完成
+			BindMaterialTextures(arrIndex);
+
+			auto it = s_Data.MaterialIndices.find(data);
+			if (it != s_Data.MaterialIndices.end())
+				return it->second;
+
+			int index = (int)s_Data.Materials.size();
+			s_Data.Materials.push_back(data);
+			s_Data.MaterialIndices[data] = index;
+			s_Data.MaterialsDirty = true;
+			return index;
+		}
+
+		// 材质表有变化时才上传
+		void FlushMaterials()
+		{
+			if (s_Data.MaterialsDirty)
+			{
+				UploadStorageBuffer(s_Data.MaterialSSBO, s_Data.MaterialCapacity,
+									s_Data.Materials.data(), (uint32_t)(s_Data.Materials.size() * sizeof(MaterialData)));
+				s_Data.MaterialsDirty = false;
+			}
+
+			s_Data.MaterialSSBO->BindBase(11);
+			s_Data.Stats.MaterialCount = (uint32_t)s_Data.Materials.size();
+		}
+
+		// 投影矩阵的近远平面 (观察空间距离)，透视与正交投影都适用
+		void GetProjectionDepthRange(const glm::mat4 &projection, float &nearPlane, float &farPlane)
+		{
+			if (projection[2][3] != 0.0f)
+			{
+				nearPlane = projection[3][2] / (projection[2][2] - 1.0f);
+				farPlane = projection[3][2] / (projection[2][2] + 1.0f);
+			}
+			else
+			{
+				nearPlane = (projection[3][2] + 1.0f) / projection[2][2];
+				farPlane = (projection[3][2] - 1.0f) / projection[2][2];
+			}
+		}
+
+		// 聚光灯锥体的包围球，锥角较大时比以光源为球心、半径为 Radius 的球小得多
+		glm::vec4 GetSpotLightBoundingSphere(const StoredSpotLight &light)
+		{
+			float cosAngle = glm::min(light.InnerConeCos, light.OuterConeCos);
+			if (cosAngle <= 0.0f)
+				return glm::vec4(light.Position, light.Radius);
+
+			if (cosAngle < 0.70710678f)
+				return glm::vec4(light.Position + light.Direction * (light.Radius * cosAngle), light.Radius * glm::sqrt(1.0f - cosAngle * cosAngle));
+
+			float radius = light.Radius / (2.0f * cosAngle);
+			return glm::vec4(light.Position + light.Direction * radius, radius);
+		}
+
+		// 点光源与聚光灯按包围球分配到簇，下标与 PointLights / SpotLights 一致
+		void BuildLightClusters()
+		{
+			auto &clusters = s_Data.LightClusters;
+			clusters.Clear();
+
+			for (const auto &light : s_Data.PointLights)
+				clusters.AddPointLight(light.Position, light.Radius);
+			for (const auto &light : s_Data.SpotLights)
+			{
+				glm::vec4 sphere = GetSpotLightBoundingSphere(light);
+				clusters.AddSpotLight(glm::vec3(sphere), sphere.w);
+			}
+
+			float nearPlane, farPlane;
+			GetProjectionDepthRange(s_Data.CameraBuffer.Projection, nearPlane, farPlane);
+			clusters.Build(s_Data.CameraBuffer.View, s_Data.CameraBuffer.Projection, nearPlane, farPlane);
+		}
+
+		// 实用分割：对数分割与均匀分割按 lambda 混合，返回每级级联覆盖到的观察空间深度
+		glm::vec4 CalculateCascadeSplits(float nearPlane, float farPlane, float lambda)
+		{
+			glm::vec4 splits(farPlane);
+			for (uint32_t i = 1; i < ShadowCascadeCount; i++)
+			{
+				float p = (float)i / (float)ShadowCascadeCount;
+				float uniformSplit = nearPlane + (farPlane - nearPlane) * p;
+				// 正交相机的近平面可能不为正，只能均匀分割
+				float logSplit = nearPlane > 0.0f ? nearPlane * glm::pow(farPlane / nearPlane, p) : uniformSplit;
+				splits[i - 1] = glm::mix(uniformSplit, logSplit, lambda);
+			}
+			return splits;
 		}
 
-		glm::mat4 CalculateDirectionalLightSpaceMatrix(
+		// 一级级联的光空间矩阵，覆盖相机视锥中 [splitNear, splitFar] 这一段
+		// 正交范围取这一段的包围球，与相机朝向无关；再把世界原点对齐到纹素网格，相机移动和旋转时阴影边缘不闪烁
+		// nearPlane / farPlane 为光空间 z 方向在切片之外额外包含的距离 (背光侧 / 朝光源一侧)，切片外的投射物也能写入
+		glm::mat4 CalculateCascadeLightSpaceMatrix(
 			const glm::mat4 &cameraProjectionMatrix,
 			const glm::mat4 &cameraViewMatrix,
 			const glm::vec3 &lightDirection,
-			float shadowMapDistance,
+			float splitNear,
+			float splitFar,
 			float nearPlane,
-			float farPlane
+			float farPlane,
+			float resolution
 		)
 		{
-			glm::mat4 correctViewProjection = cameraProjectionMatrix * cameraViewMatrix;
+			auto toNdcDepth = [&](float distance) {
+				glm::vec4 clip = cameraProjectionMatrix * glm::vec4(0.0f, 0.0f, -distance, 1.0f);
+				return clip.z / clip.w;
+			};
+			float ndcNear = toNdcDepth(splitNear);
+			float ndcFar = toNdcDepth(splitFar);
 
-			// NDC 范围通常为 [-1, 1] for X, Y, Z
 			glm::vec4 frustumCorners[8] = {
 				// 近平面 (Near Plane)
-				glm::vec4(1.0f, 1.0f, -1.0f, 1.0f),	  // RTN (右上近)
-				glm::vec4(-1.0f, 1.0f, -1.0f, 1.0f),  // LTN
-				glm::vec4(1.0f, -1.0f, -1.0f, 1.0f),  // RBN
-				glm::vec4(-1.0f, -1.0f, -1.0f, 1.0f), // LBN
+				glm::vec4(1.0f, 1.0f, ndcNear, 1.0f),
+				glm::vec4(-1.0f, 1.0f, ndcNear, 1.0f),
+				glm::vec4(1.0f, -1.0f, ndcNear, 1.0f),
+				glm::vec4(-1.0f, -1.0f, ndcNear, 1.0f),
 				// 远平面 (Far Plane)
-				glm::vec4(1.0f, 1.0f, 1.0f, 1.0f),	// RTF (右上远)
-				glm::vec4(-1.0f, 1.0f, 1.0f, 1.0f), // LTF
-				glm::vec4(1.0f, -1.0f, 1.0f, 1.0f), // RBF
-				glm::vec4(-1.0f, -1.0f, 1.0f, 1.0f) // LBF
+				glm::vec4(1.0f, 1.0f, ndcFar, 1.0f),
+				glm::vec4(-1.0f, 1.0f, ndcFar, 1.0f),
+				glm::vec4(1.0f, -1.0f, ndcFar, 1.0f),
+				glm::vec4(-1.0f, -1.0f, ndcFar, 1.0f)
 			};
 
-			// --- 2. 变换到世界空间 (World Space) ---
-			glm::mat4 invCamVP = glm::inverse(correctViewProjection);
+			// --- 变换到世界空间 (World Space) ---
+			glm::mat4 invCamVP = glm::inverse(cameraProjectionMatrix * cameraViewMatrix);
 			glm::vec3 center = glm::vec3(0.0f);
-
 			for (int i = 0; i < 8; ++i)
 			{
 				glm::vec4 worldCorner = invCamVP * frustumCorners[i];
 				frustumCorners[i] = worldCorner / worldCorner.w;
 				center += glm::vec3(frustumCorners[i]);
 			}
-			glm::vec3 frustumCorner = center / 8.0f;
+			center /= 8.0f;
 
-			glm::mat4 lightProjection, lightView, lightSpaceMatrix;
+			// 包围球半径向上取整，避免浮点误差让正交范围逐帧变化
+			float radius = 0.0f;
+			for (int i = 0; i < 8; ++i)
+				radius = glm::max(radius, glm::length(glm::vec3(frustumCorners[i]) - center));
+			radius = glm::ceil(radius * 16.0f) / 16.0f;
 
-			glm::vec3 lightDir = lightDirection;
-			glm::vec3 targetPos = frustumCorner;
-			glm::vec3 lightPos = targetPos - lightDir * shadowMapDistance;
-			glm::vec3 upVector = (glm::abs(glm::dot(lightDir, glm::vec3(0.0, 1.0, 0.0))) > 0.99f)
+			glm::vec3 upVector = (glm::abs(glm::dot(lightDirection, glm::vec3(0.0, 1.0, 0.0))) > 0.99f)
 									 ? glm::vec3(0.0f, 0.0f, 1.0f)
 									 : glm::vec3(0.0f, 1.0f, 0.0f);
+			glm::mat4 lightView = glm::lookAt(center - lightDirection * radius, center, upVector);
 
-			lightView = glm::lookAt(lightPos, targetPos, upVector);
-
-			// ------------------------------------------------------------------------
-
-			const float SHADOW_MAP_DIMENSION = 2048.0f; // 确保与你实际的纹理大小一致
-
-			// --- 边界计算 (此部分代码是正确的) ---
-			glm::vec3 minLightCoords = glm::vec3(std::numeric_limits<float>::max());
-			glm::vec3 maxLightCoords = glm::vec3(std::numeric_limits<float>::lowest());
-
-			for (int i = 0; i < 8; ++i)
-			{
-				glm::vec4 lightCorner = lightView * frustumCorners[i];
-				minLightCoords.x = glm::min(minLightCoords.x, lightCorner.x);
-				maxLightCoords.x = glm::max(maxLightCoords.x, lightCorner.x);
-				minLightCoords.y = glm::min(minLightCoords.y, lightCorner.y);
-				maxLightCoords.y = glm::max(maxLightCoords.y, lightCorner.y);
-				minLightCoords.z = glm::min(minLightCoords.z, lightCorner.z);
-				maxLightCoords.z = glm::max(maxLightCoords.z, lightCorner.z);
-			}
-
-			float lightFrustumWidth = maxLightCoords.x - minLightCoords.x;
-			float lightFrustumHeight = maxLightCoords.y - minLightCoords.y;
-			float texelSizeX = lightFrustumWidth / SHADOW_MAP_DIMENSION;
-			float texelSizeY = lightFrustumHeight / SHADOW_MAP_DIMENSION;
-
-			// 计算对齐前的中心点
-			float lightSpaceCenterX = (minLightCoords.x + maxLightCoords.x) * 0.5f;
-			float lightSpaceCenterY = (minLightCoords.y + maxLightCoords.y) * 0.5f;
-
-			// 计算对齐后的中心点 (向下取整到最近的纹素网格点)
-			float snappedCenterX = floor(lightSpaceCenterX / texelSizeX) * texelSizeX;
-			float snappedCenterY = floor(lightSpaceCenterY / texelSizeY) * texelSizeY;
-
-			// 计算平移偏移量
-			float translationX = snappedCenterX - lightSpaceCenterX;
-			float translationY = snappedCenterY - lightSpaceCenterY;
-
-			glm::mat4 correctionMatrix = glm::translate(glm::mat4(1.0f), glm::vec3(translationX, translationY, 0.0f));
-
-			lightView = correctionMatrix * lightView;
-
-			minLightCoords = glm::vec3(std::numeric_limits<float>::max());
-			maxLightCoords = glm::vec3(std::numeric_limits<float>::lowest());
+			float minZ = std::numeric_limits<float>::max();
+			float maxZ = std::numeric_limits<float>::lowest();
 			for (int i = 0; i < 8; ++i)
 			{
-				glm::vec4 lightCorner = lightView * frustumCorners[i];
-				minLightCoords.x = glm::min(minLightCoords.x, lightCorner.x);
-				maxLightCoords.x = glm::max(maxLightCoords.x, lightCorner.x);
-				minLightCoords.y = glm::min(minLightCoords.y, lightCorner.y);
-				maxLightCoords.y = glm::max(maxLightCoords.y, lightCorner.y);
-				minLightCoords.z = glm::min(minLightCoords.z, lightCorner.z);
-				maxLightCoords.z = glm::max(maxLightCoords.z, lightCorner.z);
+				float z = (lightView * frustumCorners[i]).z;
+				minZ = glm::min(minZ, z);
+				maxZ = glm::max(maxZ, z);
 			}
-			const float Z_OFFSET_NEAR = nearPlane;
-			const float Z_OFFSET_FAR = farPlane;
 
-			float lightNearPlane = minLightCoords.z - Z_OFFSET_NEAR;
-			float lightFarPlane = maxLightCoords.z + Z_OFFSET_FAR;
+			// 观察方向为 -z，离光源最近的角点 z 最大
+			glm::mat4 lightProjection = glm::ortho(-radius, radius, -radius, radius, -maxZ - farPlane, -minZ + nearPlane);
 
-			lightProjection = glm::ortho(
-				minLightCoords.x, maxLightCoords.x,
-				minLightCoords.y, maxLightCoords.y,
-				lightNearPlane, lightFarPlane);
+			// --- 纹素对齐 ---
+			glm::vec4 origin = lightProjection * lightView * glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+			origin *= resolution * 0.5f;
+			glm::vec4 offset = (glm::round(origin) - origin) * (2.0f / resolution);
+			lightProjection[3][0] += offset.x;
+			lightProjection[3][1] += offset.y;
 
-			lightSpaceMatrix = lightProjection * lightView;
-
-			return lightSpaceMatrix;
+			return lightProjection * lightView;
 		}
 
 		glm::mat4 CalculateSpotLightSpaceMatrix(
@@ -600,17 +1113,1114 @@ namespace Mc
 
 			return lightSpaceMatrix;
 		}
-	}
 
-	void Renderer3D::InitSphereGeometry()
-	{
-		// buffer
-		const unsigned int X_SEGMENTS = 64;
-		const unsigned int Y_SEGMENTS = 64;
-		const float PI = 3.14159265359f;
+		// 模型实例环形缓冲区翻倍，本帧已写入的块复制到新缓冲区，块的偏移与映射地址随之更新
+		// 已达到 SSBO 绑定大小的上限时返回 false
+		bool GrowModelInstances()
+		{
+			if (s_Data.ModelInstanceRingSize >= Renderer3DData::MaxModelInstanceRingSize)
+				return false;
 
-		uint32_t SphereVertexCount = (X_SEGMENTS + 1) * (Y_SEGMENTS + 1);
-		std::vector<glm::vec3> Sphere_Positions;
+			uint32_t oldFrameStart = s_Data.ModelInstanceRing->GetFrameStart();
+			s_Data.ModelInstanceRingSize = std::min(s_Data.ModelInstanceRingSize * 2, (uint32_t)Renderer3DData::MaxModelInstanceRingSize);
+			s_Data.ModelInstanceRing->Grow(s_Data.ModelInstanceRingSize);
+
+			uint32_t frameStart = s_Data.ModelInstanceRing->GetFrameStart();
+			for (auto &pair : s_Data.ModelDrawCallBatches)
+			{
+				for (auto &chunk : pair.second.Chunks)
+				{
+					chunk.Offset = chunk.Offset - oldFrameStart + frameStart;
+					chunk.Instances = (MeshInstanceData *)s_Data.ModelInstanceRing->GetMappedData(chunk.Offset);
+				}
+			}
+
+			LOG_CORE_INFO("Renderer3D: model instance buffer grown to {0} MB", s_Data.ModelInstanceRingSize / (1024 * 1024));
+			return true;
+		}
+
+		// 同上，球体实例为区域开头的一次分配，扩大后在其后补足新增的部分
+		bool GrowSphereInstances()
+		{
+			uint32_t capacity = s_Data.SphereCapacity * 2;
+			if ((uint64_t)capacity * sizeof(SphereInstanceData) > Renderer3DData::MaxModelInstanceRingSize)
+				return false;
+
+			s_Data.SphereInstanceRing->Grow(capacity * sizeof(SphereInstanceData));
+
+			uint32_t offset = 0;
+			s_Data.SphereInstanceRing->Allocate((capacity - s_Data.SphereCapacity) * sizeof(SphereInstanceData), offset, sizeof(SphereInstanceData));
+			s_Data.SphereInstanceOffset = s_Data.SphereInstanceRing->GetFrameStart();
+			s_Data.SphereInstances = (SphereInstanceData *)s_Data.SphereInstanceRing->GetMappedData(s_Data.SphereInstanceOffset);
+			s_Data.SphereCapacity = capacity;
+
+			LOG_CORE_INFO("Renderer3D: sphere instance capacity grown to {0}", capacity);
+			return s_Data.SphereInstances != nullptr;
+		}
+
+		// 当前批次是否还能容纳该网格的一个实例
+		// 环形缓冲区空间不足时先扩大，只有达到上限时才需要 NextBatch
+		bool HasModelInstanceSpace(const Renderer3DData::ModelCallKey &key)
+		{
+			auto it = s_Data.ModelDrawCallBatches.find(key);
+			if (it != s_Data.ModelDrawCallBatches.end())
+			{
+				const auto &chunks = it->second.Chunks;
+				if (!chunks.empty() && chunks.back().Count < chunks.back().Capacity)
+					return true;
+			}
+
+			if (s_Data.ModelInstanceRing->CanAllocate(Renderer3DData::ModelInstancesPerChunk * sizeof(MeshInstanceData), sizeof(MeshInstanceData)))
+				return true;
+
+			return GrowModelInstances();
+		}
+
+		// 观察空间深度，相机前方为正
+		float GetViewDepth(const glm::vec3 &position)
+		{
+			const glm::mat4 &view = s_Data.CameraBuffer.View;
+			return -(view[0][2] * position.x + view[1][2] * position.y + view[2][2] * position.z + view[3][2]);
+		}
+
+		// 返回映射内存中下一个实例的位置，调用前需保证 HasModelInstanceSpace
+		// 排序用的块深度 (最近的实例) 与是否蒙皮在这里累积，Flush 时不从映射内存读回
+		// CPU 剔除时同时记录实例的变换
+		MeshInstanceData *AllocateModelInstance(const Renderer3DData::ModelCallKey &key, const glm::mat4 &transform, bool skinned)
+		{
+			Renderer3DData::ModelCallBatch &batch = s_Data.ModelDrawCallBatches[key];
+			batch.LastUsedFrame = s_Data.FrameIndex;
+
+			if (batch.Chunks.empty() || batch.Chunks.back().Count >= batch.Chunks.back().Capacity)
+			{
+				// 同一帧内再次写满说明容量偏小，翻倍
+				if (!batch.Chunks.empty())
+					batch.ChunkCapacity = std::min(batch.ChunkCapacity * 2, Renderer3DData::MaxModelInstancesPerChunk);
+
+				Renderer3DData::ModelInstanceChunk chunk;
+				chunk.Capacity = batch.ChunkCapacity;
+				chunk.FirstInstance = batch.InstanceCount;
+
+				// 环形缓冲区剩余空间不够时退回到最小块
+				if (!s_Data.ModelInstanceRing->CanAllocate(chunk.Capacity * sizeof(MeshInstanceData), sizeof(MeshInstanceData)))
+					chunk.Capacity = Renderer3DData::ModelInstancesPerChunk;
+
+				// 整个区域一次绑定，实例通过 gl_BaseInstanceARB 按下标访问，因此按实例大小对齐
+				chunk.Instances = (MeshInstanceData *)s_Data.ModelInstanceRing->Allocate(chunk.Capacity * sizeof(MeshInstanceData), chunk.Offset, sizeof(MeshInstanceData));
+				batch.Chunks.push_back(chunk);
+			}
+
+			Renderer3DData::ModelInstanceChunk &chunk = batch.Chunks.back();
+			batch.InstanceCount++;
+
+			if (s_Data.UseDrawSorting)
+				chunk.NearestDepth = std::min(chunk.NearestDepth, GetViewDepth(glm::vec3(transform[3])));
+			chunk.Skinned |= skinned;
+
+			if (s_Data.BatchCullingMode == Renderer3D::CullingMode::CPU)
+				batch.CullInstances.push_back({ transform, skinned });
+
+			return &chunk.Instances[chunk.Count++];
+		}
+
+		void BindCamera()
+		{
+			s_Data.CameraUniformBuffer->SetData(&s_Data.CameraBuffer, sizeof(Renderer3DData::CameraData));
+			s_Data.CameraUniformBuffer->Bind();
+		}
+
+		void BeginBonePalettes()
+		{
+			s_Data.BonePaletteRing->BeginFrame();
+			s_Data.BonePaletteOffsets.clear();
+		}
+
+		// 返回实体骨骼调色板的位置 (以 mat4 为单位)，同一帧内只写入一次
+		int GetBonePaletteOffset(int entityID, const std::vector<glm::mat4> &finalBoneMatrices)
+		{
+			auto it = s_Data.BonePaletteOffsets.find(entityID);
+			if (it != s_Data.BonePaletteOffsets.end())
+				return it->second;
+
+			// 每次分配大小相同，且是 mat4 的整数倍，因此相对偏移总能被 sizeof(glm::mat4) 整除
+			uint32_t offset = 0;
+			glm::mat4 *palette = (glm::mat4 *)s_Data.BonePaletteRing->Allocate(MAX_BONES * sizeof(glm::mat4), offset);
+			if (palette == nullptr)
+			{
+				LOG_CORE_WARN("Max bone palettes reached!");
+				return -1;
+			}
+
+			uint32_t count = std::min((uint32_t)finalBoneMatrices.size(), (uint32_t)MAX_BONES);
+			memcpy(palette, finalBoneMatrices.data(), count * sizeof(glm::mat4));
+			for (uint32_t i = count; i < MAX_BONES; i++)
+				palette[i] = glm::mat4(1.0f);
+
+			int paletteOffset = (int)((offset - s_Data.BonePaletteRing->GetFrameStart()) / sizeof(glm::mat4));
+			s_Data.BonePaletteOffsets[entityID] = paletteOffset;
+
+			if (s_Data.FrameSkinningMode == Renderer3D::SkinningMode::CPU)
+			{
+				// 不从映射内存读回 (写合并内存的读取很慢)
+				s_Data.BonePaletteCopies.resize(paletteOffset + MAX_BONES, glm::mat4(1.0f));
+				memcpy(&s_Data.BonePaletteCopies[paletteOffset], finalBoneMatrices.data(), count * sizeof(glm::mat4));
+			}
+
+			return paletteOffset;
+		}
+
+		void BindBonePalettes()
+		{
+			s_Data.BonePaletteRing->BindRange(5, s_Data.BonePaletteRing->GetFrameStart(), s_Data.BonePaletteRing->GetFrameSize());
+		}
+
+		void BeginSkinning()
+		{
+			s_Data.SkinningJobs.clear();
+			s_Data.SkinningJobMeshIDs.clear();
+			s_Data.SkinnedVertexOffsets.clear();
+			s_Data.SkinnedVertexCount = 0;
+			s_Data.SkinningJobsDispatched = 0;
+
+			s_Data.FrameSkinningMode = s_Data.SkinningMode;
+			if (s_Data.FrameSkinningMode == Renderer3D::SkinningMode::CPU)
+			{
+				if (!s_Data.Skinner)
+				{
+					s_Data.Skinner = CreateScope<CpuSkinner>();
+					s_Data.Skinner->SetThreadCount(s_Data.CpuSkinningThreads);
+					s_Data.SkinnedVertexRing = ShaderStorageRingBuffer::Create(s_Data.SkinnedVertexCapacity);
+				}
+				s_Data.SkinnedVertexRing->BeginFrame();
+				s_Data.BonePaletteCopies.clear();
+			}
+		}
+
+		void EndSkinning()
+		{
+			if (s_Data.FrameSkinningMode == Renderer3D::SkinningMode::CPU)
+				s_Data.SkinnedVertexRing->EndFrame();
+		}
+
+		// CPU 蒙皮第一次用到网格时从 MeshManager 取走绑定姿势，没有骨骼权重的网格没有保留，按静态网格绘制
+		bool AddCpuSkinningMesh(uint32_t meshID)
+		{
+			if (s_Data.Skinner->HasMesh(meshID))
+				return true;
+
+			std::vector<ModelVertex> vertices;
+			if (!MeshManager::Get().TakeBindPoseVertices(meshID, vertices))
+				return false;
+
+			s_Data.Skinner->AddMesh(meshID, vertices.data(), (uint32_t)vertices.size());
+			return true;
+		}
+
+		// 返回 (实体, 网格) 蒙皮后的顶点在 SkinnedVertexBuffer 中的起始位置，同一帧内只添加一次作业
+		// 调色板分配失败或 CPU 模式下网格没有骨骼权重时返回 -1，按静态网格绘制
+		int GetSkinnedVertexOffset(int entityID, uint32_t meshID, const std::vector<glm::mat4> &finalBoneMatrices)
+		{
+			uint64_t key = ((uint64_t)(uint32_t)entityID << 32) | meshID;
+			auto it = s_Data.SkinnedVertexOffsets.find(key);
+			if (it != s_Data.SkinnedVertexOffsets.end())
+				return it->second;
+
+			if (s_Data.FrameSkinningMode == Renderer3D::SkinningMode::CPU && !AddCpuSkinningMesh(meshID))
+				return -1;
+
+			Ref<Mesh> mesh = MeshManager::Get().GetMeshByID(meshID);
+			int paletteOffset = GetBonePaletteOffset(entityID, finalBoneMatrices);
+			if (!mesh || paletteOffset < 0)
+				return -1;
+
+			SkinningJobData job;
+			job.BaseVertex = mesh->GetBaseVertex();
+			job.VertexCount = mesh->GetVertexCount();
+			job.OutputOffset = s_Data.SkinnedVertexCount;
+			job.PaletteOffset = paletteOffset;
+			s_Data.SkinningJobs.push_back(job);
+			s_Data.SkinningJobMeshIDs.push_back(meshID);
+			s_Data.SkinnedVertexCount += job.VertexCount;
+
+			s_Data.SkinnedVertexOffsets[key] = (int)job.OutputOffset;
+			return (int)job.OutputOffset;
+		}
+
+		// 在工作线程上完成尚未处理的作业，结果写入本帧的环形缓冲区区域
+		// 作业的网格都已由 AddCpuSkinningMesh 交给 CpuSkinner，不需要从 GPU 读回顶点
+		void DispatchCpuSkinning()
+		{
+			if (s_Data.SkinningJobsDispatched < (uint32_t)s_Data.SkinningJobs.size())
+			{
+				// 区域不足时扩大，之前写入的结果随之复制，不需要重新蒙皮
+				uint32_t outputSize = s_Data.SkinnedVertexCount * sizeof(SkinnedVertex);
+				if (outputSize > s_Data.SkinnedVertexRing->GetFrameSize())
+				{
+					uint32_t frameSize = s_Data.SkinnedVertexRing->GetFrameSize();
+					while (frameSize < outputSize)
+						frameSize *= 2;
+					s_Data.SkinnedVertexRing->Grow(frameSize);
+					LOG_CORE_INFO("Renderer3D: CPU skinned vertex capacity grown to {0}", frameSize / (uint32_t)sizeof(SkinnedVertex));
+				}
+
+				uint32_t first = s_Data.SkinningJobsDispatched;
+				uint32_t vertexCount = 0;
+				for (uint32_t i = first; i < (uint32_t)s_Data.SkinningJobs.size(); i++)
+					vertexCount += s_Data.SkinningJobs[i].VertexCount;
+
+				// 作业按 OutputOffset 顺序连续分配，相对偏移即 OutputOffset * sizeof(SkinnedVertex)
+				uint32_t offset = 0;
+				s_Data.SkinnedVertexRing->Allocate(vertexCount * sizeof(SkinnedVertex), offset, sizeof(SkinnedVertex));
+				SkinnedVertex *output = (SkinnedVertex *)s_Data.SkinnedVertexRing->GetMappedData(s_Data.SkinnedVertexRing->GetFrameStart());
+
+				s_Data.CpuSkinningJobs.clear();
+				for (uint32_t i = first; i < (uint32_t)s_Data.SkinningJobs.size(); i++)
+				{
+					const SkinningJobData &job = s_Data.SkinningJobs[i];
+
+					CpuSkinner::Job cpuJob;
+					cpuJob.MeshID = s_Data.SkinningJobMeshIDs[i];
+					cpuJob.Palette = &s_Data.BonePaletteCopies[job.PaletteOffset];
+					cpuJob.Output = output + job.OutputOffset;
+					s_Data.CpuSkinningJobs.push_back(cpuJob);
+				}
+
+				s_Data.Skinner->Skin(s_Data.CpuSkinningJobs);
+
+				const CpuSkinner::Statistics &stats = s_Data.Skinner->GetStats();
+				s_Data.Stats.SkinnedVertices += stats.Vertices;
+				s_Data.Stats.SkinningDispatches++;
+				s_Data.Stats.CpuSkinningTime += stats.Milliseconds;
+				s_Data.Stats.CpuSkinningThreads = stats.Threads;
+
+				s_Data.SkinningJobsDispatched = (uint32_t)s_Data.SkinningJobs.size();
+			}
+
+			// 映射内存是一致的 (coherent)，绑定后即可由之后的绘制读取
+			s_Data.SkinnedVertexRing->BindRange(19, s_Data.SkinnedVertexRing->GetFrameStart(), s_Data.SkinnedVertexRing->GetFrameSize());
+		}
+
+		// 调度尚未处理的蒙皮作业，之后的绘制把结果当作静态几何读取
+		// NextBatch 会在 EndScene 之前 Flush，因此阴影通道和每次 Flush 之前都会调用，只处理新增的作业
+		void DispatchSkinning()
+		{
+			if (s_Data.FrameSkinningMode == Renderer3D::SkinningMode::CPU)
+			{
+				DispatchCpuSkinning();
+				return;
+			}
+
+			if (s_Data.SkinningJobsDispatched < (uint32_t)s_Data.SkinningJobs.size())
+			{
+				// 输出缓冲区不足时重建，之前调度的结果随之丢失，本帧的作业全部重新蒙皮
+				uint32_t outputSize = s_Data.SkinnedVertexCount * sizeof(SkinnedVertex);
+				if (outputSize > s_Data.SkinnedVertexCapacity)
+				{
+					while (s_Data.SkinnedVertexCapacity < outputSize)
+						s_Data.SkinnedVertexCapacity *= 2;
+					s_Data.SkinnedVertexSSBO = ShaderStorageBuffer::Create(s_Data.SkinnedVertexCapacity);
+					s_Data.SkinningJobsDispatched = 0;
+				}
+
+				uint32_t first = s_Data.SkinningJobsDispatched;
+				uint32_t count = (uint32_t)s_Data.SkinningJobs.size() - first;
+				UploadStorageBuffer(s_Data.SkinningJobSSBO, s_Data.SkinningJobCapacity, &s_Data.SkinningJobs[first], count * sizeof(SkinningJobData));
+
+				uint32_t maxVertexCount = 0;
+				for (uint32_t i = first; i < first + count; i++)
+				{
+					maxVertexCount = std::max(maxVertexCount, s_Data.SkinningJobs[i].VertexCount);
+					s_Data.Stats.SkinnedVertices += s_Data.SkinningJobs[i].VertexCount;
+				}
+
+				s_Data.SkinningShader->Bind();
+				BindBonePalettes();
+				GLState::BindBufferBase(GL_SHADER_STORAGE_BUFFER, 20, MeshManager::Get().GetVertexBuffer()->GetRendererID());
+				s_Data.SkinningJobSSBO->BindBase(21);
+				s_Data.SkinnedVertexSSBO->BindBase(19);
+
+				// y 维每个工作组一个作业，x 维覆盖最大的网格
+				for (uint32_t offset = 0; offset < count; offset += Renderer3DData::MaxSkinningJobsPerDispatch)
+				{
+					s_Data.SkinningShader->SetInt("u_JobOffset", (int)offset);
+					glDispatchCompute((maxVertexCount + 63) / 64, std::min(count - offset, (uint32_t)Renderer3DData::MaxSkinningJobsPerDispatch), 1);
+					s_Data.Stats.SkinningDispatches++;
+				}
+
+				// 之后的顶点着色器读取蒙皮结果
+				glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+				s_Data.SkinningShader->Unbind();
+
+				s_Data.SkinningJobsDispatched = (uint32_t)s_Data.SkinningJobs.size();
+			}
+
+			// 没有动画实例时也需要绑定，着色器中声明了该缓冲区
+			s_Data.SkinnedVertexSSBO->BindBase(19);
+		}
+
+		// boundingSphere 为局部空间包围球，带动画的实例包围体未知，总是可见
+		void AddShadowCaster(uint32_t vertexArrayID, uint32_t indexCount, uint32_t firstIndex, int32_t baseVertex, uint32_t mode,
+							 const glm::mat4 &transform, const glm::vec4 &boundingSphere, int skinnedVertexOffset)
+		{
+			uint64_t key = ((uint64_t)vertexArrayID << 32) | firstIndex;
+			Renderer3DData::ShadowCasterBatch &batch = s_Data.ShadowCasterBatches[key];
+			batch.VertexArrayID = vertexArrayID;
+			batch.IndexCount = indexCount;
+			batch.FirstIndex = firstIndex;
+			batch.BaseVertex = baseVertex;
+			batch.Mode = mode;
+
+			batch.Instances.push_back({ transform, skinnedVertexOffset, 0, 0, 0 });
+			if (skinnedVertexOffset >= 0)
+				batch.Bounds.push_back(glm::vec4(glm::vec3(transform[3]), std::numeric_limits<float>::infinity()));
+			else
+				batch.Bounds.push_back(Math::TransformBoundingSphere(transform, boundingSphere));
+		}
+
+		uint32_t GetShadowVisibleRingSize()
+		{
+			return s_Data.ShadowInstanceCapacity * Renderer3DData::MaxShadowLights * sizeof(uint32_t) + 1024;
+		}
+
+		// 把所有批次的阴影实例连续写入环形缓冲区，阴影通道之前调用一次
+		void UploadShadowCasters()
+		{
+			uint32_t count = 0;
+			for (auto &pair : s_Data.ShadowCasterBatches)
+				count += (uint32_t)pair.second.Instances.size();
+
+			s_Data.ShadowInstanceCount = 0;
+			if (count == 0)
+				return;
+
+			if (count > s_Data.ShadowInstanceCapacity)
+			{
+				while (s_Data.ShadowInstanceCapacity < count)
+					s_Data.ShadowInstanceCapacity *= 2;
+				s_Data.ShadowInstanceRing = ShaderStorageRingBuffer::Create(s_Data.ShadowInstanceCapacity * sizeof(ShadowInstanceData));
+				s_Data.ShadowVisibleRing = ShaderStorageRingBuffer::Create(GetShadowVisibleRingSize());
+			}
+
+			s_Data.ShadowInstanceRing->BeginFrame();
+			s_Data.ShadowVisibleRing->BeginFrame();
+			s_Data.ShadowCasterCuller.Clear();
+			s_Data.ShadowCasterBounds.clear();
+			auto *instances = (ShadowInstanceData *)s_Data.ShadowInstanceRing->Allocate(count * sizeof(ShadowInstanceData), s_Data.ShadowInstanceOffset);
+
+			for (auto &pair : s_Data.ShadowCasterBatches)
+			{
+				Renderer3DData::ShadowCasterBatch &batch = pair.second;
+				batch.BaseInstance = s_Data.ShadowInstanceCount;
+				memcpy(instances + s_Data.ShadowInstanceCount, batch.Instances.data(), batch.Instances.size() * sizeof(ShadowInstanceData));
+				s_Data.ShadowInstanceCount += (uint32_t)batch.Instances.size();
+
+				for (const glm::vec4 &bounds : batch.Bounds)
+				{
+					s_Data.ShadowCasterCuller.Add(glm::vec3(bounds), bounds.w);
+					s_Data.ShadowCasterBounds.push_back(bounds);
+				}
+			}
+
+			s_Data.ShadowInstanceRing->BindRange(13, s_Data.ShadowInstanceOffset, count * sizeof(ShadowInstanceData));
+			s_Data.ShadowVisibleRing->BindRange(14, s_Data.ShadowVisibleRing->GetFrameStart(), s_Data.ShadowVisibleRing->GetFrameSize());
+		}
+
+		// 包围球与点光源立方体贴图各个面的视锥 (90 度) 是否相交，返回 6 位掩码 (+X, -X, +Y, -Y, +Z, -Z)
+		uint32_t GetPointShadowFaceMask(const glm::vec4 &bounds, const glm::vec3 &lightPosition, float farPlane)
+		{
+			glm::vec3 d = glm::vec3(bounds) - lightPosition;
+			float radius = bounds.w;
+			if (glm::length(d) - radius > farPlane)
+				return 0;
+
+			// 面 +X 的侧平面为 x = ±y 与 x = ±z，法线长度为 sqrt(2)
+			float slack = -radius * 1.41421356f;
+			uint32_t mask = 0;
+			for (int axis = 0; axis < 3; axis++)
+			{
+				int u = (axis + 1) % 3;
+				int v = (axis + 2) % 3;
+				for (int side = 0; side < 2; side++)
+				{
+					float a = side == 0 ? d[axis] : -d[axis];
+					if (a - d[u] >= slack && a + d[u] >= slack && a - d[v] >= slack && a + d[v] >= slack)
+						mask |= 1u << (axis * 2 + side);
+				}
+			}
+			return mask;
+		}
+
+		// 为一个光源生成可见实例列表 (ShadowDrawRanges)，返回被剔除的投射物数量
+		// faceMask(i) 返回实例 i 的立方体面掩码 (非点光源为 1)，0 表示被剔除
+		// contentHash 为光源参数与可见投射物的哈希，与上次渲染时相同则阴影贴图不需要重新渲染
+		// 可见投射物中有蒙皮网格时调色板每帧变化，contentHash 为 0
+		template<typename FaceMaskFunc>
+		uint32_t BuildShadowCasterList(FaceMaskFunc &&faceMask, const void *lightData, size_t lightDataSize, uint64_t &contentHash)
+		{
+			s_Data.ShadowDrawRanges.clear();
+			contentHash = HashBytes(HashSeed, lightData, lightDataSize);
+
+			if (s_Data.ShadowInstanceCount == 0)
+				return 0;
+
+			uint32_t offset = 0;
+			uint32_t *visible = (uint32_t *)s_Data.ShadowVisibleRing->Allocate(s_Data.ShadowInstanceCount * sizeof(uint32_t), offset, sizeof(uint32_t));
+			if (visible == nullptr)
+			{
+				LOG_CORE_WARN("Renderer3D: shadow visible buffer is full, light skipped!");
+				contentHash = 0;
+				return 0;
+			}
+			uint32_t visibleBase = (offset - s_Data.ShadowVisibleRing->GetFrameStart()) / sizeof(uint32_t);
+
+			bool animated = false;
+			uint32_t visibleCount = 0;
+			for (auto &pair : s_Data.ShadowCasterBatches)
+			{
+				const Renderer3DData::ShadowCasterBatch &batch = pair.second;
+				uint32_t first = visibleCount;
+
+				for (uint32_t i = 0; i < (uint32_t)batch.Instances.size(); i++)
+				{
+					uint32_t instanceIndex = batch.BaseInstance + i;
+					uint32_t mask = faceMask(instanceIndex);
+					if (mask == 0)
+						continue;
+
+					visible[visibleCount++] = instanceIndex | (mask << Renderer3DData::ShadowFaceMaskShift);
+
+					const ShadowInstanceData &instance = batch.Instances[i];
+					animated |= instance.SkinnedVertexOffset >= 0;
+					contentHash = HashBytes(contentHash, &pair.first, sizeof(pair.first));
+					contentHash = HashBytes(contentHash, &instance, sizeof(ShadowInstanceData));
+					contentHash = HashBytes(contentHash, &mask, sizeof(mask));
+				}
+
+				if (visibleCount != first)
+					s_Data.ShadowDrawRanges.push_back({ &batch, visibleBase + first, visibleCount - first });
+			}
+
+			if (animated)
+				contentHash = 0;
+
+			return s_Data.ShadowInstanceCount - visibleCount;
+		}
+
+		// 方向光每级级联为一个正交盒、聚光灯为锥形视锥，都由光空间矩阵提取平面
+		// 掩码的第 i 位表示与第 i 个矩阵的视锥相交 (方向光即第 i 级级联)
+		uint32_t BuildShadowCasterList(const glm::mat4 *lightSpaceMatrices, uint32_t count, uint64_t &contentHash)
+		{
+			if (count == 1)
+			{
+				s_Data.ShadowCasterCuller.Cull(Math::Frustum::FromViewProjection(lightSpaceMatrices[0]));
+				return BuildShadowCasterList([](uint32_t index) { return s_Data.ShadowCasterCuller.IsVisible(index) ? 1u : 0u; },
+											 lightSpaceMatrices, sizeof(glm::mat4), contentHash);
+			}
+
+			auto &masks = s_Data.ShadowCascadeMasks;
+			masks.assign(s_Data.ShadowInstanceCount, 0);
+			for (uint32_t c = 0; c < count; c++)
+			{
+				s_Data.ShadowCasterCuller.Cull(Math::Frustum::FromViewProjection(lightSpaceMatrices[c]));
+				for (uint32_t i = 0; i < s_Data.ShadowInstanceCount; i++)
+					masks[i] |= (uint8_t)(s_Data.ShadowCasterCuller.IsVisible(i) ? 1u << c : 0u);
+			}
+
+			return BuildShadowCasterList([](uint32_t index) { return (uint32_t)s_Data.ShadowCascadeMasks[index]; },
+										 lightSpaceMatrices, count * sizeof(glm::mat4), contentHash);
+		}
+
+		// 当前绑定的阴影着色器与帧缓冲下，每个网格一次实例化绘制
+		void DrawShadowCasterList()
+		{
+			for (const auto &range : s_Data.ShadowDrawRanges)
+			{
+				const Renderer3DData::ShadowCasterBatch &batch = *range.Batch;
+				GLState::BindVertexArray(batch.VertexArrayID);
+				glDrawElementsInstancedBaseVertexBaseInstance(batch.Mode, batch.IndexCount, GL_UNSIGNED_INT,
+															  (const void *)(uintptr_t)(batch.FirstIndex * sizeof(uint32_t)),
+															  (GLsizei)range.Count, batch.BaseVertex, range.BaseInstance);
+				s_Data.Stats.ShadowDrawCalls++;
+			}
+		}
+
+		// 内容与上次渲染相同时直接复用阴影贴图
+		bool IsShadowMapCached(ShadowMapState &state, uint64_t contentHash)
+		{
+			if (state.Rendered && contentHash != 0 && contentHash == state.ContentHash)
+			{
+				state.StaleFrames = 0;
+				s_Data.Stats.ShadowMapsCached++;
+				return true;
+			}
+			return false;
+		}
+
+		// 读取 ShadowTimerFrames 帧前的 GPU 计时，更新每类贴图的平均耗时
+		void BeginShadowUpdates()
+		{
+			s_Data.ShadowViewFrustum = Math::Frustum::FromViewProjection(s_Data.CameraBuffer.ViewProjection);
+			s_Data.ShadowUpdateJobCount = 0;
+
+			for (auto &timer : s_Data.ShadowTimerQueries[s_Data.ShadowTimerFrame])
+			{
+				if (timer.Type < 0)
+					continue;
+
+				GLuint available = 0;
+				glGetQueryObjectuiv(timer.Query, GL_QUERY_RESULT_AVAILABLE, &available);
+				if (available)
+				{
+					GLuint64 elapsed = 0;
+					glGetQueryObjectui64v(timer.Query, GL_QUERY_RESULT, &elapsed);
+					float milliseconds = (float)elapsed * 1e-6f;
+
+					float &cost = s_Data.ShadowMapCost[timer.Type];
+					cost = cost == 0.0f ? milliseconds : glm::mix(cost, milliseconds, 0.1f);
+				}
+				timer.Type = -1;
+			}
+		}
+
+		// 光源范围 (xyz 位置, w 半径) 在屏幕上的影响，0 ~ 1
+		// 不在相机视锥内时取一个很小的值，轮转时仍会轮到它
+		float GetShadowScreenInfluence(const glm::vec4 &lightSphere)
+		{
+			static constexpr float MinInfluence = 0.01f;
+
+			glm::vec3 center = glm::vec3(lightSphere);
+			float distance = glm::length(center - s_Data.CameraBuffer.CameraPosition);
+			if (distance <= lightSphere.w)
+				return 1.0f;
+
+			for (const auto &plane : s_Data.ShadowViewFrustum.Planes)
+			{
+				if (glm::dot(glm::vec3(plane), center) + plane.w < -lightSphere.w)
+					return MinInfluence;
+			}
+
+			// 投影到 NDC 的半径，近似为在屏幕上的覆盖程度
+			float projectedRadius = lightSphere.w / distance * s_Data.CameraBuffer.Projection[1][1];
+			return glm::clamp(projectedRadius, MinInfluence, 1.0f);
+		}
+
+		// Morton 码的偶数位为 x，奇数位为 y
+		glm::uvec2 DecodeMorton(uint32_t code)
+		{
+			glm::uvec2 position(0u);
+			for (uint32_t bit = 0; bit < 16; bit++)
+			{
+				position.x |= ((code >> (2 * bit)) & 1u) << bit;
+				position.y |= ((code >> (2 * bit + 1)) & 1u) << bit;
+			}
+			return position;
+		}
+
+		uint32_t FloorPowerOfTwo(uint32_t value)
+		{
+			uint32_t result = 1;
+			while (result * 2 <= value)
+				result *= 2;
+			return result;
+		}
+
+		// 每帧为方向光级联与聚光灯分配图集区块，并写回光源数据
+		// 聚光灯的区块大小随屏幕覆盖缩小；总面积超出图集时，从最大且影响最小的区块开始减半
+		// 区块位置或大小变化后旧内容失效，该贴图本帧必须重新渲染
+		void AllocateShadowAtlas()
+		{
+			const uint32_t atlasSize = Renderer3DData::ShadowAtlasSize;
+			const uint32_t maxTileSize = atlasSize / 2;
+
+			auto &requests = s_Data.ShadowTileRequests;
+			requests.clear();
+
+			for (auto &data : s_Data.DirectionalShadows)
+			{
+				auto &light = s_Data.DirectionalLights[data.LightIndex];
+				uint32_t size = FloorPowerOfTwo(glm::clamp(data.Shadow->GetResolution(), Renderer3DData::MinShadowTileSize, maxTileSize));
+				for (uint32_t c = 0; c < ShadowCascadeCount; c++)
+					requests.push_back({ &data.Shadow->GetState(), c, size, 1.0f, &light.CascadeRects[c], &light.ShadowMapIndex });
+			}
+
+			for (auto &data : s_Data.SpotShadows)
+			{
+				auto &light = s_Data.SpotLights[data.LightIndex];
+				float influence = GetShadowScreenInfluence(data.BoundingSphere);
+				uint32_t size = (uint32_t)((float)data.Shadow->GetResolution() * influence);
+				size = FloorPowerOfTwo(glm::clamp(size, Renderer3DData::MinShadowTileSize, maxTileSize));
+				requests.push_back({ &data.Shadow->GetState(), 0, size, influence, &light.AtlasRect, &light.ShadowMapIndex });
+			}
+
+			const uint64_t capacity = (uint64_t)atlasSize * atlasSize;
+			uint64_t area = 0;
+			for (const auto &request : requests)
+				area += (uint64_t)request.Size * request.Size;
+
+			while (area > capacity)
+			{
+				Renderer3DData::ShadowTileRequest *largest = nullptr;
+				for (auto &request : requests)
+				{
+					if (request.Size <= Renderer3DData::MinShadowTileSize)
+						continue;
+					if (!largest || request.Size > largest->Size || (request.Size == largest->Size && request.Influence < largest->Influence))
+						largest = &request;
+				}
+				if (!largest)
+					break;
+
+				area -= (uint64_t)largest->Size * largest->Size * 3 / 4;
+				largest->Size /= 2;
+			}
+
+			// 从大到小放置，每个区块的起始面积都是自身面积的整数倍，Z 序下恰好对齐到四叉树节点
+			std::stable_sort(requests.begin(), requests.end(), [](const auto &a, const auto &b) {
+				return a.Size > b.Size;
+			});
+
+			uint64_t offset = 0;
+			for (auto &request : requests)
+			{
+				uint64_t tileArea = (uint64_t)request.Size * request.Size;
+				glm::vec4 rect(0.0f);
+				if (offset + tileArea <= capacity)
+				{
+					glm::uvec2 position = DecodeMorton((uint32_t)(offset / tileArea)) * request.Size;
+					rect = glm::vec4((float)position.x, (float)position.y, (float)request.Size, (float)request.Size);
+					offset += tileArea;
+				}
+				else
+				{
+					LOG_CORE_WARN("Renderer3D: shadow atlas is full, shadow skipped!");
+					*request.ShadowMapIndex = -1;
+				}
+
+				if (request.State->AtlasRects[request.Tile] != rect)
+				{
+					request.State->AtlasRects[request.Tile] = rect;
+					request.State->Rendered = false;
+				}
+				*request.LightRect = rect / (float)atlasSize;
+			}
+
+			s_Data.ShadowAtlas->BindTexture(s_Data.ShadowAtlasTextureSlot);
+		}
+
+		// 当前光源的可见列表 (ShadowDrawRanges) 移入队列，优先级为屏幕影响 × (1 + 推迟的帧数)
+		void QueueShadowUpdate(Renderer3DData::ShadowType type, uint32_t index, ShadowMapState &state, uint64_t contentHash, float influence)
+		{
+			if (s_Data.ShadowUpdateJobCount == s_Data.ShadowUpdateJobs.size())
+				s_Data.ShadowUpdateJobs.emplace_back();
+
+			auto &job = s_Data.ShadowUpdateJobs[s_Data.ShadowUpdateJobCount++];
+			job.Type = type;
+			job.Index = index;
+			job.State = &state;
+			job.ContentHash = contentHash;
+			job.Priority = state.Rendered ? influence * (1.0f + (float)state.StaleFrames) : std::numeric_limits<float>::infinity();
+			job.Ranges.swap(s_Data.ShadowDrawRanges);
+		}
+
+		// bindTarget 绑定点光源的立方体贴图或阴影图集中的区块，同时设置视口
+		// 场景的帧缓冲与视口由帧图在阴影通道结束后恢复
+		template<typename BindTarget, typename SetUniforms>
+		void RenderShadowMap(const Ref<Shader> &shader, BindTarget &&bindTarget, SetUniforms &&setUniforms)
+		{
+			bindTarget();
+			shader->Bind();
+
+			// --- 启用并设置深度偏移 ---
+			// 启用多边形偏移
+			GLState::Enable(GL_POLYGON_OFFSET_FILL);
+			GLState::SetPolygonOffset(4.0f, 10.0f);
+
+			setUniforms();
+			DrawShadowCasterList();
+
+			GLState::Disable(GL_POLYGON_OFFSET_FILL);
+
+			shader->Unbind();
+		}
+
+		void RenderShadowUpdate(Renderer3DData::ShadowUpdateJob &job, uint32_t timerIndex)
+		{
+			Renderer3DData::ShadowTimerQuery *timer = nullptr;
+			if (s_Data.ShadowUpdateBudget > 0.0f && timerIndex < Renderer3DData::MaxShadowLights)
+			{
+				timer = &s_Data.ShadowTimerQueries[s_Data.ShadowTimerFrame][timerIndex];
+				if (timer->Query == 0)
+					glGenQueries(1, &timer->Query);
+				timer->Type = (int)job.Type;
+				glBeginQuery(GL_TIME_ELAPSED, timer->Query);
+			}
+
+			s_Data.ShadowDrawRanges.swap(job.Ranges);
+			switch (job.Type)
+			{
+				case Renderer3DData::ShadowType::Point:
+				{
+					auto &data = s_Data.PointShadows[job.Index];
+					RenderShadowMap(s_Data.PointShadowShader, [&]() { data.Shadow->Bind(); },
+									[&]() { s_Data.PointShadowShader->SetInt("u_Slot", data.Slot); });
+					break;
+				}
+				case Renderer3DData::ShadowType::Directional:
+				{
+					auto &data = s_Data.DirectionalShadows[job.Index];
+					RenderShadowMap(s_Data.DirectionalShadowShader, [&]() { s_Data.ShadowAtlas->Bind(job.State->AtlasRects, ShadowCascadeCount); },
+									[&]() { s_Data.DirectionalShadowShader->SetMat4Array("u_CascadeMatrices", data.CascadeMatrices, ShadowCascadeCount); });
+					std::copy(data.CascadeMatrices, data.CascadeMatrices + ShadowCascadeCount, job.State->LightSpaceMatrices);
+					break;
+				}
+				case Renderer3DData::ShadowType::Spot:
+				{
+					auto &data = s_Data.SpotShadows[job.Index];
+					RenderShadowMap(s_Data.SpotShadowShader, [&]() { s_Data.ShadowAtlas->Bind(job.State->AtlasRects, 1); },
+									[&]() { s_Data.SpotShadowShader->SetMat4("u_LightSpaceMatrix", data.LightSpaceMatrix); });
+					job.State->LightSpaceMatrices[0] = data.LightSpaceMatrix;
+					break;
+				}
+				default:
+					break;
+			}
+
+			if (timer)
+				glEndQuery(GL_TIME_ELAPSED);
+
+			job.State->ContentHash = job.ContentHash;
+			job.State->StaleFrames = 0;
+			job.State->Rendered = true;
+			s_Data.Stats.ShadowMapsRendered++;
+		}
+
+		// 推迟的贴图沿用上次的结果，方向光与聚光灯采样时换回渲染它时的光空间矩阵
+		// 点光源的立方体贴图按光源位置存储距离，光源移动时阴影会滞后到重新渲染为止
+		void DeferShadowUpdate(Renderer3DData::ShadowUpdateJob &job)
+		{
+			switch (job.Type)
+			{
+				case Renderer3DData::ShadowType::Directional:
+				{
+					auto &light = s_Data.DirectionalLights[s_Data.DirectionalShadows[job.Index].LightIndex];
+					std::copy(job.State->LightSpaceMatrices, job.State->LightSpaceMatrices + ShadowCascadeCount, light.CascadeMatrices);
+					break;
+				}
+				case Renderer3DData::ShadowType::Spot:
+					s_Data.SpotLights[s_Data.SpotShadows[job.Index].LightIndex].LightSpaceMatrix = job.State->LightSpaceMatrices[0];
+					break;
+				default:
+					break;
+			}
+
+			job.State->StaleFrames++;
+			s_Data.Stats.ShadowMapsDeferred++;
+		}
+
+		// 按优先级渲染排队的阴影贴图，直到用完数量或时间预算
+		// 从未渲染过的贴图不受预算限制；每帧至少渲染一张，保证轮转能推进
+		void FlushShadowUpdates()
+		{
+			auto &jobs = s_Data.ShadowUpdateJobs;
+			std::sort(jobs.begin(), jobs.begin() + s_Data.ShadowUpdateJobCount, [](const auto &a, const auto &b) {
+				return a.Priority > b.Priority;
+			});
+
+			uint32_t rendered = 0;
+			float estimatedTime = 0.0f;
+			for (uint32_t i = 0; i < s_Data.ShadowUpdateJobCount; i++)
+			{
+				auto &job = jobs[i];
+				float cost = s_Data.ShadowMapCost[(int)job.Type];
+
+				bool required = job.Priority == std::numeric_limits<float>::infinity();
+				bool overBudget = (s_Data.MaxShadowUpdates != 0 && rendered >= s_Data.MaxShadowUpdates) ||
+								  (s_Data.ShadowUpdateBudget > 0.0f && rendered > 0 && estimatedTime + cost > s_Data.ShadowUpdateBudget);
+				if (overBudget && !required)
+				{
+					DeferShadowUpdate(job);
+					continue;
+				}
+
+				RenderShadowUpdate(job, rendered);
+				estimatedTime += cost;
+				rendered++;
+			}
+
+			s_Data.ShadowUpdateJobCount = 0;
+			s_Data.ShadowTimerFrame = (s_Data.ShadowTimerFrame + 1) % Renderer3DData::ShadowTimerFrames;
+		}
+
+		void AddShadowCullStats(char lightType, uint32_t culled)
+		{
+			auto &stats = s_Data.Stats;
+			stats.ShadowCasters = s_Data.ShadowInstanceCount;
+			if (stats.ShadowLightCount < Renderer3D::Statistics::MaxShadowLights)
+			{
+				stats.ShadowLightTypes[stats.ShadowLightCount] = lightType;
+				stats.ShadowCastersCulled[stats.ShadowLightCount] = culled;
+				stats.ShadowLightCount++;
+			}
+		}
+
+		// 本帧没有实例的批次直接回收，其余只清空实例
+		void EndShadowCasters()
+		{
+			if (s_Data.ShadowInstanceCount > 0)
+			{
+				s_Data.ShadowInstanceRing->EndFrame();
+				s_Data.ShadowVisibleRing->EndFrame();
+			}
+
+			for (auto it = s_Data.ShadowCasterBatches.begin(); it != s_Data.ShadowCasterBatches.end();)
+			{
+				if (it->second.Instances.empty())
+				{
+					it = s_Data.ShadowCasterBatches.erase(it);
+				}
+				else
+				{
+					it->second.Instances.clear();
+					it->second.Bounds.clear();
+					++it;
+				}
+			}
+		}
+
+		// 可见列表需要覆盖模型实例区域和所有球体，两次分配各自对齐，预留少量余量
+		uint32_t GetVisibleInstanceRingSize()
+		{
+			uint32_t modelInstances = s_Data.ModelInstanceRing->GetFrameSize() / sizeof(MeshInstanceData);
+			return (modelInstances + s_Data.SphereCapacity) * sizeof(uint32_t) + 1024;
+		}
+
+		uint32_t GetCullCommandRingSize()
+		{
+			uint32_t sphereCullCommands = s_Data.SphereCapacity / Renderer3DData::SphereInstancesPerCullGroup + 1;
+			return (Renderer3DData::MaxDrawCommands + sphereCullCommands) * (uint32_t)sizeof(CullCommandData) + 1024;
+		}
+
+		// 实例缓冲区在帧中途扩大后，剔除用的环形缓冲区在 Flush 分配之前随之扩大 (本帧尚未使用，直接重建)
+		void EnsureCullingRings()
+		{
+			if (s_Data.VisibleInstanceRing->GetFrameSize() < GetVisibleInstanceRingSize())
+			{
+				s_Data.VisibleInstanceRing = ShaderStorageRingBuffer::Create(GetVisibleInstanceRingSize());
+				s_Data.VisibleInstanceRing->BeginFrame();
+			}
+			if (s_Data.CullCommandRing->GetFrameSize() < GetCullCommandRingSize())
+			{
+				s_Data.CullCommandRing = ShaderStorageRingBuffer::Create(GetCullCommandRingSize());
+				s_Data.CullCommandRing->BeginFrame();
+			}
+		}
+
+
+		// CPU 参考实现，与 Renderer3D_Cull.glsl 中的 IsVisible 保持一致
+		bool IsInstanceVisible(const glm::mat4 &transform, const glm::vec4 &boundingSphere)
+		{
+			glm::vec3 center = glm::vec3(transform * glm::vec4(glm::vec3(boundingSphere), 1.0f));
+			float scale = glm::max(glm::max(glm::length(glm::vec3(transform[0])), glm::length(glm::vec3(transform[1]))), glm::length(glm::vec3(transform[2])));
+			float radius = boundingSphere.w * scale;
+
+			for (const auto &plane : s_Data.Frustum.Planes)
+			{
+				if (glm::dot(glm::vec3(plane), center) + plane.w < -radius)
+					return false;
+			}
+			return true;
+		}
+
+		// GPU 剔除: 每条剔除命令一个工作组，可见实例数通过 atomicAdd 写入间接绘制命令
+		void DispatchCulling(uint32_t cullOffset, uint32_t cullCount,
+							 uint32_t commandOffset, uint32_t commandCount,
+							 uint32_t visibleOffset, uint32_t visibleCount,
+							 const Ref<ShaderStorageRingBuffer> &instanceRing, uint32_t instanceOffset, uint32_t instanceSize,
+							 uint32_t instanceStride, int skinnedOffsetIndex)
+		{
+			s_Data.CullShader->Bind();
+
+			s_Data.CullShader->SetFloat4Array("u_FrustumPlanes", s_Data.Frustum.Planes, 6);
+			s_Data.CullShader->SetInt("u_InstanceStride", instanceStride / sizeof(glm::vec4));
+			s_Data.CullShader->SetInt("u_SkinnedOffsetIndex", skinnedOffsetIndex);
+
+			s_Data.VisibleInstanceRing->BindRange(6, visibleOffset, visibleCount * sizeof(uint32_t));
+			s_Data.DrawCommandRing->BindRange(7, commandOffset, commandCount * sizeof(DrawElementsIndirectCommand));
+			s_Data.CullCommandRing->BindRange(8, cullOffset, cullCount * sizeof(CullCommandData));
+			instanceRing->BindRange(9, instanceOffset, instanceSize);
+
+			glDispatchCompute(cullCount, 1, 1);
+
+			// 之后的绘制会读取可见列表和间接绘制命令
+			glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_COMMAND_BARRIER_BIT);
+
+			s_Data.CullShader->Unbind();
+		}
+
+		// 读取 ForwardQueryFrames 帧前的前向渲染查询，本帧的 Flush 复用这些查询对象
+		void ReadForwardQueries()
+		{
+			uint32_t frame = s_Data.FrameIndex % Renderer3DData::ForwardQueryFrames;
+			auto &queries = s_Data.ForwardQueries[frame];
+
+			uint64_t prepassTime = 0, mainTime = 0, samples = 0;
+			uint32_t pixels = 0;
+			bool available = s_Data.ForwardQueryCount[frame] > 0;
+			for (uint32_t i = 0; i < s_Data.ForwardQueryCount[frame] && available; i++)
+			{
+				auto &query = queries[i];
+
+				GLuint ready = 0;
+				glGetQueryObjectuiv(query.SamplesPassed, GL_QUERY_RESULT_AVAILABLE, &ready);
+				if (!ready)
+				{
+					available = false;
+					break;
+				}
+
+				GLuint64 value = 0;
+				glGetQueryObjectui64v(query.MainTimer, GL_QUERY_RESULT, &value);
+				mainTime += value;
+				glGetQueryObjectui64v(query.SamplesPassed, GL_QUERY_RESULT, &value);
+				samples += value;
+				if (query.Prepass)
+				{
+					glGetQueryObjectui64v(query.PrepassTimer, GL_QUERY_RESULT, &value);
+					prepassTime += value;
+				}
+				pixels = std::max(pixels, query.Pixels);
+			}
+
+			if (available)
+			{
+				s_Data.DepthPrepassTime = (float)prepassTime * 1e-6f;
+				s_Data.ForwardPassTime = (float)mainTime * 1e-6f;
+				s_Data.Overdraw = pixels > 0 ? (float)samples / (float)pixels : 0.0f;
+			}
+			s_Data.ForwardQueryCount[frame] = 0;
+
+			s_Data.Stats.DepthPrepassTime = s_Data.DepthPrepassTime;
+			s_Data.Stats.ForwardPassTime = s_Data.ForwardPassTime;
+			s_Data.Stats.Overdraw = s_Data.Overdraw;
+		}
+
+		Renderer3DData::ForwardPassQuery &AcquireForwardQuery()
+		{
+			uint32_t frame = s_Data.FrameIndex % Renderer3DData::ForwardQueryFrames;
+			auto &queries = s_Data.ForwardQueries[frame];
+			if (s_Data.ForwardQueryCount[frame] == queries.size())
+			{
+				Renderer3DData::ForwardPassQuery query;
+				glGenQueries(1, &query.PrepassTimer);
+				glGenQueries(1, &query.MainTimer);
+				glGenQueries(1, &query.SamplesPassed);
+				queries.push_back(query);
+			}
+
+			int32_t viewport[4];
+			GLState::GetViewport(viewport);
+
+			auto &query = queries[s_Data.ForwardQueryCount[frame]++];
+			query.Pixels = (uint32_t)(viewport[2] * viewport[3]);
+			query.Prepass = false;
+			return query;
+		}
+
+		// 切换到 G-buffer，目标的深度先复制过来，之前批次绘制的物体仍然参与深度测试
+		Renderer3DData::DeferredTarget BeginGBuffer()
+		{
+			Renderer3DData::DeferredTarget target;
+			target.Framebuffer = GLState::GetFramebuffer();
+			GLState::GetViewport(target.Viewport);
+			target.Blend = GLState::IsEnabled(GL_BLEND);
+
+			uint32_t width = (uint32_t)target.Viewport[2];
+			uint32_t height = (uint32_t)target.Viewport[3];
+			if (!s_Data.GBuffer)
+			{
+				FramebufferSpecification spec;
+				spec.Width = width;
+				spec.Height = height;
+				spec.Attachments = {FramebufferTextureFormat::RGBA16F, FramebufferTextureFormat::RGBA16F, FramebufferTextureFormat::RGBA8,
+									FramebufferTextureFormat::RGBA16F, FramebufferTextureFormat::RED_INTEGER, FramebufferTextureFormat::DEPTH24STENCIL8};
+				s_Data.GBuffer = Framebuffer::Create(spec);
+			}
+			else if (s_Data.GBuffer->GetSpecification().Width != width || s_Data.GBuffer->GetSpecification().Height != height)
+			{
+				s_Data.GBuffer->Resize(width, height);
+			}
+
+			const int32_t *viewport = target.Viewport;
+			glBlitNamedFramebuffer(target.Framebuffer, s_Data.GBuffer->GetRendererID(),
+								   viewport[0], viewport[1], viewport[0] + viewport[2], viewport[1] + viewport[3],
+								   0, 0, viewport[2], viewport[3], GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+
+			s_Data.GBuffer->Bind();
+			// 材质附件清零即表示该像素没有被本批次写入
+			static const float clearColor[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+			for (uint32_t i = 0; i < Renderer3DData::GBufferColorAttachments - 1; i++)
+				glClearBufferfv(GL_COLOR, i, clearColor);
+			s_Data.GBuffer->ClearAttachment(Renderer3DData::GBufferColorAttachments - 1, -1);
+
+			// 法线与材质附件的 alpha 通道保存的是数据，不能混合
+			GLState::Disable(GL_BLEND);
+			return target;
+		}
+
+		// 全屏光照通道写回原来的目标，之后把深度复制回去，供叠加层等后续绘制使用
+		void ResolveDeferredLighting(const Renderer3DData::DeferredTarget &target)
+		{
+			const int32_t *viewport = target.Viewport;
+			GLState::BindFramebuffer(target.Framebuffer);
+			GLState::SetViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+			GLState::SetEnabled(GL_BLEND, target.Blend);
+
+			for (uint32_t i = 0; i < Renderer3DData::GBufferColorAttachments; i++)
+				GLState::BindTextureUnit(s_Data.GBufferTextureStart + i, s_Data.GBuffer->GetColorAttachmentRendererID(i));
+			GLState::BindTextureUnit(s_Data.GBufferTextureStart + Renderer3DData::GBufferColorAttachments, s_Data.GBuffer->GetDepthAttachmentRendererID());
+
+			bool depthTest = GLState::IsEnabled(GL_DEPTH_TEST);
+			GLState::Disable(GL_DEPTH_TEST);
+
+			s_Data.DeferredLightingShader->Bind();
+			s_Data.DeferredLightingShader->SetMat4("u_InverseViewProjection", glm::inverse(s_Data.CameraBuffer.ViewProjection));
+			s_Data.DeferredLightingShader->SetFloat2("u_GBufferOffset", glm::vec2(viewport[0], viewport[1]));
+
+			s_Data.FullscreenVertexArray->Bind();
+			glDrawArrays(GL_TRIANGLES, 0, 3);
+			s_Data.FullscreenVertexArray->UnBind();
+
+			s_Data.DeferredLightingShader->Unbind();
+
+			GLState::SetEnabled(GL_DEPTH_TEST, depthTest);
+
+			glBlitNamedFramebuffer(s_Data.GBuffer->GetRendererID(), target.Framebuffer,
+								   0, 0, viewport[2], viewport[3],
+								   viewport[0], viewport[1], viewport[0] + viewport[2], viewport[1] + viewport[3], GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+		}
+
+		// 回收长时间未使用的批次
+		void TrimModelBatches()
+		{
+			for (auto it = s_Data.ModelDrawCallBatches.begin(); it != s_Data.ModelDrawCallBatches.end();)
+			{
+				if (s_Data.FrameIndex - it->second.LastUsedFrame > Renderer3DData::ModelBatchTrimFrames)
+					it = s_Data.ModelDrawCallBatches.erase(it);
+				else
+					++it;
+			}
+		}
+	}
+
+	void Renderer3D::InitSphereGeometry()
+	{
+		// buffer
+		const unsigned int X_SEGMENTS = 64;
+		const unsigned int Y_SEGMENTS = 64;
+		const float PI = 3.14159265359f;
+
+		uint32_t SphereVertexCount = (X_SEGMENTS + 1) * (Y_SEGMENTS + 1);
+		std::vector<glm::vec3> Sphere_Positions;
 		std::vector<glm::vec2> Sphere_TexCoord;
 		std::vector<glm::vec3> Sphere_Normals;
 
@@ -729,6 +2339,20 @@ namespace Mc
 
 		s_Data.SpotShadowShader = Shader::Create("Assets/shaders/shadow/Renderer3DSpotShadowDepthShader.glsl");
 
+		s_Data.CullShader = Shader::Create("Assets/shaders/Renderer3D_Cull.glsl");
+
+		s_Data.SkinningShader = Shader::Create("Assets/shaders/Renderer3D_Skinning.glsl");
+
+		s_Data.DepthPrepassShader = Shader::Create("Assets/shaders/Renderer3D_DepthPrepass.glsl");
+
+		s_Data.SphereGBufferShader = Shader::Create("Assets/shaders/Renderer3D_Sphere.glsl", {"DEFERRED_GBUFFER"});
+		s_Data.ModelGBufferShader = Shader::Create("Assets/shaders/Renderer3D_Model.glsl", {"DEFERRED_GBUFFER"});
+		s_Data.DeferredLightingShader = Shader::Create("Assets/shaders/Renderer3D_Model.glsl", {"DEFERRED_LIGHTING"});
+		s_Data.FullscreenVertexArray = VertexArray::Create();
+
+		// 前向、G-buffer 与延迟光照着色器使用同一组纹理单元
+		const Ref<Shader> surfaceShaders[] = {s_Data.SphereShader, s_Data.ModelShader, s_Data.SphereGBufferShader, s_Data.ModelGBufferShader, s_Data.DeferredLightingShader};
+
 		// Texture
 		// -----------------------------------------------------------------
 
@@ -736,67 +2360,74 @@ namespace Mc
 		for (uint32_t i = 0; i < s_Data.MaxTextureSlots; i++)
 			samplers[i] = i;
 
-		s_Data.SphereShader->Bind();
-		s_Data.SphereShader->SetIntArray("u_Textures", samplers, s_Data.MaxTextureSlots);
-		s_Data.SphereShader->Unbind();
-
-		s_Data.ModelShader->Bind();
-		s_Data.ModelShader->SetIntArray("u_Textures", samplers, s_Data.MaxTextureSlots);
-		s_Data.ModelShader->Unbind();
+		for (auto &shader : surfaceShaders)
+		{
+			shader->Bind();
+			shader->SetIntArray("u_Textures", samplers, s_Data.MaxTextureSlots);
+			shader->Unbind();
+		}
 
 		s_Data.WhiteTexture = Texture2D::Create(1, 1);
 		uint32_t whiteTextureData = 0xffffffff;
 		s_Data.WhiteTexture->SetData(&whiteTextureData, sizeof(uint32_t));
 		s_Data.TextureSlots[0] = s_Data.WhiteTexture;
 
+		// 全局纹理表，下标 0 为白色纹理
+		s_Data.RegisteredTextures.push_back(s_Data.WhiteTexture);
+		s_Data.RegisteredTextureIndices[s_Data.WhiteTexture->GetRendererID()] = 0;
+		s_Data.TextureSlotMap.push_back(0);
+
+		s_Data.TextureSlotMapCapacity = Renderer3DData::InitialTextureCapacity * sizeof(int);
+		s_Data.TextureSlotMapSSBO = ShaderStorageBuffer::Create(s_Data.TextureSlotMapCapacity);
+
+		// Bindless Texture
+		s_Data.BindlessTextureCapacity = Renderer3DData::InitialTextureCapacity * sizeof(uint64_t);
+		s_Data.BindlessTextureSSBO = ShaderStorageBuffer::Create(s_Data.BindlessTextureCapacity);
+		SetBindlessTextures(BindlessTexture::IsSupported());
+
+		// Material
+		s_Data.MaterialCapacity = Renderer3DData::InitialMaterialCapacity * sizeof(MaterialData);
+		s_Data.MaterialSSBO = ShaderStorageBuffer::Create(s_Data.MaterialCapacity);
+
 		// Point Shadow Texture
 		int32_t shadow_offset = 35;
 
 		s_Data.PointShadowTextureStart = shadow_offset;
 
-		int32_t samplerPointShadows[s_Data.MAX_POINT_LIGHTS];
-		for (uint32_t i = 0; i < s_Data.MAX_POINT_LIGHTS; i++)
+		int32_t samplerPointShadows[s_Data.MAX_POINT_SHADOWS];
+		for (uint32_t i = 0; i < s_Data.MAX_POINT_SHADOWS; i++)
 			samplerPointShadows[i] = shadow_offset++;
 
-		s_Data.SphereShader->Bind();
-		s_Data.SphereShader->SetIntArray("u_PointShadowDepthMaps", samplerPointShadows, s_Data.MAX_POINT_LIGHTS);
-		s_Data.SphereShader->Unbind();
-
-		s_Data.ModelShader->Bind();
-		s_Data.ModelShader->SetIntArray("u_PointShadowDepthMaps", samplerPointShadows, s_Data.MAX_POINT_LIGHTS);
-		s_Data.ModelShader->Unbind();
-
-		s_Data.DirectionalShadowTextureStart = shadow_offset;
-
-		int32_t samplerDirectionalShadows[s_Data.MAX_DIRECTIONAL_LIGHTS];
-		for (uint32_t i = 0; i < s_Data.MAX_DIRECTIONAL_LIGHTS; i++)
+		for (auto &shader : surfaceShaders)
 		{
-			samplerDirectionalShadows[i] = shadow_offset++;
+			shader->Bind();
+			shader->SetIntArray("u_PointShadowDepthMaps", samplerPointShadows, s_Data.MAX_POINT_SHADOWS);
+			shader->Unbind();
 		}
 
-		s_Data.SphereShader->Bind();
-		s_Data.SphereShader->SetIntArray("u_DirectionalShadowMaps", samplerDirectionalShadows, s_Data.MAX_DIRECTIONAL_LIGHTS);
-		s_Data.SphereShader->Unbind();
-
-		s_Data.ModelShader->Bind();
-		s_Data.ModelShader->SetIntArray("u_DirectionalShadowMaps", samplerDirectionalShadows, s_Data.MAX_DIRECTIONAL_LIGHTS);
-		s_Data.ModelShader->Unbind();
+		// Shadow Atlas
+		s_Data.ShadowAtlas = ShadowAtlas::Create(Renderer3DData::ShadowAtlasSize);
+		s_Data.ShadowAtlasTextureSlot = shadow_offset++;
 
-		s_Data.SpotShadowTextureStart = shadow_offset;
-
-		int32_t samplerSpotShadows[s_Data.MAX_SPOT_LIGHTS];
-		for (uint32_t i = 0; i < s_Data.MAX_SPOT_LIGHTS; i++)
+		for (auto &shader : surfaceShaders)
 		{
-			samplerSpotShadows[i] = shadow_offset++;
+			shader->Bind();
+			shader->SetInt("u_ShadowAtlas", s_Data.ShadowAtlasTextureSlot);
+			shader->Unbind();
 		}
 
-		s_Data.SphereShader->Bind();
-		s_Data.SphereShader->SetIntArray("u_SpotShadowMaps", samplerSpotShadows, s_Data.MAX_SPOT_LIGHTS);
-		s_Data.SphereShader->Unbind();
+		// G-buffer
+		s_Data.GBufferTextureStart = shadow_offset;
+		shadow_offset += Renderer3DData::GBufferColorAttachments + 1;
 
-		s_Data.ModelShader->Bind();
-		s_Data.ModelShader->SetIntArray("u_SpotShadowMaps", samplerSpotShadows, s_Data.MAX_SPOT_LIGHTS);
-		s_Data.ModelShader->Unbind();
+		s_Data.DeferredLightingShader->Bind();
+		s_Data.DeferredLightingShader->SetInt("u_GBufferAlbedo", s_Data.GBufferTextureStart + 0);
+		s_Data.DeferredLightingShader->SetInt("u_GBufferNormal", s_Data.GBufferTextureStart + 1);
+		s_Data.DeferredLightingShader->SetInt("u_GBufferMaterial", s_Data.GBufferTextureStart + 2);
+		s_Data.DeferredLightingShader->SetInt("u_GBufferEmissive", s_Data.GBufferTextureStart + 3);
+		s_Data.DeferredLightingShader->SetInt("u_GBufferEntityID", s_Data.GBufferTextureStart + 4);
+		s_Data.DeferredLightingShader->SetInt("u_GBufferDepth", s_Data.GBufferTextureStart + Renderer3DData::GBufferColorAttachments);
+		s_Data.DeferredLightingShader->Unbind();
 
 		// Add Material 0
 		MaterialManager::Get().AddMaterial();
@@ -806,18 +2437,54 @@ namespace Mc
 		InitSphereGeometry();
 
 		// -----------------------------------------------------------------
-		// Sphere Instance SSBO
-		s_Data.SphereInstanceSSBO = ShaderStorageBuffer::Create(Renderer3DData::MaxSphereCount * sizeof(SphereInstanceData));
+		// Sphere / Model Instance Ring Buffer
+		s_Data.SphereInstanceRing = ShaderStorageRingBuffer::Create(s_Data.SphereCapacity * sizeof(SphereInstanceData));
+		s_Data.ModelInstanceRing = ShaderStorageRingBuffer::Create(s_Data.ModelInstanceRingSize);
+		s_Data.DrawCommandRing = ShaderStorageRingBuffer::Create(Renderer3DData::MaxDrawCommands * sizeof(DrawElementsIndirectCommand));
+
+		// -----------------------------------------------------------------
+		// Culling Ring Buffer
+		s_Data.CullCommandRing = ShaderStorageRingBuffer::Create(Utils::GetCullCommandRingSize());
+		s_Data.VisibleInstanceRing = ShaderStorageRingBuffer::Create(Utils::GetVisibleInstanceRingSize());
+
+		// -----------------------------------------------------------------
+		// Bone Palette Ring Buffer
+		s_Data.BonePaletteRing = ShaderStorageRingBuffer::Create(Renderer3DData::MaxBonePalettes * MAX_BONES * sizeof(glm::mat4));
+
+		// -----------------------------------------------------------------
+		// GPU Skinning
+		s_Data.SkinnedVertexCapacity = 64 * 1024 * sizeof(SkinnedVertex);
+		s_Data.SkinnedVertexSSBO = ShaderStorageBuffer::Create(s_Data.SkinnedVertexCapacity);
+		s_Data.SkinningJobCapacity = Renderer3DData::MaxBonePalettes * sizeof(SkinningJobData);
+		s_Data.SkinningJobSSBO = ShaderStorageBuffer::Create(s_Data.SkinningJobCapacity);
+
+		// -----------------------------------------------------------------
+		// Shadow Caster Ring Buffer
+		s_Data.ShadowInstanceRing = ShaderStorageRingBuffer::Create(s_Data.ShadowInstanceCapacity * sizeof(ShadowInstanceData));
+		s_Data.ShadowVisibleRing = ShaderStorageRingBuffer::Create(Utils::GetShadowVisibleRingSize());
 
 		// -----------------------------------------------------------------
 		// Light Instance SSBO
 		s_Data.LightInstanceSSBO = ShaderStorageBuffer::Create(sizeof(LightData));
 
+		// -----------------------------------------------------------------
+		// Clustered Light SSBO
+		s_Data.PointLightCapacity = Renderer3DData::InitialLightCapacity * sizeof(StoredPointLight);
+		s_Data.PointLightSSBO = ShaderStorageBuffer::Create(s_Data.PointLightCapacity);
+		s_Data.SpotLightCapacity = Renderer3DData::InitialLightCapacity * sizeof(StoredSpotLight);
+		s_Data.SpotLightSSBO = ShaderStorageBuffer::Create(s_Data.SpotLightCapacity);
+		s_Data.ClusterCapacity = Math::LightClusterGrid::ClusterCount * sizeof(Math::LightClusterGrid::Cluster);
+		s_Data.ClusterSSBO = ShaderStorageBuffer::Create(s_Data.ClusterCapacity);
+		s_Data.ClusterIndexCapacity = Renderer3DData::InitialLightCapacity * 64 * sizeof(uint32_t);
+		s_Data.ClusterIndexSSBO = ShaderStorageBuffer::Create(s_Data.ClusterIndexCapacity);
+
 		// -----------------------------------------------------------------
 		// Point Shadow Instance SSBO
-		s_Data.PointShadowInstanceSSBO = ShaderStorageBuffer::Create(Renderer3DData::MAX_SPOT_LIGHTS * sizeof(Renderer3DData::StoredPointShadowGPU));
+		s_Data.PointShadowInstanceSSBO = ShaderStorageBuffer::Create(Renderer3DData::MAX_POINT_SHADOWS * sizeof(Renderer3DData::StoredPointShadowGPU));
 
-		// s_Data.CameraUniformBuffer = UniformBuffer::Create(sizeof(Renderer3DData::CameraData), 0);
+		// -----------------------------------------------------------------
+		// Camera Uniform Buffer
+		s_Data.CameraUniformBuffer = UniformBuffer::Create(sizeof(Renderer3DData::CameraData), 0);
 
 		// -----------------------------------------------------------------
 		// Hdr
@@ -826,6 +2493,8 @@ namespace Mc
 
 	void Renderer3D::Shutdown()
 	{
+		// 工作线程在静态对象析构之前结束
+		s_Data.Skinner.reset();
 	}
 
 	void Renderer3D::BeginScene(const EditorCamera &camera)
@@ -834,9 +2503,13 @@ namespace Mc
 		s_Data.CameraBuffer.View = camera.GetViewMatrix();
 		s_Data.CameraBuffer.ViewProjection = camera.GetViewProjection();
 		s_Data.CameraBuffer.CameraPosition = camera.GetPosition();
-		// s_Data.CameraUniformBuffer->SetData(&s_Data.CameraBuffer, sizeof(Renderer3DData::CameraData));
+		Utils::BindCamera();
 
+		Utils::BeginBonePalettes();
+		Utils::BeginSkinning();
 		StartBatch();
+
+		s_Data.SubmitTimer.Reset();
 	}
 
 	void Renderer3D::BeginScene(const OrthographicCamera &camera)
@@ -845,9 +2518,13 @@ namespace Mc
 		s_Data.CameraBuffer.View = camera.GetViewMatrix();
 		s_Data.CameraBuffer.ViewProjection = camera.GetViewProjectionMatrix();
 		s_Data.CameraBuffer.CameraPosition = camera.GetPosition();
-		// s_Data.CameraUniformBuffer->SetData(&s_Data.CameraBuffer, sizeof(Renderer3DData::CameraData));
+		Utils::BindCamera();
 
+		Utils::BeginBonePalettes();
+		Utils::BeginSkinning();
 		StartBatch();
+
+		s_Data.SubmitTimer.Reset();
 	}
 
 	void Renderer3D::BeginScene(const Camera &camera, const glm::mat4 &transform)
@@ -856,20 +2533,83 @@ namespace Mc
 		s_Data.CameraBuffer.View = glm::inverse(transform);
 		s_Data.CameraBuffer.ViewProjection = camera.GetProjection() * glm::inverse(transform);
 		s_Data.CameraBuffer.CameraPosition = glm::vec3(transform[3]);
-		// s_Data.CameraUniformBuffer->SetData(&s_Data.CameraBuffer, sizeof(Renderer3DData::CameraData));
+		Utils::BindCamera();
 
+		Utils::BeginBonePalettes();
+		Utils::BeginSkinning();
 		StartBatch();
+
+		s_Data.SubmitTimer.Reset();
 	}
 
 	void Renderer3D::EndScene()
 	{
+		s_Data.Stats.SubmitTime += s_Data.SubmitTimer.ElapsedMillis();
+
+		Utils::ReadForwardQueries();
+
+		// 各通道声明读写的资源，帧图剔除无用的通道并在通道之间恢复场景的渲染目标
+		auto &graph = s_Data.Graph;
+		graph.Reset();
+		FrameGraph::Resource shadowMaps = graph.Import("ShadowMaps");
+		// 图集中的位置与光源空间矩阵，由阴影通道确定，光源缓冲区上传时使用
+		FrameGraph::Resource shadowMetadata = graph.Import("ShadowMetadata");
+		FrameGraph::Resource lightBuffers = graph.Import("LightBuffers");
+		FrameGraph::Resource sceneColor = graph.Import("SceneColor");
+		FrameGraph::Resource skinnedVertices = graph.Import("SkinnedVertices");
+
+		// 所有动画实例蒙皮一次，阴影与场景通道共用结果
+		graph.AddPass("Skinning", [&](FrameGraph::Builder &builder) {
+			builder.Write(skinnedVertices);
+		}, [](const FrameGraph::Resources &) {
+			Utils::DispatchSkinning();
+		});
+
+		// Shadow
+		graph.AddPass("Shadows", [&](FrameGraph::Builder &builder) {
+			builder.Read(skinnedVertices);
+			builder.Write(shadowMaps);
+			builder.Write(shadowMetadata);
+		}, [](const FrameGraph::Resources &) {
+			Utils::UploadShadowCasters();
+			Utils::BeginShadowUpdates();
+			Utils::AllocateShadowAtlas();
+			Renderer3D::FlushPointShadows();
+			Renderer3D::FlushDirectionalShadows();
+			Renderer3D::FlushSpotShadows();
+			Utils::FlushShadowUpdates();
+			Utils::EndShadowCasters();
+		});
+
 		// Light SSBO
-		Renderer3D::FlushPointShadows();
-		Renderer3D::FlushDirectionalShadows();
-		Renderer3D::FlushSpotShadows();
-		Renderer3D::FlushLights();
+		graph.AddPass("Lights", [&](FrameGraph::Builder &builder) {
+			builder.Read(shadowMetadata);
+			builder.Write(lightBuffers);
+		}, [](const FrameGraph::Resources &) {
+			Renderer3D::FlushLights();
+		});
 
-		Flush();
+		graph.AddPass("Scene", [&](FrameGraph::Builder &builder) {
+			builder.Read(skinnedVertices);
+			builder.Read(shadowMaps);
+			builder.Read(lightBuffers);
+			builder.Write(sceneColor);
+			builder.SideEffect();
+		}, [](const FrameGraph::Resources &) {
+			Flush();
+		});
+
+		graph.Compile();
+		graph.Execute();
+
+		const auto &timings = graph.GetPassTimings();
+		s_Data.Stats.PassCount = std::min((uint32_t)timings.size(), (uint32_t)Statistics::MaxPasses);
+		for (uint32_t i = 0; i < s_Data.Stats.PassCount; i++)
+		{
+			s_Data.Stats.PassNames[i] = timings[i].Name;
+			s_Data.Stats.PassCpuTime[i] = timings[i].Culled ? -1.0f : timings[i].CpuTime;
+			s_Data.Stats.PassGpuTime[i] = timings[i].GpuTime;
+		}
 
 		// clear Light Data
 		s_Data.DirectionalLights.clear();
@@ -881,37 +2621,54 @@ namespace Mc
 		s_Data.PointShadowTextureSlotIndex = 0;
 
 		s_Data.DirectionalShadows.clear();
-		s_Data.DirectionalShadowTextureSlotIndex = 0;
-
 		s_Data.SpotShadows.clear();
-		s_Data.SpotShadowTextureSlotIndex = 0;
 
-		// clear obj tranform data
-		s_Data.ProjectionShadowDatas.clear();
+		s_Data.BonePaletteRing->EndFrame();
+		Utils::EndSkinning();
 
 		// clear hdr
 		s_Data.HdrSkybox->Unbind();
 		s_Data.HdrSkybox.reset();
+
+		Utils::TrimModelBatches();
+		s_Data.FrameIndex++;
 	}
 
 	void Renderer3D::StartBatch()
 	{
+		// 只重置上一批次用到的映射
+		for (uint32_t i = 1; i < s_Data.TextureSlotIndex; ++i)
+			s_Data.TextureSlotMap[s_Data.TextureSlotTextureIndices[i]] = 0;
+		if (s_Data.TextureSlotIndex > 1)
+			s_Data.TextureSlotMapDirty = true;
+
 		s_Data.TextureSlotIndex = 1;
 		for (uint32_t i = 1; i < Renderer3DData::MaxTextureSlots; ++i) // 从 1 开始清空
 		{
 			s_Data.TextureSlots[i] = nullptr;
 		}
 
-		s_Data.SphereCount = 0;
-		s_Data.SphereInstances.clear();
-
-		// 清空所有模型绘制批次
-		for (auto &pair : s_Data.ModelDrawCallBatches)
+		// 材质表只增不减，编辑器中连续调整参数会不断产生新项，过大时在批次开始前重建
+		if (s_Data.Materials.size() > Renderer3DData::MaxMaterials)
 		{
-			// 释放SSBO
-			pair.second.InstanceSSBO->Destroy();
+			s_Data.Materials.clear();
+			s_Data.MaterialIndices.clear();
+			s_Data.MaterialsDirty = true;
 		}
-		s_Data.ModelDrawCallBatches.clear();
+
+		// 等待环形缓冲区的下一个区域可写
+		s_Data.SphereInstanceRing->BeginFrame();
+		s_Data.SphereInstances = (SphereInstanceData *)s_Data.SphereInstanceRing->Allocate(s_Data.SphereCapacity * sizeof(SphereInstanceData), s_Data.SphereInstanceOffset);
+		s_Data.SphereCount = 0;
+		s_Data.SphereTransforms.clear();
+		s_Data.BatchCullingMode = s_Data.CullingMode;
+
+		s_Data.ModelInstanceRing->BeginFrame();
+		s_Data.DrawCommandRing->BeginFrame();
+		s_Data.CullCommandRing->BeginFrame();
+		s_Data.VisibleInstanceRing->BeginFrame();
+
+		// 批次保留在池中，只重置计数 (Flush 时已清空)
 		s_Data.ModelCount = 0;
 	}
 
@@ -927,14 +2684,32 @@ namespace Mc
 		data.NumSpotLights = s_Data.SpotLights.size();
 		data.padding2 = 0;
 
+		Utils::BuildLightClusters();
+		data.ClusterDimensions = glm::uvec4(Math::LightClusterGrid::DimX, Math::LightClusterGrid::DimY, Math::LightClusterGrid::DimZ, 0);
+		data.ClusterDepthParams = glm::vec4(s_Data.LightClusters.GetDepthParams(), 0.0f, 0.0f);
+
 		memcpy(data.DirectionalLights, s_Data.DirectionalLights.data(), s_Data.DirectionalLights.size() * sizeof(StoredDirectionalLight));
-		memcpy(data.PointLights, s_Data.PointLights.data(), s_Data.PointLights.size() * sizeof(StoredPointLight));
-		memcpy(data.SpotLights, s_Data.SpotLights.data(), s_Data.SpotLights.size() * sizeof(StoredSpotLight));
 
 		s_Data.LightInstanceSSBO->Bind();
 		s_Data.LightInstanceSSBO->SetData(&data, sizeof(LightData));
 		s_Data.LightInstanceSSBO->BindBase(1);
 		s_Data.LightInstanceSSBO->UnBind();
+
+		Utils::UploadStorageBuffer(s_Data.PointLightSSBO, s_Data.PointLightCapacity, s_Data.PointLights.data(), (uint32_t)(s_Data.PointLights.size() * sizeof(StoredPointLight)));
+		s_Data.PointLightSSBO->BindBase(15);
+		Utils::UploadStorageBuffer(s_Data.SpotLightSSBO, s_Data.SpotLightCapacity, s_Data.SpotLights.data(), (uint32_t)(s_Data.SpotLights.size() * sizeof(StoredSpotLight)));
+		s_Data.SpotLightSSBO->BindBase(16);
+
+		const auto &clusters = s_Data.LightClusters.GetClusters();
+		const auto &indices = s_Data.LightClusters.GetLightIndices();
+		Utils::UploadStorageBuffer(s_Data.ClusterSSBO, s_Data.ClusterCapacity, clusters.data(), (uint32_t)(clusters.size() * sizeof(Math::LightClusterGrid::Cluster)));
+		s_Data.ClusterSSBO->BindBase(17);
+		Utils::UploadStorageBuffer(s_Data.ClusterIndexSSBO, s_Data.ClusterIndexCapacity, indices.data(), (uint32_t)(indices.size() * sizeof(uint32_t)));
+		s_Data.ClusterIndexSSBO->BindBase(18);
+
+		s_Data.Stats.PointLights = (uint32_t)s_Data.PointLights.size();
+		s_Data.Stats.SpotLights = (uint32_t)s_Data.SpotLights.size();
+		s_Data.Stats.ClusterLightIndices = (uint32_t)indices.size();
 	}
 
     void Renderer3D::FlushPointShadows()
@@ -951,143 +2726,59 @@ namespace Mc
 		s_Data.PointShadowInstanceSSBO->BindBase(4);
 		s_Data.PointShadowInstanceSSBO->UnBind();
 
-		// Bind shadow
+		// 内容变化的贴图加入更新队列，由 Utils::FlushShadowUpdates 按预算渲染
+		for (uint32_t i = 0; i < (uint32_t)s_Data.PointShadows.size(); i++)
 		{
-			for (auto data : s_Data.PointShadows)
-			{
-				// --- 状态保存 ---
-				GLint viewport[4];
-				glGetIntegerv(GL_VIEWPORT, viewport);
-				GLint currentFBO;
-				glGetIntegerv(GL_FRAMEBUFFER_BINDING, &currentFBO);
-				// --- 状态保存结束 ---
-
-				data.Shadow->Bind();
-				s_Data.PointShadowShader->Bind();
-
-				// --- 启用并设置深度偏移 ---
-				// 启用多边形偏移
-				glEnable(GL_POLYGON_OFFSET_FILL);
-				glPolygonOffset(4.0f, 10.0f);
-
-				s_Data.PointShadowShader->SetInt("u_Slot", data.Slot);
-
-				for (auto &mesh : s_Data.ProjectionShadowDatas)
-				{
-					s_Data.PointShadowShader->SetMat4("u_Model", mesh.Transform);
-					for (int i = 0; i < MAX_BONES; i++)
-						s_Data.DirectionalShadowShader->SetMat4("u_FinalBoneMatrices[" + std::to_string(i) + "]", mesh.FinalBoneMatrices[i]);
-					glBindVertexArray(mesh.VertexArrayID);
-					glDrawElements(GL_TRIANGLE_STRIP, mesh.IndexCount, GL_UNSIGNED_INT, 0);
-				}
-
-
-				glDisable(GL_POLYGON_OFFSET_FILL);
+			auto &data = s_Data.PointShadows[i];
+			glm::vec3 lightPosition = glm::vec3(data.GPUData.LightPositionFarPlane);
+			float farPlane = data.GPUData.LightPositionFarPlane.w;
 
-				data.Shadow->Unbind();
-				s_Data.PointShadowShader->Unbind();
+			uint64_t contentHash = 0;
+			uint32_t culled = Utils::BuildShadowCasterList([&](uint32_t index) {
+				return Utils::GetPointShadowFaceMask(s_Data.ShadowCasterBounds[index], lightPosition, farPlane);
+			}, &data.GPUData, sizeof(Renderer3DData::StoredPointShadowGPU), contentHash);
+			Utils::AddShadowCullStats('P', culled);
 
-				// --- 状态恢复 ---
-				glBindFramebuffer(GL_FRAMEBUFFER, currentFBO);
-				glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
-				// --- 状态恢复结束 ---
+			ShadowMapState &state = data.Shadow->GetState();
+			if (!Utils::IsShadowMapCached(state, contentHash))
+				Utils::QueueShadowUpdate(Renderer3DData::ShadowType::Point, i, state, contentHash, Utils::GetShadowScreenInfluence(data.GPUData.LightPositionFarPlane));
 
-				data.Shadow->BindTexture(data.Slot + s_Data.PointShadowTextureStart);
-			}
+			data.Shadow->BindTexture(data.Slot + s_Data.PointShadowTextureStart);
 		}
 	}
 
     void Renderer3D::FlushDirectionalShadows()
     {
-		// Bind shadow
+		// 方向光影响整个画面
+		for (uint32_t i = 0; i < (uint32_t)s_Data.DirectionalShadows.size(); i++)
 		{
-			for (auto data : s_Data.DirectionalShadows)
-			{
-				// --- 状态保存 ---
-				GLint viewport[4];
-				glGetIntegerv(GL_VIEWPORT, viewport);
-				GLint currentFBO;
-				glGetIntegerv(GL_FRAMEBUFFER_BINDING, &currentFBO);
-				// --- 状态保存结束 ---
-
-				data.Shadow->Bind();
-				s_Data.DirectionalShadowShader->Bind();
-
-				// --- 启用并设置深度偏移 ---
-				// 启用多边形偏移
-				glEnable(GL_POLYGON_OFFSET_FILL);
-				glPolygonOffset(4.0f, 10.0f);
-
-				s_Data.DirectionalShadowShader->SetMat4("u_LightSpaceMatrix", data.LightSpaceMatrix);
-
-				for (auto &mesh : s_Data.ProjectionShadowDatas)
-				{
-					s_Data.DirectionalShadowShader->SetMat4("u_Model", mesh.Transform);
-					for (int i = 0; i < MAX_BONES; i++)
-						s_Data.DirectionalShadowShader->SetMat4("u_FinalBoneMatrices[" + std::to_string(i) + "]", mesh.FinalBoneMatrices[i]);
-					glBindVertexArray(mesh.VertexArrayID);
-					glDrawElements(GL_TRIANGLE_STRIP, mesh.IndexCount, GL_UNSIGNED_INT, 0);
-				}
+			auto &data = s_Data.DirectionalShadows[i];
+			if (s_Data.DirectionalLights[data.LightIndex].ShadowMapIndex < 0)
+				continue;
 
-				glDisable(GL_POLYGON_OFFSET_FILL);
+			uint64_t contentHash = 0;
+			Utils::AddShadowCullStats('D', Utils::BuildShadowCasterList(data.CascadeMatrices, ShadowCascadeCount, contentHash));
 
-				data.Shadow->Unbind();
-				s_Data.DirectionalShadowShader->Unbind();
-
-				// --- 状态恢复 ---
-				glBindFramebuffer(GL_FRAMEBUFFER, currentFBO);
-				glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
-				// --- 状态恢复结束 ---
-
-				data.Shadow->BindTexture(data.Slot + s_Data.DirectionalShadowTextureStart);
-			}
+			ShadowMapState &state = data.Shadow->GetState();
+			if (!Utils::IsShadowMapCached(state, contentHash))
+				Utils::QueueShadowUpdate(Renderer3DData::ShadowType::Directional, i, state, contentHash, 1.0f);
 		}
 	}
 
     void Renderer3D::FlushSpotShadows()
     {
-		// Bind shadow
+		for (uint32_t i = 0; i < (uint32_t)s_Data.SpotShadows.size(); i++)
 		{
-			for (auto data : s_Data.SpotShadows)
-			{
-				// --- 状态保存 ---
-				GLint viewport[4];
-				glGetIntegerv(GL_VIEWPORT, viewport);
-				GLint currentFBO;
-				glGetIntegerv(GL_FRAMEBUFFER_BINDING, &currentFBO);
-				// --- 状态保存结束 ---
-
-				data.Shadow->Bind();
-				s_Data.SpotShadowShader->Bind();
-
-				// --- 启用并设置深度偏移 ---
-				// 启用多边形偏移
-				glEnable(GL_POLYGON_OFFSET_FILL);
-				glPolygonOffset(4.0f, 10.0f);
-
-				s_Data.SpotShadowShader->SetMat4("u_LightSpaceMatrix", data.LightSpaceMatrix);
-
-				for (auto &mesh : s_Data.ProjectionShadowDatas)
-				{
-					s_Data.SpotShadowShader->SetMat4("u_Model", mesh.Transform);
-					for (int i = 0; i < MAX_BONES; i++)
-						s_Data.DirectionalShadowShader->SetMat4("u_FinalBoneMatrices[" + std::to_string(i) + "]", mesh.FinalBoneMatrices[i]);
-					glBindVertexArray(mesh.VertexArrayID);
-					glDrawElements(GL_TRIANGLE_STRIP, mesh.IndexCount, GL_UNSIGNED_INT, 0);
-				}
-
-				glDisable(GL_POLYGON_OFFSET_FILL);
-
-				data.Shadow->Unbind();
-				s_Data.SpotShadowShader->Unbind();
+			auto &data = s_Data.SpotShadows[i];
+			if (s_Data.SpotLights[data.LightIndex].ShadowMapIndex < 0)
+				continue;
 
-				// --- 状态恢复 ---
-				glBindFramebuffer(GL_FRAMEBUFFER, currentFBO);
-				glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
-				// --- 状态恢复结束 ---
+			uint64_t contentHash = 0;
+			Utils::AddShadowCullStats('S', Utils::BuildShadowCasterList(&data.LightSpaceMatrix, 1, contentHash));
 
-				data.Shadow->BindTexture(data.Slot + s_Data.SpotShadowTextureStart);
-			}
+			ShadowMapState &state = data.Shadow->GetState();
+			if (!Utils::IsShadowMapCached(state, contentHash))
+				Utils::QueueShadowUpdate(Renderer3DData::ShadowType::Spot, i, state, contentHash, Utils::GetShadowScreenInfluence(data.BoundingSphere));
 		}
 	}
 
@@ -1101,65 +2792,365 @@ namespace Mc
 
 			s_Data.HdrSkybox->Bind(s_Data.SphereShader);
 			s_Data.HdrSkybox->Bind(s_Data.ModelShader);
+			s_Data.HdrSkybox->Bind(s_Data.DeferredLightingShader);
 		}
 
 		// Bind textures
 		for (uint32_t i = 0; i < s_Data.TextureSlotIndex; i++)
 			s_Data.TextureSlots[i]->Bind(i);
 
+		if (s_Data.UseBindlessTextures)
+			Utils::FlushBindlessTextures();
+		else
+			Utils::FlushTextureSlots();
+
+		Utils::FlushMaterials();
+
+		s_Data.Frustum = Math::Frustum::FromViewProjection(s_Data.CameraBuffer.ViewProjection);
+		Utils::EnsureCullingRings();
+		Utils::DispatchSkinning();
+		bool gpuCulling = s_Data.BatchCullingMode == Renderer3D::CullingMode::GPU;
+
+		// 先准备好球体和模型的间接绘制命令，深度预通道与主通道提交同一组命令
+		bool drawSpheres = false;
+		uint32_t sphereCommandOffset = 0;
+		uint32_t sphereVisibleOffset = 0;
+
+		uint32_t modelCommandCount = 0;
+		uint32_t modelCommandOffset = 0;
+		uint32_t modelVisibleOffset = 0;
+		uint32_t modelInstanceBase = 0;
+		uint32_t modelInstanceCapacity = 0;
+
 		// Sphere
 		if (s_Data.SphereCount > 0)
 		{
-			s_Data.SphereShader->Bind();
+			// 实例数据已直接写入映射内存，剔除结果写入间接绘制命令和可见列表
+			uint32_t commandOffset = 0;
+			uint32_t visibleOffset = 0;
+			auto *command = (DrawElementsIndirectCommand *)s_Data.DrawCommandRing->Allocate(sizeof(DrawElementsIndirectCommand), commandOffset);
+			uint32_t *visible = (uint32_t *)s_Data.VisibleInstanceRing->Allocate(s_Data.SphereCount * sizeof(uint32_t), visibleOffset);
+
+			command->Count = s_Data.DefaultSphereMesh->GetIndexCount();
+			command->InstanceCount = 0;
+			command->FirstIndex = 0;
+			command->BaseVertex = 0;
+			command->BaseInstance = 0;
+
+			if (gpuCulling)
+			{
+				// 球体按组拆分，多个工作组写入同一条命令
+				uint32_t cullOffset = 0;
+				uint32_t cullCount = (s_Data.SphereCount + Renderer3DData::SphereInstancesPerCullGroup - 1) / Renderer3DData::SphereInstancesPerCullGroup;
+				auto *cullCommands = (CullCommandData *)s_Data.CullCommandRing->Allocate(cullCount * sizeof(CullCommandData), cullOffset);
 
-			s_Data.SphereShader->SetMat4("u_ViewProjection", s_Data.CameraBuffer.ViewProjection);
+				for (uint32_t i = 0; i < cullCount; i++)
+				{
+					uint32_t firstInstance = i * Renderer3DData::SphereInstancesPerCullGroup;
+					cullCommands[i] = {
+						Renderer3DData::SphereBoundingSphere,
+						firstInstance,
+						std::min(Renderer3DData::SphereInstancesPerCullGroup, s_Data.SphereCount - firstInstance),
+						0,
+						0
+					};
+				}
+
+				Utils::DispatchCulling(cullOffset, cullCount, commandOffset, 1, visibleOffset, s_Data.SphereCount,
+									   s_Data.SphereInstanceRing, s_Data.SphereInstanceOffset, s_Data.SphereCount * sizeof(SphereInstanceData),
+									   sizeof(SphereInstanceData), -1);
+			}
+			else
+			{
+				// 同一条命令内按实例顺序光栅化，可见列表按深度由近到远排列
+				Timer sortTimer;
+				auto &sorter = s_Data.DrawSorter;
+				sorter.Clear();
+				for (uint32_t i = 0; i < s_Data.SphereCount; i++)
+				{
+					const glm::mat4 &transform = s_Data.SphereTransforms[i];
+					if (s_Data.BatchCullingMode == Renderer3D::CullingMode::None || Utils::IsInstanceVisible(transform, Renderer3DData::SphereBoundingSphere))
+						sorter.Add(s_Data.UseDrawSorting ? DrawSortKey::GetDepthBits(Utils::GetViewDepth(glm::vec3(transform[3]))) : 0, i);
+				}
+				sorter.Sort();
 
-			s_Data.SphereInstanceSSBO->Bind();
-			s_Data.SphereInstanceSSBO->SetData(s_Data.SphereInstances.data(), s_Data.SphereCount * sizeof(SphereInstanceData));
-			s_Data.SphereInstanceSSBO->BindBase(2);
-			s_Data.SphereInstanceSSBO->UnBind();
+				uint32_t visibleCount = sorter.GetCount();
+				for (uint32_t i = 0; i < visibleCount; i++)
+					visible[i] = sorter.GetValue(i);
+				s_Data.Stats.DrawSortTime += sortTimer.ElapsedMillis();
 
-			s_Data.DefaultSphereMesh->DrawInstanced(s_Data.SphereShader, s_Data.SphereCount);
+				command->InstanceCount = visibleCount;
+				s_Data.Stats.CulledInstances += s_Data.SphereCount - visibleCount;
+			}
 
-			s_Data.SphereShader->Unbind();
+			drawSpheres = true;
+			sphereCommandOffset = commandOffset;
+			sphereVisibleOffset = visibleOffset;
 		}
 
 		// Model
-		{
-			s_Data.ModelShader->Bind();
+		// 所有网格共用 MeshManager 的 VAO，每个实例块对应一条间接绘制命令，
+		// 整个批次通过一次 glMultiDrawElementsIndirect 提交
+		uint32_t maxCommandCount = 0;
+		for (auto &pair : s_Data.ModelDrawCallBatches)
+			maxCommandCount += (uint32_t)pair.second.Chunks.size();
 
-			s_Data.ModelShader->SetMat4("u_ViewProjection", s_Data.CameraBuffer.ViewProjection);
+		if (maxCommandCount > 0)
+		{
+			uint32_t instanceBase = s_Data.ModelInstanceRing->GetFrameStart();
+			uint32_t instanceCapacity = s_Data.ModelInstanceRing->GetFrameSize() / sizeof(MeshInstanceData);
+
+			// 可见列表与实例区域一一对应，第 i 条命令的可见实例从它的 BaseInstance 开始写入
+			uint32_t commandOffset = 0;
+			uint32_t visibleOffset = 0;
+			uint32_t cullOffset = 0;
+			auto *commands = (DrawElementsIndirectCommand *)s_Data.DrawCommandRing->Allocate(maxCommandCount * sizeof(DrawElementsIndirectCommand), commandOffset);
+			uint32_t *visible = (uint32_t *)s_Data.VisibleInstanceRing->Allocate(instanceCapacity * sizeof(uint32_t), visibleOffset);
+			CullCommandData *cullCommands = gpuCulling ? (CullCommandData *)s_Data.CullCommandRing->Allocate(maxCommandCount * sizeof(CullCommandData), cullOffset) : nullptr;
+
+			if (commands == nullptr || visible == nullptr || (gpuCulling && cullCommands == nullptr))
+			{
+				LOG_CORE_ERROR("Renderer3D: draw command buffers are full, model batch skipped!");
+				maxCommandCount = 0;
+			}
 
-			// 遍历所有收集到的绘制批次
+			// 每个实例块生成一个排序键，按键的顺序写入间接绘制命令
+			Timer sortTimer;
+			auto &sorter = s_Data.DrawSorter;
+			auto &items = s_Data.ModelDrawItems;
+			sorter.Clear();
+			items.clear();
 			for (auto &pair : s_Data.ModelDrawCallBatches)
 			{
 				Renderer3DData::ModelCallKey key = pair.first;
 				Renderer3DData::ModelCallBatch &batch = pair.second;
 
-				if (batch.InstanceCount > 0)
+				if (maxCommandCount == 0 || batch.InstanceCount == 0)
+					continue;
+
+				Ref<Mesh> mesh = MeshManager::Get().GetMeshByID(key.MeshID);
+				if (!mesh)
+					continue;
+
+				for (auto &chunk : batch.Chunks)
+				{
+					// 以块内最近的实例作为块的深度
+					uint64_t sortKey = 0;
+					if (s_Data.UseDrawSorting)
+					{
+						uint32_t variant = chunk.Skinned ? DrawSortKey::VariantSkinned : DrawSortKey::VariantStatic;
+						sortKey = DrawSortKey::Make(DrawSortKey::PassOpaque, variant, chunk.NearestDepth, key.MeshID);
+					}
+
+					sorter.Add(sortKey, (uint32_t)items.size());
+					items.push_back({ &batch, &chunk, mesh });
+				}
+
+				s_Data.Stats.MeshCount++;
+			}
+			sorter.Sort();
+			s_Data.Stats.SortedDraws += sorter.GetCount();
+
+			// 排序后相邻的两块网格相同、实例在缓冲区中首尾相连时合并为一条命令
+			uint32_t commandCount = 0;
+			uint32_t cullCount = 0;
+			const Mesh *previousMesh = nullptr;
+			uint32_t previousEnd = 0;
+			for (uint32_t index = 0; index < sorter.GetCount(); index++)
+			{
+				const Renderer3DData::ModelDrawItem &item = items[sorter.GetValue(index)];
+				const Renderer3DData::ModelInstanceChunk &chunk = *item.Chunk;
+				const Ref<Mesh> &mesh = item.ChunkMesh;
+
+				uint32_t baseInstance = (chunk.Offset - instanceBase) / sizeof(MeshInstanceData);
+				bool merge = mesh.get() == previousMesh && baseInstance == previousEnd;
+				previousMesh = mesh.get();
+				previousEnd = baseInstance + chunk.Count;
+
+				if (merge)
+				{
+					s_Data.Stats.MergedDraws++;
+				}
+				else
+				{
+					DrawElementsIndirectCommand &command = commands[commandCount++];
+					command.Count = mesh->GetIndexCount();
+					command.InstanceCount = 0;
+					command.FirstIndex = mesh->GetFirstIndex();
+					command.BaseVertex = mesh->GetBaseVertex();
+					command.BaseInstance = baseInstance;
+				}
+
+				// 合并后可见实例从命令的 BaseInstance 开始连续写入，仍在这些块的实例区域之内
+				DrawElementsIndirectCommand &command = commands[commandCount - 1];
+				if (gpuCulling)
+				{
+					cullCommands[cullCount++] = {
+						mesh->GetBoundingSphere(),
+						baseInstance,
+						chunk.Count,
+						commandCount - 1,
+						command.BaseInstance
+					};
+				}
+				else
+				{
+					uint32_t visibleCount = 0;
+					for (uint32_t i = 0; i < chunk.Count; i++)
+					{
+						if (s_Data.BatchCullingMode == Renderer3D::CullingMode::CPU)
+						{
+							// 蒙皮后的包围盒未知，带动画的实例总是可见
+							const Renderer3DData::ModelCullInstance &instance = item.Batch->CullInstances[chunk.FirstInstance + i];
+							if (!instance.Skinned && !Utils::IsInstanceVisible(instance.Transform, mesh->GetBoundingSphere()))
+								continue;
+						}
+
+						visible[command.BaseInstance + command.InstanceCount + visibleCount++] = baseInstance + i;
+					}
+
+					command.InstanceCount += visibleCount;
+					s_Data.Stats.CulledInstances += chunk.Count - visibleCount;
+				}
+			}
+			s_Data.Stats.DrawSortTime += sortTimer.ElapsedMillis();
+
+			if (commandCount > 0)
+			{
+				if (gpuCulling)
 				{
-					// 上传实例数据到 SSBO
-					batch.InstanceSSBO->Bind();
-					batch.InstanceSSBO->SetData(batch.Instances.data(), (uint32_t)batch.InstanceCount * sizeof(MeshInstanceData));
-					batch.InstanceSSBO->BindBase(3);
-					batch.InstanceSSBO->UnBind();
+					Utils::DispatchCulling(cullOffset, cullCount, commandOffset, commandCount, visibleOffset, instanceCapacity,
+										   s_Data.ModelInstanceRing, instanceBase, s_Data.ModelInstanceRing->GetFrameSize(),
+										   sizeof(MeshInstanceData), (int)(offsetof(MeshInstanceData, SkinnedVertexOffset) / sizeof(int)));
+				}
+
+				modelCommandCount = commandCount;
+				modelCommandOffset = commandOffset;
+				modelVisibleOffset = visibleOffset;
+				modelInstanceBase = instanceBase;
+				modelInstanceCapacity = instanceCapacity;
+			}
+		}
 
-					Ref<Mesh> mesh = MeshManager::Get().GetMeshByID(key.MeshID);
-					mesh->DrawInstanced(s_Data.ModelShader, batch.InstanceCount);
+		// 实例数据绑定到 instanceBinding：主通道为各自着色器的 InstanceBuffer，深度预通道统一按 vec4 读取 (binding 9)
+		auto submitSpheres = [&](uint32_t instanceBinding) {
+			s_Data.SphereInstanceRing->BindRange(instanceBinding, s_Data.SphereInstanceOffset, s_Data.SphereCount * sizeof(SphereInstanceData));
+			s_Data.VisibleInstanceRing->BindRange(6, sphereVisibleOffset, s_Data.SphereCount * sizeof(uint32_t));
 
-					s_Data.Stats.MeshCount++;
+			s_Data.DrawCommandRing->BindIndirect();
+			s_Data.DefaultSphereMesh->DrawIndirect(sphereCommandOffset);
+		};
+
+		auto submitModels = [&](uint32_t instanceBinding) {
+			s_Data.ModelInstanceRing->BindRange(instanceBinding, modelInstanceBase, s_Data.ModelInstanceRing->GetFrameSize());
+			s_Data.VisibleInstanceRing->BindRange(6, modelVisibleOffset, modelInstanceCapacity * sizeof(uint32_t));
+
+			Ref<VertexArray> vertexArray = MeshManager::Get().GetVertexArray();
+			vertexArray->Bind();
+
+			s_Data.DrawCommandRing->BindIndirect();
+			glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, (const void *)(uintptr_t)modelCommandOffset, modelCommandCount, 0);
+
+			vertexArray->UnBind();
+		};
+
+		if (drawSpheres || modelCommandCount > 0)
+		{
+			// 延迟路径的几何通道写入 G-buffer，其余流程 (预通道、剔除结果、查询) 与前向路径相同
+			bool deferred = s_Data.RenderPath == Renderer3D::RenderPath::Deferred;
+			const Ref<Shader> &sphereShader = deferred ? s_Data.SphereGBufferShader : s_Data.SphereShader;
+			const Ref<Shader> &modelShader = deferred ? s_Data.ModelGBufferShader : s_Data.ModelShader;
+
+			Renderer3DData::DeferredTarget deferredTarget;
+			if (deferred)
+				deferredTarget = Utils::BeginGBuffer();
+
+			auto &query = Utils::AcquireForwardQuery();
+
+			// 预通道修改的状态在主通道之后恢复为进入时的值，而不是假定的默认值
+			GLenum previousDepthFunc = GLState::GetDepthFunc();
+			bool previousDepthMask = GLState::GetDepthMask();
+
+			// Depth Pre-Pass
+			if (s_Data.UseDepthPrepass)
+			{
+				query.Prepass = true;
+				glBeginQuery(GL_TIME_ELAPSED, query.PrepassTimer);
+
+				uint32_t previousColorMask = GLState::GetColorMask();
+				GLState::SetColorMask(GLState::ColorMaskNone);
+				GLState::SetDepthMask(true);
+				s_Data.DepthPrepassShader->Bind();
+
+				if (drawSpheres)
+				{
+					s_Data.DepthPrepassShader->SetInt("u_InstanceStride", sizeof(SphereInstanceData) / sizeof(glm::vec4));
+					s_Data.DepthPrepassShader->SetInt("u_SkinnedOffsetIndex", -1);
+					submitSpheres(9);
 				}
+				if (modelCommandCount > 0)
+				{
+					s_Data.DepthPrepassShader->SetInt("u_InstanceStride", sizeof(MeshInstanceData) / sizeof(glm::vec4));
+					s_Data.DepthPrepassShader->SetInt("u_SkinnedOffsetIndex", (int)(offsetof(MeshInstanceData, SkinnedVertexOffset) / sizeof(int)));
+					submitModels(9);
+				}
+
+				s_Data.DepthPrepassShader->Unbind();
+				GLState::SetColorMask(previousColorMask);
+
+				// 深度已经确定，主通道只着色最前面的片元
+				GLState::SetDepthFunc(GL_EQUAL);
+				GLState::SetDepthMask(false);
+
+				glEndQuery(GL_TIME_ELAPSED);
+			}
+
+			glBeginQuery(GL_TIME_ELAPSED, query.MainTimer);
+			glBeginQuery(GL_SAMPLES_PASSED, query.SamplesPassed);
+
+			if (drawSpheres)
+			{
+				sphereShader->Bind();
+				submitSpheres(2);
+				sphereShader->Unbind();
+			}
+			if (modelCommandCount > 0)
+			{
+				modelShader->Bind();
+				submitModels(3);
+				modelShader->Unbind();
+			}
+
+			glEndQuery(GL_SAMPLES_PASSED);
+
+			if (s_Data.UseDepthPrepass)
+			{
+				GLState::SetDepthFunc(previousDepthFunc);
+				GLState::SetDepthMask(previousDepthMask);
 			}
 
-			s_Data.ModelShader->Unbind();
+			if (deferred)
+				Utils::ResolveDeferredLighting(deferredTarget);
+
+			glEndQuery(GL_TIME_ELAPSED);
 		}
 
 		// unbind
 		for (auto &pair : s_Data.ModelDrawCallBatches)
 		{
-			pair.second.Instances.clear();
+			pair.second.Chunks.clear();
+			pair.second.CullInstances.clear();
 			pair.second.InstanceCount = 0;
 		}
+		s_Data.ModelDrawItems.clear(); // 引用了上面清空的块
+
+		// 为本批次使用的区域插入 fence
+		s_Data.SphereInstanceRing->EndFrame();
+		s_Data.ModelInstanceRing->EndFrame();
+		s_Data.DrawCommandRing->EndFrame();
+		s_Data.CullCommandRing->EndFrame();
+		s_Data.VisibleInstanceRing->EndFrame();
+		s_Data.SphereInstances = nullptr;
 
 		s_Data.Stats.DrawCalls++;
 	}
@@ -1172,76 +3163,30 @@ namespace Mc
 
 	void Renderer3D::DrawSphere(const glm::mat4 &transform, SphereRendererComponent &src, MaterialComponent *material, int entityID)
 	{
-		if (s_Data.SphereCount >= Renderer3DData::MaxSphereCount)
+		// 只有扩大到 SSBO 绑定大小的上限后才拆分批次
+		if (s_Data.SphereCount >= s_Data.SphereCapacity && !Utils::GrowSphereInstances())
 		{
 			NextBatch();
 		}
 
-		if (src.ProjectionShadow)
-		{
-			auto id = s_Data.DefaultSphereMesh->GetVertexArray()->GetRendererID();
-			auto count = s_Data.DefaultSphereMesh->GetVertexArray()->GetIndexBuffer()->GetCount();
-			Renderer3DData::ProjectionShadowData instanceData = {
-				transform,
-				id,
-				count
-			};
-			glm::mat4 finalBoneMatrices[MAX_BONES];
-			for (int i = 0; i < MAX_BONES; i++)
-				finalBoneMatrices[i] = glm::mat4(1.0f);
-			memcpy(instanceData.FinalBoneMatrices, finalBoneMatrices, MAX_BONES * sizeof(glm::mat4));
-
-			s_Data.ProjectionShadowDatas.push_back(instanceData);
-		}
-
-		glm::vec4 albedo = glm::vec4(1.0f);
-		glm::vec4 emissive = glm::vec4(0.0f);
+		DrawSphereShadow(transform, src);
 
-		std::vector<int> arrIndex(7, 0);
+		// 纹理单元不足时会 NextBatch，之后才写入当前批次的实例
+		int materialIndex = Utils::GetMaterialIndex(material, src.ReceivesPBR, src.ReceivesIBL, src.ReceivesLight, src.ReceivesShadow);
 
-		float roughness = 0.5f;
-		float metallic = 0.0f;
-		float ao = 1.0f;
-
-		if (material != nullptr)
-		{	
-			arrIndex = Mc::Utils::GetMaterialTextureIndices(*material);
-			albedo = glm::vec4(material->Albedo, 1.0f);
-			emissive = glm::vec4(material->Emissive, 1.0f);
-			roughness = material->Roughness;
-			metallic = material->Metallic;
-			ao = material->Ao;
-		}
+		if (s_Data.BatchCullingMode != Renderer3D::CullingMode::GPU)
+			s_Data.SphereTransforms.push_back(transform);
 
-		s_Data.SphereInstances.push_back({
+		s_Data.SphereInstances[s_Data.SphereCount] = {
 			transform,
 			src.Color,
 
-			albedo,
-			emissive,
-			roughness,
-			metallic,
-			ao,
-
-			// Texture
-			arrIndex[0],
-			arrIndex[1],
-			arrIndex[2],
-			arrIndex[3],
-			arrIndex[4],
-			arrIndex[5],
-			arrIndex[6],
-
 			src.TilingFactor,
 			entityID,
+			materialIndex,
+			0
+		};
 
-			(int)src.ReceivesPBR,
-			(int)src.ReceivesIBL,
-			(int)src.ReceivesLight,
-			(int)src.ReceivesShadow,
-		});
-
-		arrIndex.clear();
 		s_Data.SphereCount++;
 		s_Data.Stats.SphereCount++;
 	}
@@ -1255,101 +3200,60 @@ namespace Mc
 		Renderer3DData::ModelCallKey key;
 		key.MeshID = mesh->Id;
 
-		Renderer3DData::ModelCallBatch &batch = s_Data.ModelDrawCallBatches[key];
-
-		if (batch.InstanceSSBO == nullptr)
-		{
-			batch.InstanceSSBO = ShaderStorageBuffer::Create(Renderer3DData::MaxInstancesPerModel * sizeof(MeshInstanceData));
-			batch.Instances.reserve(Renderer3DData::MaxInstancesPerModel);
-		}
-
-		if (batch.InstanceCount >= Renderer3DData::MaxInstancesPerModel)
+		if (!Utils::HasModelInstanceSpace(key))
 		{
 			NextBatch();
 		}
 
-		glm::mat4 finalBoneMatrices[MAX_BONES];
-		{
-			if (src.ReceivesAnimator)
-				for (int i = 0; i < MAX_BONES; i++)
-					finalBoneMatrices[i] = src.Model->GetAnimator()->GetFinalBoneMatrices()[i];
-			else
-				for (int i = 0; i < MAX_BONES; i++)
-					finalBoneMatrices[i] = glm::mat4(1.0f);
-		}
-
-		if (src.ProjectionShadow)
-		{
-			auto data = MeshManager::Get().GetMeshByID(mesh->Id);
-			auto id = data->GetVertexArray()->GetRendererID();
-			auto count = data->GetIndexBuffer()->GetCount();
-
-			Renderer3DData::ProjectionShadowData instanceData = {
-				transform,
-				id,
-				count
-			};
-			memcpy(instanceData.FinalBoneMatrices, finalBoneMatrices, MAX_BONES * sizeof(glm::mat4));
-
-			s_Data.ProjectionShadowDatas.push_back(instanceData);
-		}
+		// 同一实体的所有子网格共用一份调色板，每个子网格每帧蒙皮一次
+		int skinnedVertexOffset = -1;
+		if (src.ReceivesAnimator && src.Model && src.Model->GetAnimator())
+			skinnedVertexOffset = Utils::GetSkinnedVertexOffset(entityID, mesh->Id, src.Model->GetAnimator()->GetFinalBoneMatrices());
 
-		glm::vec4 albedo = glm::vec4(1.0f);
-		glm::vec4 emissive = glm::vec4(0.0f);
+		DrawModelShadow(transform, src, mesh, entityID);
 
-		std::vector<int> arrIndex(7, 0);
+		int materialIndex = Utils::GetMaterialIndex(material, src.ReceivesPBR, src.ReceivesIBL, src.ReceivesLight, src.ReceivesShadow);
 
-		float roughness = 0.5f;
-		float metallic = 0.0f;
-		float ao = 1.0f;
+		// 直接向映射内存填充实例数据
+		// 贴图绑定可能触发 NextBatch，因此在其之后再申请实例位置
+		MeshInstanceData &instanceData = *Utils::AllocateModelInstance(key, transform, skinnedVertexOffset >= 0);
 
-		if (material != nullptr)
-		{
-			arrIndex = Mc::Utils::GetMaterialTextureIndices(*material);
-			albedo = glm::vec4(material->Albedo, 1.0f);
-			emissive = glm::vec4(material->Emissive, 1.0f);
-			roughness = material->Roughness;
-			metallic = material->Metallic;
-			ao = material->Ao;
-		}
+		instanceData.Transform = transform;
+		instanceData.TintColor = src.Color;
 
-		// 填充实例数据
-		MeshInstanceData instanceData = {
-			transform,
-			src.Color,
+		instanceData.EntityID = entityID;
+		instanceData.FlipUV = (int)src.FlipUV;
+		instanceData.MaterialIndex = materialIndex;
+		instanceData.SkinnedVertexOffset = skinnedVertexOffset;
 
-			albedo,
-			emissive,
-			roughness,
-			metallic,
-			ao,
+		s_Data.ModelCount++;
+		s_Data.Stats.ModelCount++; // 统计渲染的模型实例数量
+	}
 
-			// Texture
-			arrIndex[0],
-			arrIndex[1],
-			arrIndex[2],
-			arrIndex[3],
-			arrIndex[4],
-			arrIndex[5],
-			arrIndex[6],
+	void Renderer3D::DrawSphereShadow(const glm::mat4 &transform, SphereRendererComponent &src)
+	{
+		if (!src.ProjectionShadow)
+			return;
 
-			entityID,
-			(int)src.FlipUV,
+		auto id = s_Data.DefaultSphereMesh->GetVertexArray()->GetRendererID();
+		auto count = s_Data.DefaultSphereMesh->GetVertexArray()->GetIndexBuffer()->GetCount();
+		Utils::AddShadowCaster(id, count, 0, 0, GL_TRIANGLE_STRIP, transform, Renderer3DData::SphereBoundingSphere, -1);
+	}
 
-			(int)src.ReceivesPBR,
-			(int)src.ReceivesIBL,
-			(int)src.ReceivesLight,
-			(int)src.ReceivesShadow,
-		};
-		memcpy(instanceData.FinalBoneMatrices, finalBoneMatrices, MAX_BONES * sizeof(glm::mat4));
+	void Renderer3D::DrawModelShadow(const glm::mat4 &transform, ModelRendererComponent &src, MeshRendererComponent *mesh, int entityID)
+	{
+		if (!src.ProjectionShadow || src.ModelPath.empty())
+			return;
 
-		batch.Instances.push_back(instanceData);
-		batch.InstanceCount++;
+		// 蒙皮结果按 (实体, 网格) 缓存，与 DrawModel 共用同一份
+		int skinnedVertexOffset = -1;
+		if (src.ReceivesAnimator && src.Model && src.Model->GetAnimator())
+			skinnedVertexOffset = Utils::GetSkinnedVertexOffset(entityID, mesh->Id, src.Model->GetAnimator()->GetFinalBoneMatrices());
 
-		arrIndex.clear();
+		auto data = MeshManager::Get().GetMeshByID(mesh->Id);
+		auto id = MeshManager::Get().GetVertexArray()->GetRendererID();
 
-		s_Data.ModelCount++;
-		s_Data.Stats.ModelCount++; // 统计渲染的模型实例数量
+		Utils::AddShadowCaster(id, data->GetIndexCount(), data->GetFirstIndex(), data->GetBaseVertex(), GL_TRIANGLES, transform, data->GetBoundingSphere(), skinnedVertexOffset);
 	}
 
     void Renderer3D::DrawDirectionalLight(const glm::mat4 &transform, DirectionalLightComponent &src, ShadowComponent *shadow, int entityID)
@@ -1374,24 +3278,36 @@ namespace Mc
 				const glm::mat4 &currentProjection = s_Data.CameraBuffer.Projection;
 				const glm::mat4 &currentViewMatrix = s_Data.CameraBuffer.View;
 
-				glm::mat4 lightSpaceMatrix =  Utils::CalculateDirectionalLightSpaceMatrix(currentProjection, currentViewMatrix, direction, 10.0f, shadow->NearPlane, shadow->FarPlane);
-				// ================================================
-
-				dirLight.LightSpaceMatrix = lightSpaceMatrix;
-				dirLight.ShadowMapIndex = s_Data.DirectionalShadowTextureSlotIndex;
+				float cameraNear, cameraFar;
+				Utils::GetProjectionDepthRange(currentProjection, cameraNear, cameraFar);
+				glm::vec4 splits = Utils::CalculateCascadeSplits(cameraNear, cameraFar, Renderer3DData::CascadeSplitLambda);
 
 				Renderer3DData::StoredDirectionalShadowCPU data;
 
-				data.LightSpaceMatrix = lightSpaceMatrix;
+				float splitNear = cameraNear;
+				for (uint32_t i = 0; i < ShadowCascadeCount; i++)
+				{
+					data.CascadeMatrices[i] = Utils::CalculateCascadeLightSpaceMatrix(currentProjection, currentViewMatrix, direction, splitNear, splits[i],
+																					  shadow->NearPlane, shadow->FarPlane, (float)it->second->GetResolution());
+					dirLight.CascadeMatrices[i] = data.CascadeMatrices[i];
+					splitNear = splits[i];
+				}
+				// ================================================
+
+				dirLight.CascadeSplits = splits;
+				// 图集区块在 EndScene 中分配
+				dirLight.ShadowMapIndex = (int)s_Data.DirectionalShadows.size();
+
+				data.LightIndex = (uint32_t)s_Data.DirectionalLights.size();
 				data.Shadow = it->second;
-				data.Slot = s_Data.DirectionalShadowTextureSlotIndex;
 
 				s_Data.DirectionalShadows.push_back(data);
-				s_Data.DirectionalShadowTextureSlotIndex++;
 			}
 			else
 			{
-				dirLight.LightSpaceMatrix = glm::mat4(0.0);
+				std::fill(dirLight.CascadeMatrices, dirLight.CascadeMatrices + ShadowCascadeCount, glm::mat4(0.0f));
+				dirLight.CascadeSplits = glm::vec4(0.0f);
+				std::fill(dirLight.CascadeRects, dirLight.CascadeRects + ShadowCascadeCount, glm::vec4(0.0f));
 				dirLight.ShadowMapIndex = -1;
 			}
 
@@ -1405,113 +3321,112 @@ namespace Mc
 
 	void Renderer3D::DrawPointLight(const glm::mat4 &transform, PointLightComponent &src, ShadowComponent *shadow, int entityID)
 	{
-		if (s_Data.PointLights.size() < Renderer3DData::MAX_POINT_LIGHTS)
-		{
-			glm::vec3 position = transform[3];
-			glm::vec3 direction = glm::normalize(glm::vec3(transform * glm::vec4(0.0f, 0.0f, -1.0f, 0.0f)));
-
-			StoredPointLight ptLight;
-
-			ptLight.Position = position;
-			ptLight.Color = src.Color;
-			ptLight.Intensity = src.Intensity;
-			ptLight.Radius = src.Radius;
-			ptLight.CastsShadows = (int)src.CastsShadows;
-
-			auto it = s_Data.PointShadowMaps.find(entityID);
+		glm::vec3 position = transform[3];
+		glm::vec3 direction = glm::normalize(glm::vec3(transform * glm::vec4(0.0f, 0.0f, -1.0f, 0.0f)));
 
-			if (it != s_Data.PointShadowMaps.end())
-			{
-				ptLight.FarPlane = shadow->FarPlane;
-				ptLight.ShadowMapIndex = s_Data.PointShadowTextureSlotIndex;
-				ptLight.padding_0 = 0.0f;
-
-				Renderer3DData::StoredPointShadowCPU data;
-				Renderer3DData::StoredPointShadowGPU gpu_data;
+		StoredPointLight ptLight;
 
-				gpu_data.LightPositionFarPlane.x = position.x;
-				gpu_data.LightPositionFarPlane.y = position.y;
-				gpu_data.LightPositionFarPlane.z = position.z;
-				gpu_data.LightPositionFarPlane.w = shadow->FarPlane;
+		ptLight.Position = position;
+		ptLight.Color = src.Color;
+		ptLight.Intensity = src.Intensity;
+		ptLight.Radius = src.Radius;
+		ptLight.CastsShadows = (int)src.CastsShadows;
 
-				glm::mat4 shadowProj = glm::perspective(glm::radians(90.0f), (float)shadow->Resolution / (float)shadow->Resolution, shadow->NearPlane, shadow->FarPlane);
-				gpu_data.ShadowTransforms[0] = shadowProj * glm::lookAt(position, position + glm::vec3(1.0, 0.0, 0.0), glm::vec3(0.0, -1.0, 0.0));
-				gpu_data.ShadowTransforms[1] = shadowProj * glm::lookAt(position, position + glm::vec3(-1.0, 0.0, 0.0), glm::vec3(0.0, -1.0, 0.0));
-				gpu_data.ShadowTransforms[2] = shadowProj * glm::lookAt(position, position + glm::vec3(0.0, 1.0, 0.0), glm::vec3(0.0, 0.0, 1.0));
-				gpu_data.ShadowTransforms[3] = shadowProj * glm::lookAt(position, position + glm::vec3(0.0, -1.0, 0.0), glm::vec3(0.0, 0.0, -1.0));
-				gpu_data.ShadowTransforms[4] = shadowProj * glm::lookAt(position, position + glm::vec3(0.0, 0.0, 1.0), glm::vec3(0.0, -1.0, 0.0));
-				gpu_data.ShadowTransforms[5] = shadowProj * glm::lookAt(position, position + glm::vec3(0.0, 0.0, -1.0), glm::vec3(0.0, -1.0, 0.0));
-
-				data.GPUData = gpu_data;
-				data.Shadow = it->second;
-				data.Slot = s_Data.PointShadowTextureSlotIndex;
+		auto it = s_Data.PointShadowMaps.find(entityID);
+		if (it != s_Data.PointShadowMaps.end() && s_Data.PointShadows.size() >= Renderer3DData::MAX_POINT_SHADOWS)
+		{
+			LOG_CORE_WARN("Max point light shadows reached!");
+			it = s_Data.PointShadowMaps.end();
+		}
 
-				s_Data.PointShadows.push_back(data);
-				s_Data.PointShadowTextureSlotIndex++;
-			}
-			else
-			{
-				ptLight.FarPlane = 0.0f;
-				ptLight.ShadowMapIndex = -1;
-				ptLight.padding_0 = 0.0f;
-			}
-			s_Data.PointLights.push_back(ptLight);
+		if (it != s_Data.PointShadowMaps.end())
+		{
+			ptLight.FarPlane = shadow->FarPlane;
+			ptLight.ShadowMapIndex = s_Data.PointShadowTextureSlotIndex;
+			ptLight.padding_0 = 0.0f;
+
+			Renderer3DData::StoredPointShadowCPU data;
+			Renderer3DData::StoredPointShadowGPU gpu_data;
+
+			gpu_data.LightPositionFarPlane.x = position.x;
+			gpu_data.LightPositionFarPlane.y = position.y;
+			gpu_data.LightPositionFarPlane.z = position.z;
+			gpu_data.LightPositionFarPlane.w = shadow->FarPlane;
+
+			glm::mat4 shadowProj = glm::perspective(glm::radians(90.0f), (float)shadow->Resolution / (float)shadow->Resolution, shadow->NearPlane, shadow->FarPlane);
+			gpu_data.ShadowTransforms[0] = shadowProj * glm::lookAt(position, position + glm::vec3(1.0, 0.0, 0.0), glm::vec3(0.0, -1.0, 0.0));
+			gpu_data.ShadowTransforms[1] = shadowProj * glm::lookAt(position, position + glm::vec3(-1.0, 0.0, 0.0), glm::vec3(0.0, -1.0, 0.0));
+			gpu_data.ShadowTransforms[2] = shadowProj * glm::lookAt(position, position + glm::vec3(0.0, 1.0, 0.0), glm::vec3(0.0, 0.0, 1.0));
+			gpu_data.ShadowTransforms[3] = shadowProj * glm::lookAt(position, position + glm::vec3(0.0, -1.0, 0.0), glm::vec3(0.0, 0.0, -1.0));
+			gpu_data.ShadowTransforms[4] = shadowProj * glm::lookAt(position, position + glm::vec3(0.0, 0.0, 1.0), glm::vec3(0.0, -1.0, 0.0));
+			gpu_data.ShadowTransforms[5] = shadowProj * glm::lookAt(position, position + glm::vec3(0.0, 0.0, -1.0), glm::vec3(0.0, -1.0, 0.0));
+
+			data.GPUData = gpu_data;
+			data.Shadow = it->second;
+			data.Slot = s_Data.PointShadowTextureSlotIndex;
+
+			s_Data.PointShadows.push_back(data);
+			s_Data.PointShadowTextureSlotIndex++;
 		}
 		else
 		{
-			LOG_CORE_WARN("Max point lights reached!");
+			ptLight.FarPlane = 0.0f;
+			ptLight.ShadowMapIndex = -1;
+			ptLight.padding_0 = 0.0f;
 		}
+		s_Data.PointLights.push_back(ptLight);
 	}
 
 	void Renderer3D::DrawSpotLight(const glm::mat4 &transform, SpotLightComponent &src, ShadowComponent *shadow, int entityID)
 	{
-		if (s_Data.SpotLights.size() < Renderer3DData::MAX_SPOT_LIGHTS)
-		{
-			glm::vec3 position = transform[3];
-			glm::vec3 direction = glm::normalize(glm::vec3(transform * glm::vec4(0.0f, 0.0f, -1.0f, 0.0f)));
+		glm::vec3 position = transform[3];
+		glm::vec3 direction = glm::normalize(glm::vec3(transform * glm::vec4(0.0f, 0.0f, -1.0f, 0.0f)));
 
-			StoredSpotLight spLight;
-			spLight.Position = position;
-			spLight.Direction = direction; // 聚光灯方向
-			spLight.Color = src.Color;
-			spLight.Intensity = src.Intensity;
-			spLight.Radius = src.Radius;
+		StoredSpotLight spLight;
+		spLight.Position = position;
+		spLight.Direction = direction; // 聚光灯方向
+		spLight.Color = src.Color;
+		spLight.Intensity = src.Intensity;
+		spLight.Radius = src.Radius;
 
-			spLight.InnerConeCos = glm::cos(src.InnerConeAngle); // GLSL 内边界使用外锥角
-			spLight.OuterConeCos = glm::cos(src.OuterConeAngle); // GLSL 外边界使用内锥角
+		spLight.InnerConeCos = glm::cos(src.InnerConeAngle); // GLSL 内边界使用外锥角
+		spLight.OuterConeCos = glm::cos(src.OuterConeAngle); // GLSL 外边界使用内锥角
 
-			spLight.CastsShadows = (int)src.CastsShadows;
-			spLight.padding_0 = 0.0f;
+		spLight.CastsShadows = (int)src.CastsShadows;
+		spLight.padding_0 = 0.0f;
 
-			auto it = s_Data.SpotShadowMaps.find(entityID);
-			if (it != s_Data.SpotShadowMaps.end())
-			{
-				glm::mat4 lightSpaceMatrix = Utils::CalculateSpotLightSpaceMatrix(position, direction, src.OuterConeAngle, shadow->NearPlane, shadow->FarPlane);
-				// ================================================
+		auto it = s_Data.SpotShadowMaps.find(entityID);
+		if (it != s_Data.SpotShadowMaps.end() && s_Data.SpotShadows.size() >= Renderer3DData::MAX_SPOT_SHADOWS)
+		{
+			LOG_CORE_WARN("Max spot light shadows reached!");
+			it = s_Data.SpotShadowMaps.end();
+		}
 
-				spLight.LightSpaceMatrix = lightSpaceMatrix;
-				spLight.ShadowMapIndex = s_Data.SpotShadowTextureSlotIndex;
+		if (it != s_Data.SpotShadowMaps.end())
+		{
+			glm::mat4 lightSpaceMatrix = Utils::CalculateSpotLightSpaceMatrix(position, direction, src.OuterConeAngle, shadow->NearPlane, shadow->FarPlane);
+			// ================================================
 
-				Renderer3DData::StoredSpotShadowCPU data;
+			spLight.LightSpaceMatrix = lightSpaceMatrix;
+			// 图集区块在 EndScene 中分配
+			spLight.ShadowMapIndex = (int)s_Data.SpotShadows.size();
 
-				data.LightSpaceMatrix = lightSpaceMatrix;
-				data.Shadow = it->second;
-				data.Slot = s_Data.SpotShadowTextureSlotIndex;
+			Renderer3DData::StoredSpotShadowCPU data;
 
-				s_Data.SpotShadows.push_back(data);
-				s_Data.SpotShadowTextureSlotIndex++;
-			}
-			else
-			{
-				spLight.LightSpaceMatrix = glm::mat4(0.0);
-				spLight.ShadowMapIndex = -1;
-			}
-			s_Data.SpotLights.push_back(spLight);
+			data.LightSpaceMatrix = lightSpaceMatrix;
+			data.BoundingSphere = glm::vec4(position, shadow->FarPlane);
+			data.LightIndex = (uint32_t)s_Data.SpotLights.size();
+			data.Shadow = it->second;
+
+			s_Data.SpotShadows.push_back(data);
 		}
 		else
 		{
-			LOG_CORE_WARN("Max spot lights reached!");
+			spLight.LightSpaceMatrix = glm::mat4(0.0);
+			spLight.AtlasRect = glm::vec4(0.0f);
+			spLight.ShadowMapIndex = -1;
 		}
+		s_Data.SpotLights.push_back(spLight);
 	}
 
     void Renderer3D::AddDirectionalShadow(entt::entity entity, unsigned int resolution)
@@ -1562,13 +3477,129 @@ namespace Mc
 		s_Data.HdrSkybox = HdrManager::Get().GetActive();
 	}
 
+	void Renderer3D::SetCullingMode(CullingMode mode)
+	{
+		s_Data.CullingMode = mode;
+	}
+
+	Renderer3D::CullingMode Renderer3D::GetCullingMode()
+	{
+		return s_Data.CullingMode;
+	}
+
+	void Renderer3D::SetShadowUpdateBudget(uint32_t maxMaps, float budgetMs)
+	{
+		s_Data.MaxShadowUpdates = maxMaps;
+		s_Data.ShadowUpdateBudget = glm::max(budgetMs, 0.0f);
+	}
+
+	uint32_t Renderer3D::GetShadowUpdateMaxMaps()
+	{
+		return s_Data.MaxShadowUpdates;
+	}
+
+	float Renderer3D::GetShadowUpdateBudgetMs()
+	{
+		return s_Data.ShadowUpdateBudget;
+	}
+
+	void Renderer3D::SetBindlessTextures(bool enabled)
+	{
+		// 句柄表在 FlushBindlessTextures 中按全局纹理表补齐，两种模式的贴图下标含义相同
+		s_Data.UseBindlessTextures = enabled && BindlessTexture::IsSupported();
+
+		s_Data.SphereShader->Bind();
+		s_Data.SphereShader->SetBool("u_Bindless", s_Data.UseBindlessTextures);
+		s_Data.SphereShader->Unbind();
+
+		s_Data.ModelShader->Bind();
+		s_Data.ModelShader->SetBool("u_Bindless", s_Data.UseBindlessTextures);
+		s_Data.ModelShader->Unbind();
+
+		s_Data.SphereGBufferShader->Bind();
+		s_Data.SphereGBufferShader->SetBool("u_Bindless", s_Data.UseBindlessTextures);
+		s_Data.SphereGBufferShader->Unbind();
+
+		s_Data.ModelGBufferShader->Bind();
+		s_Data.ModelGBufferShader->SetBool("u_Bindless", s_Data.UseBindlessTextures);
+		s_Data.ModelGBufferShader->Unbind();
+	}
+
+	bool Renderer3D::IsBindlessTextures()
+	{
+		return s_Data.UseBindlessTextures;
+	}
+
+	void Renderer3D::SetRenderPath(RenderPath path)
+	{
+		s_Data.RenderPath = path;
+	}
+
+	Renderer3D::RenderPath Renderer3D::GetRenderPath()
+	{
+		return s_Data.RenderPath;
+	}
+
+	void Renderer3D::SetDepthPrepass(bool enabled)
+	{
+		s_Data.UseDepthPrepass = enabled;
+	}
+
+	bool Renderer3D::IsDepthPrepass()
+	{
+		return s_Data.UseDepthPrepass;
+	}
+
+	void Renderer3D::SetDrawSorting(bool enabled)
+	{
+		s_Data.UseDrawSorting = enabled;
+	}
+
+	bool Renderer3D::IsDrawSorting()
+	{
+		return s_Data.UseDrawSorting;
+	}
+
+	void Renderer3D::SetSkinningMode(SkinningMode mode)
+	{
+		s_Data.SkinningMode = mode;
+	}
+
+	Renderer3D::SkinningMode Renderer3D::GetSkinningMode()
+	{
+		return s_Data.SkinningMode;
+	}
+
+	void Renderer3D::SetCpuSkinningThreads(uint32_t count)
+	{
+		s_Data.CpuSkinningThreads = count;
+		if (s_Data.Skinner)
+			s_Data.Skinner->SetThreadCount(count);
+	}
+
+	uint32_t Renderer3D::GetCpuSkinningThreads()
+	{
+		return s_Data.CpuSkinningThreads;
+	}
+
+	void Renderer3D::AddSceneCulled(uint32_t count)
+	{
+		s_Data.Stats.SceneCulled += count;
+	}
+
 	void Renderer3D::ResetStats()
 	{
 		memset(&s_Data.Stats, 0, sizeof(Statistics));
+		BufferStatistics::Reset();
+		GLState::ResetStats();
 	}
 
 	Renderer3D::Statistics Renderer3D::GetStats()
 	{
-		return s_Data.Stats;
+		Statistics stats = s_Data.Stats;
+		stats.BufferAllocations = BufferStatistics::GetAllocations();
+		stats.StateCallsIssued = GLState::GetStats().Issued;
+		stats.StateCallsFiltered = GLState::GetStats().Filtered;
+		return stats;
 	}
 }
\ No newline at end of file
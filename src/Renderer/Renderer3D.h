@@ -45,6 +45,10 @@ namespace Mc
 
 		static void DrawModel(const glm::mat4 &transform, ModelRendererComponent &src, MeshRendererComponent *mesh, MaterialComponent *material, int entityID);
 
+		// 被视锥剔除的物体仍可能把阴影投到画面内，只提交阴影投射数据
+		static void DrawSphereShadow(const glm::mat4 &transform, SphereRendererComponent &src);
+		static void DrawModelShadow(const glm::mat4 &transform, ModelRendererComponent &src, MeshRendererComponent *mesh, int entityID);
+
 		static void DrawDirectionalLight(const glm::mat4 &transform, DirectionalLightComponent &src, ShadowComponent *shadow, int entityID);
 		static void DrawPointLight(const glm::mat4 &transform, PointLightComponent &src, ShadowComponent *shadow, int entityID);
 		static void DrawSpotLight(const glm::mat4 &transform, SpotLightComponent &src, ShadowComponent *shadow, int entityID);
@@ -60,15 +64,118 @@ namespace Mc
 
 		static void DrawHdrSkybox(HdrSkyboxComponent &src, int entityID);
 
+		// Bindless Texture
+		// 不支持 GL_ARB_bindless_texture 时保持纹理单元模式
+		static void SetBindlessTextures(bool enabled);
+		static bool IsBindlessTextures();
+
+		// Culling
+		// GPU: 计算着色器剔除并写入间接绘制命令; CPU: 参考实现，结果与 GPU 一致; None: 不剔除
+		enum class CullingMode
+		{
+			None = 0, CPU, GPU
+		};
+		static void SetCullingMode(CullingMode mode);
+		static CullingMode GetCullingMode();
+		// Scene 提交前剔除的物体数量
+		static void AddSceneCulled(uint32_t count);
+
+		// Shadow Update
+		// 内容变化的阴影贴图按 屏幕影响 × 推迟帧数 排序，每帧只渲染预算内的部分，其余沿用旧贴图
+		// maxMaps: 每帧最多渲染的数量; budgetMs: 按 GPU 计时估算的时间上限; 0 表示不限制
+		static void SetShadowUpdateBudget(uint32_t maxMaps, float budgetMs);
+		static uint32_t GetShadowUpdateMaxMaps();
+		static float GetShadowUpdateBudgetMs();
+
+		// Render Path
+		// Forward: 几何通道直接计算光照; Deferred: 先写 G-buffer，再用全屏通道计算光照 (alpha 混合只与背景混合)
+		enum class RenderPath
+		{
+			Forward = 0, Deferred
+		};
+		static void SetRenderPath(RenderPath path);
+		static RenderPath GetRenderPath();
+
+		// Depth Pre-Pass
+		// 先用只写深度的着色器绘制一遍，主通道以 GL_EQUAL 测试，每个像素只着色一次
+		// 是否划算取决于场景的重叠程度，对比统计中的 Overdraw 和两个通道的耗时决定
+		static void SetDepthPrepass(bool enabled);
+		static bool IsDepthPrepass();
+
+		// Draw Sorting
+		// 模型的每条间接绘制命令按 64 位键 (通道、着色器变体、深度、网格) 基数排序后提交，由近到远
+		// CPU 剔除时球体的可见实例同样按深度排序; 关闭后按批次的存储顺序提交，用于对比排序的开销与收益
+		static void SetDrawSorting(bool enabled);
+		static bool IsDrawSorting();
+
+		// Skinning
+		// GPU: 计算着色器蒙皮; CPU: 工作线程蒙皮后写入持久映射的缓冲区，着色器按静态顶点读取
+		// CPU 模式用于软件光栅化 (llvmpipe) 或无 GPU 的部署，下一次 BeginScene 生效
+		enum class SkinningMode
+		{
+			GPU = 0, CPU
+		};
+		static void SetSkinningMode(SkinningMode mode);
+		static SkinningMode GetSkinningMode();
+		// 0 表示使用所有硬件线程
+		static void SetCpuSkinningThreads(uint32_t count);
+		static uint32_t GetCpuSkinningThreads();
+
 		// Stats
 		struct Statistics
 		{
 			uint32_t DrawCalls = 0;
+			uint32_t ShadowDrawCalls = 0; // 所有阴影通道的实例化绘制次数
 
 			uint32_t SphereCount = 0;
 
 			uint32_t ModelCount = 0;
 			uint32_t MeshCount = 0;
+			uint32_t MaterialCount = 0; // 材质表中去重后的材质数量
+
+			uint32_t BufferAllocations = 0; // 本帧创建的 GL 缓冲区数量
+			uint32_t StateCallsIssued = 0;	 // 经过 GLState 实际发出的状态调用
+			uint32_t StateCallsFiltered = 0; // 与缓存相同而省略的状态调用和 glGet
+
+			uint32_t CulledInstances = 0; // 仅 CPU 剔除时统计，GPU 剔除结果不回读
+			uint32_t SceneCulled = 0;	  // Scene 提交前由 FrustumCuller 剔除的球体和网格
+
+			uint32_t PointLights = 0;
+			uint32_t SpotLights = 0;
+			uint32_t ClusterLightIndices = 0; // 所有簇的光源下标总数
+
+			// 每个投射阴影的光源剔除的投射物数量，按点光源、方向光、聚光灯的绘制顺序
+			static const uint32_t MaxShadowLights = 24;
+			uint32_t ShadowCasters = 0; // 本帧投射物总数
+			uint32_t ShadowMapsRendered = 0;
+			uint32_t ShadowMapsCached = 0;	 // 内容未变化、直接复用的阴影贴图
+			uint32_t ShadowMapsDeferred = 0; // 超出更新预算、推迟到之后帧的阴影贴图
+			uint32_t ShadowLightCount = 0;
+			char ShadowLightTypes[MaxShadowLights] = {}; // 'P' / 'D' / 'S'
+			uint32_t ShadowCastersCulled[MaxShadowLights] = {};
+
+			float SubmitTime = 0.0f; // BeginScene 到 EndScene 之间的 CPU 时间 (ms)，包含材质和贴图解析
+
+			// 前向渲染的 GPU 查询，几帧之前的结果
+			float DepthPrepassTime = 0.0f; // ms
+			float ForwardPassTime = 0.0f;  // 主通道 (PBR 着色) 的 GPU 时间 (ms)
+			float Overdraw = 0.0f;		   // 主通道着色的采样数 / 视口像素数
+
+			uint32_t SortedDraws = 0;  // 参与排序的模型实例块
+			uint32_t MergedDraws = 0;  // 与前一条命令网格相同、实例相连而合并的实例块
+			float DrawSortTime = 0.0f; // 生成排序键与排序的 CPU 时间 (ms)
+
+			uint32_t SkinnedVertices = 0;	 // 本帧蒙皮的顶点数，所有通道共用
+			uint32_t SkinningDispatches = 0; // GPU: glDispatchCompute 次数; CPU: CpuSkinner::Skin 次数
+			float CpuSkinningTime = 0.0f;	 // CPU 蒙皮的耗时 (ms)
+			uint32_t CpuSkinningThreads = 0;
+
+			// EndScene 帧图中的通道，按执行顺序
+			static const uint32_t MaxPasses = 8;
+			uint32_t PassCount = 0;
+			const char *PassNames[MaxPasses] = {};
+			float PassCpuTime[MaxPasses] = {}; // ms，-1 表示被剔除
+			float PassGpuTime[MaxPasses] = {}; // ms，几帧之前的结果
 		};
 		static void ResetStats();
 		static Statistics GetStats();
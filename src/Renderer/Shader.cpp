@@ -1,6 +1,8 @@
 #include "Shader.h"
+#include "GLState.h"
 
 #include <fstream>
+#include <algorithm>
 
 #include <glad/glad.h>
 #include <glm/gtc/type_ptr.hpp>
@@ -15,13 +17,20 @@ namespace Mc
             return GL_FRAGMENT_SHADER;
         else if (type == "geometry")
             return GL_GEOMETRY_SHADER;
+        else if (type == "compute")
+            return GL_COMPUTE_SHADER;
         return 0;
     }
 
-    Shader::Shader(const std::string &filePath)
+    // 所有程序共用的 uniform block 及其绑定点
+    static const std::unordered_map<std::string, uint32_t> s_UniformBlockBindings = {
+        { "Camera", 0 }
+    };
+
+    Shader::Shader(const std::string &filePath, const std::vector<std::string> &defines)
     {
         std::string source = LoadShaderFile(filePath);
-        auto shaderSoures = PreProcess(source);
+        auto shaderSoures = PreProcess(source, defines);
         Complie(shaderSoures);
 
         // Extract name from filepath
@@ -35,16 +44,17 @@ namespace Mc
     Shader::~Shader()
     {
         glDeleteProgram(m_RendererID);
+        GLState::OnDeleteProgram(m_RendererID);
     }
 
     void Shader::Bind() const
     {
-        glUseProgram(m_RendererID);
+        GLState::UseProgram(m_RendererID);
     }
 
     void Shader::Unbind() const
     {
-        glUseProgram(0);
+        // 下一次 Bind 时直接切换程序，解绑只会多出一次 glUseProgram
     }
 
     std::string Shader::LoadShaderFile(const std::string &filepath)
@@ -66,7 +76,7 @@ namespace Mc
         return result;
     }
 
-    std::unordered_map<GLenum, std::string> Shader::PreProcess(const std::string &source)
+    std::unordered_map<GLenum, std::string> Shader::PreProcess(const std::string &source, const std::vector<std::string> &defines)
     {
         std::unordered_map<GLenum, std::string> shaderSources;
 
@@ -86,6 +96,23 @@ namespace Mc
                                                             ? source.substr(nextLinePos)
                                                             : source.substr(nextLinePos, pos - nextLinePos);
         }
+
+        if (!defines.empty())
+        {
+            std::string defineLines;
+            for (auto &define : defines)
+                defineLines += "#define " + define + "\n";
+
+            // #version 必须是第一条指令，#define 放在它的下一行
+            for (auto &kv : shaderSources)
+            {
+                std::string &stageSource = kv.second;
+                size_t versionPos = stageSource.find("#version");
+                size_t insertPos = versionPos == std::string::npos ? 0 : stageSource.find('\n', versionPos);
+                insertPos = insertPos == std::string::npos ? stageSource.size() : insertPos + 1;
+                stageSource.insert(insertPos, defineLines);
+            }
+        }
         return shaderSources;
     }
 
@@ -143,11 +170,79 @@ namespace Mc
             glDetachShader(program, id);
             glDeleteShader(id);
         }
+
+        Reflect();
+    }
+
+    void Shader::Reflect()
+    {
+        m_UniformLocations.clear();
+
+        GLint uniformCount = 0;
+        GLint maxNameLength = 0;
+        glGetProgramiv(m_RendererID, GL_ACTIVE_UNIFORMS, &uniformCount);
+        glGetProgramiv(m_RendererID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+
+        std::vector<GLchar> nameBuffer(std::max(maxNameLength, 1));
+        for (GLint i = 0; i < uniformCount; i++)
+        {
+            GLint size = 0;
+            GLenum type = 0;
+            GLsizei length = 0;
+            glGetActiveUniform(m_RendererID, (GLuint)i, (GLsizei)nameBuffer.size(), &length, &size, &type, nameBuffer.data());
+
+            std::string name(nameBuffer.data(), length);
+            GLint location = glGetUniformLocation(m_RendererID, name.c_str());
+            if (location == -1) // uniform block 中的成员
+                continue;
+
+            m_UniformLocations[name] = location;
+
+            // 数组返回 "name[0]"，同时登记不带下标的名字和每个元素
+            if (name.size() > 3 && name.compare(name.size() - 3, 3, "[0]") == 0)
+            {
+                std::string base = name.substr(0, name.size() - 3);
+                m_UniformLocations[base] = location;
+                for (GLint element = 1; element < size; element++)
+                {
+                    std::string elementName = base + "[" + std::to_string(element) + "]";
+                    m_UniformLocations[elementName] = glGetUniformLocation(m_RendererID, elementName.c_str());
+                }
+            }
+        }
+
+        GLint blockCount = 0;
+        GLint maxBlockNameLength = 0;
+        glGetProgramiv(m_RendererID, GL_ACTIVE_UNIFORM_BLOCKS, &blockCount);
+        glGetProgramiv(m_RendererID, GL_ACTIVE_UNIFORM_BLOCK_MAX_NAME_LENGTH, &maxBlockNameLength);
+
+        std::vector<GLchar> blockNameBuffer(std::max(maxBlockNameLength, 1));
+        for (GLint i = 0; i < blockCount; i++)
+        {
+            GLsizei length = 0;
+            glGetActiveUniformBlockName(m_RendererID, (GLuint)i, (GLsizei)blockNameBuffer.size(), &length, blockNameBuffer.data());
+
+            auto it = s_UniformBlockBindings.find(std::string(blockNameBuffer.data(), length));
+            if (it != s_UniformBlockBindings.end())
+                glUniformBlockBinding(m_RendererID, (GLuint)i, it->second);
+        }
     }
 
-    Ref<Shader> Shader::Create(const std::string &filePath)
+    int Shader::GetUniformLocation(const std::string &name)
     {
-        return CreateRef<Shader>(filePath);
+        auto it = m_UniformLocations.find(name);
+        if (it != m_UniformLocations.end())
+            return it->second;
+
+        // 未激活 (被编译器优化掉) 的名字也缓存下来，只查询一次
+        GLint location = glGetUniformLocation(m_RendererID, name.c_str());
+        m_UniformLocations[name] = location;
+        return location;
+    }
+
+    Ref<Shader> Shader::Create(const std::string &filePath, const std::vector<std::string> &defines)
+    {
+        return CreateRef<Shader>(filePath, defines);
     }
 
     void Shader::SetInt(const std::string &name, int value)
@@ -185,6 +280,12 @@ namespace Mc
         UploadUniformFloat4(name, value);
     }
 
+    void Shader::SetFloat4Array(const std::string &name, const glm::vec4 *values, uint32_t count)
+    {
+        GLint location = GetUniformLocation(name);
+        glUniform4fv(location, count, glm::value_ptr(values[0]));
+    }
+
     void Shader::SetMat4(const std::string &name, const glm::mat4 &value)
     {
         UploadUniformMat4(name, value);
@@ -192,55 +293,55 @@ namespace Mc
 
     void Shader::SetMat4Array(const std::string &name, const glm::mat4 *values, uint32_t count)
     {
-        GLint location = glGetUniformLocation(m_RendererID, name.c_str());
+        GLint location = GetUniformLocation(name);
         glUniformMatrix4fv(location, count, GL_FALSE, glm::value_ptr(values[0]));
     }
 
     void Shader::UploadUniformInt(const std::string &name, int values)
     {
-        GLint location = glGetUniformLocation(m_RendererID, name.c_str());
+        GLint location = GetUniformLocation(name);
         glUniform1i(location, values);
     }
 
     void Shader::UploadUniformBool(const std::string &name, bool values)
     {
-        GLint location = glGetUniformLocation(m_RendererID, name.c_str());
+        GLint location = GetUniformLocation(name);
         glUniform1i(location, values);
     }
 
     void Shader::UploadUniformIntArray(const std::string &name, int *values, uint32_t count)
     {
-        GLint location = glGetUniformLocation(m_RendererID, name.c_str());
+        GLint location = GetUniformLocation(name);
         glUniform1iv(location, count, values);
     }
 
     void Shader::UploadUniformFloat(const std::string &name, float values)
     {
-        GLint location = glGetUniformLocation(m_RendererID, name.c_str());
+        GLint location = GetUniformLocation(name);
         glUniform1f(location, values);
     }
 
     void Shader::UploadUniformFloat2(const std::string &name, const glm::vec2 &values)
     {
-        GLint location = glGetUniformLocation(m_RendererID, name.c_str());
+        GLint location = GetUniformLocation(name);
         glUniform2f(location, values.x, values.y);
     }
 
     void Shader::UploadUniformFloat3(const std::string &name, const glm::vec3 &values)
     {
-        GLint location = glGetUniformLocation(m_RendererID, name.c_str());
+        GLint location = GetUniformLocation(name);
         glUniform3f(location, values.x, values.y, values.z);
     }
 
     void Shader::UploadUniformFloat4(const std::string &name, const glm::vec4 &values)
     {
-        GLint location = glGetUniformLocation(m_RendererID, name.c_str());
+        GLint location = GetUniformLocation(name);
         glUniform4f(location, values.x, values.y, values.z, values.w);
     }
     
     void Shader::UploadUniformMat4(const std::string &name, const glm::mat4 &matrix)
     {
-        GLint location = glGetUniformLocation(m_RendererID, name.c_str());
+        GLint location = GetUniformLocation(name);
         glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(matrix));
     }
 }
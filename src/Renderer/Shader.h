@@ -2,6 +2,7 @@
 
 #include "src/Core/Base.h"
 #include <string>
+#include <vector>
 
 #include <glm/glm.hpp>
 
@@ -12,7 +13,8 @@ namespace Mc
     class Shader
     {
     public:
-        Shader(const std::string &filePath);
+        // defines 插入到每个阶段的 #version 之后，同一个文件可以编译出不同的变体
+        Shader(const std::string &filePath, const std::vector<std::string> &defines = {});
         ~Shader();
 
         void Bind() const;
@@ -22,13 +24,17 @@ namespace Mc
 
     private:
         std::string LoadShaderFile(const std::string &filepath);
-        std::unordered_map<GLenum, std::string> PreProcess(const std::string &source);
+        std::unordered_map<GLenum, std::string> PreProcess(const std::string &source, const std::vector<std::string> &defines);
         void Complie(const std::unordered_map<GLenum, std::string> &shaderSourc);
+        // 链接后查询所有激活的 uniform 位置，并为共用的 uniform block 指定绑定点
+        void Reflect();
+        int GetUniformLocation(const std::string &name);
     private:
     	uint32_t m_RendererID;
 		std::string m_Name;
+        std::unordered_map<std::string, int> m_UniformLocations;
     public:
-        static Ref<Shader> Create(const std::string &filePath);
+        static Ref<Shader> Create(const std::string &filePath, const std::vector<std::string> &defines = {});
 
     public:
         void SetInt(const std::string &name, int value);
@@ -38,6 +44,7 @@ namespace Mc
         void SetFloat2(const std::string &name, const glm::vec2 &value);
         void SetFloat3(const std::string &name, const glm::vec3 &value);
         void SetFloat4(const std::string &name, const glm::vec4 &value);
+        void SetFloat4Array(const std::string &name, const glm::vec4 *values, uint32_t count);
         void SetMat4(const std::string &name, const glm::mat4 &value);
         void SetMat4Array(const std::string &name, const glm::mat4 *values, uint32_t count);
 
@@ -1,4 +1,5 @@
 #include "Shadow.h"
+#include "GLState.h"
 
 #include "src/Core/Log.h"
 
@@ -16,13 +17,16 @@ namespace Mc
     {
         glDeleteFramebuffers(1, &m_DepthMapFBO);
         glDeleteTextures(1, &m_DepthCubemap);
+
+        GLState::OnDeleteFramebuffer(m_DepthMapFBO);
+        GLState::OnDeleteTextures(&m_DepthCubemap, 1);
     }
 
     void PointShadowMap::Init()
     {
         glGenFramebuffers(1, &m_DepthMapFBO);
         glGenTextures(1, &m_DepthCubemap);
-        glBindTexture(GL_TEXTURE_CUBE_MAP, m_DepthCubemap);
+        GLState::BindTexture(GL_TEXTURE_CUBE_MAP, m_DepthCubemap);
 
         for (unsigned int i = 0; i < 6; ++i)
             glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_DEPTH_COMPONENT32F, m_Resolution, m_Resolution, 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
@@ -33,7 +37,7 @@ namespace Mc
         glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
 
         // attach depth texture as FBO's depth buffer
-        glBindFramebuffer(GL_FRAMEBUFFER, m_DepthMapFBO);
+        GLState::BindFramebuffer(m_DepthMapFBO);
 
         glFramebufferTexture(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, m_DepthCubemap, 0);
         glDrawBuffer(GL_NONE);
@@ -41,25 +45,24 @@ namespace Mc
         if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
             LOG_CORE_WARN("Framebuffer not complete!");
 
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        GLState::BindFramebuffer(0);
     }
 
     void PointShadowMap::Bind()
     {
-        glViewport(0, 0, m_Resolution, m_Resolution);
-        glBindFramebuffer(GL_FRAMEBUFFER, m_DepthMapFBO);
+        GLState::SetViewport(0, 0, m_Resolution, m_Resolution);
+        GLState::BindFramebuffer(m_DepthMapFBO);
         glClear(GL_DEPTH_BUFFER_BIT);
     }
 
     void PointShadowMap::Unbind()
     {
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        GLState::BindFramebuffer(0);
     }
 
     void PointShadowMap::BindTexture(uint32_t slot)
     {
-        glActiveTexture(GL_TEXTURE0 + slot);
-        glBindTexture(GL_TEXTURE_CUBE_MAP, m_DepthCubemap);
+        GLState::BindTextureUnit(slot, m_DepthCubemap);
     }
 
     Ref<PointShadowMap> PointShadowMap::Create(unsigned int resolution)
@@ -72,101 +75,60 @@ namespace Mc
     DirectionalShadowMap::DirectionalShadowMap(unsigned int resolution)
         : m_Resolution(resolution)
     {
-        Init();
     }
 
-    DirectionalShadowMap::~DirectionalShadowMap()
-    {
-
-        glDeleteFramebuffers(1, &m_DepthMapFBO);
-        glDeleteTextures(1, &m_DepthMap);
-    }
-
-    void DirectionalShadowMap::Init()
+    Ref<DirectionalShadowMap> DirectionalShadowMap::Create(unsigned int resolution)
     {
-        glGenFramebuffers(1, &m_DepthMapFBO);
-        glGenTextures(1, &m_DepthMap);
-
-        glBindTexture(GL_TEXTURE_2D, m_DepthMap);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT, m_Resolution, m_Resolution, 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
-
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
-
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
-
-        float borderColor[] = {1.0f, 1.0f, 1.0f, 1.0f};
-        glTexParameterfv(GL_TEXTURE_2D, GL_TEXTURE_BORDER_COLOR, borderColor);
-
-
-        glBindFramebuffer(GL_FRAMEBUFFER, m_DepthMapFBO);
-
-        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, m_DepthMap, 0);
-        glDrawBuffer(GL_NONE);
-        glReadBuffer(GL_NONE);
-        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
-        {
-            LOG_CORE_ERROR("Directional Shadow Map FBO is incomplete!");
-        }
-
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        return CreateRef<DirectionalShadowMap>(resolution);
     }
 
-    void DirectionalShadowMap::Bind()
-    {
-        glViewport(0, 0, m_Resolution, m_Resolution);
-        glBindFramebuffer(GL_FRAMEBUFFER, m_DepthMapFBO);
-        glClear(GL_DEPTH_BUFFER_BIT);
-    }
+    // -----------------------------------------------------------------
 
-    void DirectionalShadowMap::Unbind()
+    SpotShadowMap::SpotShadowMap(unsigned int resolution)
+        : m_Resolution(resolution)
     {
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
     }
 
-    void DirectionalShadowMap::BindTexture(uint32_t slot)
+    Ref<SpotShadowMap> SpotShadowMap::Create(unsigned int resolution)
     {
-        glActiveTexture(GL_TEXTURE0 + slot);
-        glBindTexture(GL_TEXTURE_2D, m_DepthMap);
+        return CreateRef<SpotShadowMap>(resolution);
     }
 
-    Ref<DirectionalShadowMap> DirectionalShadowMap::Create(unsigned int resolution)
-    {
-        return CreateRef<DirectionalShadowMap>(resolution);
-    }
+    // -----------------------------------------------------------------
 
-    SpotShadowMap::SpotShadowMap(unsigned int resolution)
-        : m_Resolution(resolution)
+    ShadowAtlas::ShadowAtlas(unsigned int size)
+        : m_Size(size)
     {
         Init();
     }
 
-    SpotShadowMap::~SpotShadowMap()
+    ShadowAtlas::~ShadowAtlas()
     {
         glDeleteFramebuffers(1, &m_DepthMapFBO);
         glDeleteTextures(1, &m_DepthMap);
+
+        GLState::OnDeleteFramebuffer(m_DepthMapFBO);
+        GLState::OnDeleteTextures(&m_DepthMap, 1);
     }
 
-    void SpotShadowMap::Init()
+    void ShadowAtlas::Init()
     {
         glGenFramebuffers(1, &m_DepthMapFBO);
         glGenTextures(1, &m_DepthMap);
 
-        glBindTexture(GL_TEXTURE_2D, m_DepthMap);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT, m_Resolution, m_Resolution, 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
+        GLState::BindTexture(GL_TEXTURE_2D, m_DepthMap);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT32F, m_Size, m_Size, 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
 
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+        // 着色器中手动比较深度做 PCF，不使用硬件比较
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_MODE, GL_NONE);
 
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        // 相邻区块属于不同光源，不做线性过滤
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
 
-        glBindFramebuffer(GL_FRAMEBUFFER, m_DepthMapFBO);
+        GLState::BindFramebuffer(m_DepthMapFBO);
         glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, m_DepthMap, 0);
 
         glDrawBuffer(GL_NONE);
@@ -174,33 +136,41 @@ namespace Mc
 
         if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
         {
-            LOG_CORE_ERROR("Spot Shadow Map FBO is incomplete!");
+            LOG_CORE_ERROR("Shadow Atlas FBO is incomplete!");
         }
 
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
-        glBindTexture(GL_TEXTURE_2D, 0);
+        GLState::BindFramebuffer(0);
+        GLState::BindTexture(GL_TEXTURE_2D, 0);
     }
 
-    void SpotShadowMap::Bind()
+    void ShadowAtlas::Bind(const glm::vec4 *rects, uint32_t count)
     {
-        glViewport(0, 0, m_Resolution, m_Resolution);
-        glBindFramebuffer(GL_FRAMEBUFFER, m_DepthMapFBO);
-        glClear(GL_DEPTH_BUFFER_BIT);
+        GLState::BindFramebuffer(m_DepthMapFBO);
+
+        GLState::Enable(GL_SCISSOR_TEST);
+        for (uint32_t i = 0; i < count; i++)
+        {
+            const glm::vec4 &rect = rects[i];
+            glScissor((GLint)rect.x, (GLint)rect.y, (GLsizei)rect.z, (GLsizei)rect.w);
+            glClear(GL_DEPTH_BUFFER_BIT);
+
+            GLState::SetViewportIndexed(i, rect.x, rect.y, rect.z, rect.w);
+        }
+        GLState::Disable(GL_SCISSOR_TEST);
     }
 
-    void SpotShadowMap::Unbind()
+    void ShadowAtlas::Unbind()
     {
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        GLState::BindFramebuffer(0);
     }
 
-    void SpotShadowMap::BindTexture(uint32_t slot)
+    void ShadowAtlas::BindTexture(uint32_t slot)
     {
-        glActiveTexture(GL_TEXTURE0 + slot);
-        glBindTexture(GL_TEXTURE_2D, m_DepthMap);
+        GLState::BindTextureUnit(slot, m_DepthMap);
     }
 
-    Ref<SpotShadowMap> SpotShadowMap::Create(unsigned int resolution)
+    Ref<ShadowAtlas> ShadowAtlas::Create(unsigned int size)
     {
-        return CreateRef<SpotShadowMap>(resolution);
+        return CreateRef<ShadowAtlas>(size);
     }
 }
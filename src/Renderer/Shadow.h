@@ -5,6 +5,21 @@
 
 namespace Mc
 {
+    // 方向光的级联数量，与着色器中的 SHADOW_CASCADES 一致
+    static const uint32_t ShadowCascadeCount = 4;
+
+    // 阴影贴图的更新状态，由 Renderer3D 的缓存与更新调度使用
+    struct ShadowMapState
+    {
+        uint64_t ContentHash = 0;           // 上次渲染时光源参数与可见投射物的哈希，0 表示需要重新渲染
+        uint32_t StaleFrames = 0;           // 内容已变化但因预算推迟渲染的帧数
+        bool Rendered = false;              // 从未渲染过或图集区块变化后内容无效，不能推迟
+        // 上次渲染时的光空间矩阵 (方向光每级级联一个，聚光灯只用第一个)，推迟期间采样仍使用它
+        glm::mat4 LightSpaceMatrices[ShadowCascadeCount] = {};
+        // 在 ShadowAtlas 中的区块 (xy 偏移, zw 大小，单位纹素)，点光源不使用
+        glm::vec4 AtlasRects[ShadowCascadeCount] = {};
+    };
+
     class PointShadowMap
     {
     public:
@@ -20,49 +35,73 @@ namespace Mc
         unsigned int GetDepthCubemap() const { return m_DepthCubemap; }
 
         static Ref<PointShadowMap> Create(unsigned int resolution);
+
+        ShadowMapState &GetState() { return m_State; }
     private:
+        ShadowMapState m_State;
         unsigned int m_Resolution;
         unsigned int m_DepthMapFBO;
         unsigned int m_DepthCubemap;
     };
 
+    // 方向光的级联阴影，ShadowCascadeCount 个区块位于 ShadowAtlas 中
+    // resolution 为每级级联请求的区块大小，图集放不下时会缩小
     class DirectionalShadowMap
     {
     public:
         DirectionalShadowMap(unsigned int resolution);
-        ~DirectionalShadowMap();
-
-        void Init();
 
-        void Bind();
-        void Unbind();
-        void BindTexture(uint32_t slot);
+        unsigned int GetResolution() const { return m_Resolution; }
 
         static Ref<DirectionalShadowMap> Create(unsigned int resolution);
 
+        ShadowMapState &GetState() { return m_State; }
+
     private:
+        ShadowMapState m_State;
         unsigned int m_Resolution;
-        unsigned int m_DepthMapFBO;
-        unsigned int m_DepthMap;
     };
 
+    // 聚光灯阴影，一个区块位于 ShadowAtlas 中
+    // resolution 为光源铺满屏幕时的区块大小，实际大小随屏幕覆盖缩小
     class SpotShadowMap
     {
     public:
         SpotShadowMap(unsigned int resolution);
-        ~SpotShadowMap();
+
+        unsigned int GetResolution() const { return m_Resolution; }
+
+        static Ref<SpotShadowMap> Create(unsigned int resolution);
+
+        ShadowMapState &GetState() { return m_State; }
+
+    private:
+        ShadowMapState m_State;
+        unsigned int m_Resolution;
+    };
+
+    // 方向光级联与聚光灯共用的深度图集，大小固定，区块每帧由 Renderer3D 分配
+    class ShadowAtlas
+    {
+    public:
+        ShadowAtlas(unsigned int size);
+        ~ShadowAtlas();
 
         void Init();
 
-        void Bind();
+        // 绑定图集的帧缓冲，只清除给定的区块 (xy 偏移, zw 大小，单位纹素)
+        // 第 i 个区块同时设为第 i 个视口，几何着色器通过 gl_ViewportIndex 选择
+        void Bind(const glm::vec4 *rects, uint32_t count);
         void Unbind();
         void BindTexture(uint32_t slot);
 
-        static Ref<SpotShadowMap> Create(unsigned int resolution);
+        unsigned int GetSize() const { return m_Size; }
+
+        static Ref<ShadowAtlas> Create(unsigned int size);
 
     private:
-        unsigned int m_Resolution;
+        unsigned int m_Size;
         unsigned int m_DepthMapFBO;
         unsigned int m_DepthMap;
     };
-}
\ No newline at end of file
+}
@@ -31,6 +31,14 @@ namespace Mc
             m_VertexArray->UnBind();
         }
 
+        // 实例数由 GL_DRAW_INDIRECT_BUFFER 中 offset 处的命令给出
+        void DrawIndirect(uint32_t offset)
+        {
+            m_VertexArray->Bind();
+            glDrawElementsIndirect(GL_TRIANGLE_STRIP, GL_UNSIGNED_INT, (const void *)(uintptr_t)offset);
+            m_VertexArray->UnBind();
+        }
+
         // 获取该球体网格的渲染数据，供Renderer3D使用
         Ref<VertexArray> GetVertexArray() { return m_VertexArray; }
         uint32_t GetIndexCount() const { return m_IndexCount; } // 获取该球体网格的索引数量
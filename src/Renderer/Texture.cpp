@@ -1,4 +1,6 @@
 #include "Texture.h"
+#include "BindlessTexture.h"
+#include "GLState.h"
 
 #include <stb_image.h>
 #include <iostream>
@@ -56,7 +58,9 @@ namespace Mc
 
     Texture2D::~Texture2D()
     {
+        BindlessTexture::MakeNonResident(m_BindlessHandle);
         glDeleteTextures(1, &m_RendererID);
+        GLState::OnDeleteTextures(&m_RendererID, 1);
     }
 
     void Texture2D::SetTexture()
@@ -79,7 +83,15 @@ namespace Mc
 
     void Texture2D::Bind(uint32_t slot) const
     {
-        glBindTextureUnit(slot, m_RendererID);
+        GLState::BindTextureUnit(slot, m_RendererID);
+    }
+
+    uint64_t Texture2D::GetBindlessHandle()
+    {
+        // 句柄创建后纹理参数不可再修改，因此在第一次使用时才获取
+        if (m_BindlessHandle == 0)
+            m_BindlessHandle = BindlessTexture::MakeResident(m_RendererID);
+        return m_BindlessHandle;
     }
 
     Ref<Texture2D> Texture2D::Create(uint32_t width, uint32_t height)
@@ -26,6 +26,9 @@ namespace Mc
 
         void Bind(uint32_t slot = 0) const;
 
+        // 首次调用时获取并常驻 bindless 句柄，不支持时返回 0
+        uint64_t GetBindlessHandle();
+
         bool IsLoaded() const { return m_IsLoaded; }
 
         bool operator==(const Texture2D &other) const
@@ -39,6 +42,7 @@ namespace Mc
         uint32_t m_RendererID;
         uint32_t m_Width, m_Height;
         GLenum m_InternalFormat, m_DataFormat;
+        uint64_t m_BindlessHandle = 0;
     public:
         static Ref<Texture2D> Create(uint32_t width, uint32_t height);
         static Ref<Texture2D> Create(const std::string &path);
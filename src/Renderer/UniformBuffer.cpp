@@ -1,5 +1,6 @@
 
 #include "UniformBuffer.h"
+#include "GLState.h"
 
 #include <glad/glad.h>
 
@@ -7,15 +8,17 @@ namespace Mc
 {
 
     UniformBuffer::UniformBuffer(uint32_t size, uint32_t binding)
+		: m_Binding(binding)
     {
 		glCreateBuffers(1, &m_RendererID);
 		glNamedBufferData(m_RendererID, size, nullptr, GL_DYNAMIC_DRAW); // TODO: investigate usage hint
-		glBindBufferBase(GL_UNIFORM_BUFFER, binding, m_RendererID);
+		GLState::BindBufferBase(GL_UNIFORM_BUFFER, binding, m_RendererID);
 	}
 
     UniformBuffer::~UniformBuffer()
     {
 		glDeleteBuffers(1, &m_RendererID);
+		GLState::OnDeleteBuffer(m_RendererID);
 	}
 
     void UniformBuffer::SetData(const void *data, uint32_t size, uint32_t offset)
@@ -23,6 +26,11 @@ namespace Mc
 		glNamedBufferSubData(m_RendererID, offset, size, data);
 	}
 
+    void UniformBuffer::Bind() const
+    {
+		GLState::BindBufferBase(GL_UNIFORM_BUFFER, m_Binding, m_RendererID);
+	}
+
     Ref<UniformBuffer> UniformBuffer::Create(uint32_t size, uint32_t binding)
     {
 		return CreateRef<UniformBuffer>(size, binding);
@@ -14,11 +14,13 @@ namespace Mc
 		~UniformBuffer();
 
 		void SetData(const void* data, uint32_t size, uint32_t offset = 0);
+		void Bind() const;
 
 		static Ref<UniformBuffer> Create(uint32_t size, uint32_t binding);
 
 	private:
 		uint32_t m_RendererID = 0;
+		uint32_t m_Binding = 0;
 	};
 
 }
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include "VertexArray.h"
+#include "GLState.h"
 
 #include <glad/glad.h>
 
@@ -36,21 +37,22 @@ namespace Mc
     VertexArray::~VertexArray()
     {
         glDeleteVertexArrays(1, &m_RendererID);
+        GLState::OnDeleteVertexArray(m_RendererID);
     }
 
     void VertexArray::Bind() const
     {
-        glBindVertexArray(m_RendererID);
+        GLState::BindVertexArray(m_RendererID);
     }
 
     void VertexArray::UnBind() const
     {
-        glBindVertexArray(0);
+        // 下一次 Bind 时直接切换；IndexBuffer 只在 SetIndexBuffer 中绑定到自己的 VAO，保持绑定是安全的
     }
 
     void VertexArray::AddVertexBuffer(const Ref<VertexBuffer> &vertexBuffer)
     {
-        glBindVertexArray(m_RendererID);
+        GLState::BindVertexArray(m_RendererID);
         vertexBuffer->Bind();
 
         const auto &layout = vertexBuffer->GetLayout();
@@ -117,7 +119,7 @@ namespace Mc
 
     void VertexArray::SetIndexBuffer(const Ref<IndexBuffer> &indexBuffer)
     {
-        glBindVertexArray(m_RendererID);
+        GLState::BindVertexArray(m_RendererID);
         indexBuffer->Bind();
 
         m_IndexBuffer = indexBuffer;
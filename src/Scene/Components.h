@@ -11,6 +11,8 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
+#include <array>
+
 #define GLM_ENABLE_EXPERIMENTAL
 #include <glm/gtx/quaternion.hpp>
 
@@ -194,6 +196,11 @@ namespace Mc
 		std::string EmissiveMap;
 		std::string HeightMap;
 
+		// 由 Renderer3D 解析的贴图缓存 (按 TextureType 排列)
+		// ResolvedPaths 记录每个缓存句柄对应的路径，路径被任何地方改写后下次绘制时自动重新解析
+		std::array<Ref<Texture2D>, (int)TextureType::Count> ResolvedTextures;
+		std::array<std::string, (int)TextureType::Count> ResolvedPaths;
+
 		MaterialComponent() = default;
 		MaterialComponent(const MaterialComponent &) = default;
 	};
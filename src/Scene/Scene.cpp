@@ -4,6 +4,7 @@
 #include "Components.h"
 #include "src/Renderer/Renderer3D.h"
 #include "src/Renderer/Manager/ModelManager.h"
+#include "src/Renderer/Manager/MeshManager.h"
 // #include "ScriptableEntity.h"
 // #include "src/Scripting/ScriptEngine.h"
 
@@ -283,38 +284,17 @@ namespace Mc
 				}
 			}
 
-			// Draw sphere
-			{
-				auto view = m_Registry.view<TransformComponent, SphereRendererComponent>();
-				for (auto entity : view)
-				{
-					auto [transform, sphere] = view.get<TransformComponent, SphereRendererComponent>(entity);
-					MaterialComponent *material = m_Registry.try_get<MaterialComponent>(entity);
-					Renderer3D::DrawSphere(transform.GetTransform(), sphere, material, (int)entity);
-				}
-			}
+			DrawRenderables(mainCamera->GetProjection() * glm::inverse(cameraTransform));
 
+			// 动画在提交之后更新，调色板已在 DrawModel 中拷贝
+			if (!m_IsPaused)
 			{
-				auto view = m_Registry.view<TransformComponent, ModelRendererComponent, HierarchyComponent>();
-
+				auto view = m_Registry.view<ModelRendererComponent, HierarchyComponent>();
 				for (auto entityID : view)
 				{
-					Entity entity{entityID, this};
-
-					if (entity.GetComponent<HierarchyComponent>().Parent == 0)
-					{
-						auto transform = entity.GetComponent<TransformComponent>().GetTransform();
-						auto model = entity.GetComponent<ModelRendererComponent>();
-						for (Entity childEntity : entity.GetChildren())
-						{
-							glm::mat4 worldTransform = transform * childEntity.GetComponent<TransformComponent>().GetTransform();
-							MeshRendererComponent *mesh = m_Registry.try_get<MeshRendererComponent>(childEntity);
-							MaterialComponent *material = m_Registry.try_get<MaterialComponent>(childEntity);
-							Renderer3D::DrawModel(worldTransform, model, mesh, material, (int)entityID);
-						}
-						if (model.ReceivesAnimator && !m_IsPaused)
-							model.Model->GetAnimator()->UpdateAnimation(ts);
-					}
+					auto [model, hierarchy] = view.get<ModelRendererComponent, HierarchyComponent>(entityID);
+					if (hierarchy.Parent == 0 && model.ReceivesAnimator)
+						model.Model->GetAnimator()->UpdateAnimation(ts);
 				}
 			}
 			Renderer3D::EndScene();
@@ -442,14 +422,24 @@ namespace Mc
 			}
 		}
 
-		// Draw sphere
+		DrawRenderables(camera.GetViewProjection());
+
+		Renderer3D::EndScene();
+	}
+
+	void Scene::DrawRenderables(const glm::mat4& viewProjection)
+	{
+		// 先收集所有球体和模型子网格的世界空间包围球，批量剔除后再提交
+		m_FrustumCuller.Clear();
+		m_Renderables.clear();
+
 		{
 			auto view = m_Registry.view<TransformComponent, SphereRendererComponent>();
 			for (auto entity : view)
 			{
-				auto [transform, sphere] = view.get<TransformComponent, SphereRendererComponent>(entity);
-				MaterialComponent *material = m_Registry.try_get<MaterialComponent>(entity);
-				Renderer3D::DrawSphere(transform.GetTransform(), sphere, material, (int)entity);
+				glm::mat4 transform = view.get<TransformComponent>(entity).GetTransform();
+				m_FrustumCuller.Add(transform, glm::vec4(0.0f, 0.0f, 0.0f, 1.0f)); // 默认球体为单位球
+				m_Renderables.push_back({transform, entity, entt::null});
 			}
 		}
 
@@ -463,19 +453,63 @@ namespace Mc
 				if (entity.GetComponent<HierarchyComponent>().Parent == 0)
 				{
 					auto transform = entity.GetComponent<TransformComponent>().GetTransform();
-					auto model = entity.GetComponent<ModelRendererComponent>();
+					auto &model = entity.GetComponent<ModelRendererComponent>();
+
+					// 蒙皮后的包围体随动画变化，带动画的模型不剔除
+					bool animated = model.ReceivesAnimator && model.Model && model.Model->GetAnimator();
+
 					for (Entity childEntity : entity.GetChildren())
 					{
 						glm::mat4 worldTransform = transform * childEntity.GetComponent<TransformComponent>().GetTransform();
 						MeshRendererComponent *mesh = m_Registry.try_get<MeshRendererComponent>(childEntity);
-						MaterialComponent *material = m_Registry.try_get<MaterialComponent>(childEntity);
-						Renderer3D::DrawModel(worldTransform, model, mesh, material, (int)entityID);
+						Ref<Mesh> data = mesh ? MeshManager::Get().GetMeshByID(mesh->Id) : nullptr;
+
+						if (animated || !data)
+							m_FrustumCuller.AddAlwaysVisible();
+						else
+							m_FrustumCuller.Add(worldTransform, data->GetBoundingSphere());
+
+						m_Renderables.push_back({worldTransform, (entt::entity)childEntity, entityID});
 					}
 				}
 			}
 		}
 
-		Renderer3D::EndScene();
+		Renderer3D::AddSceneCulled(m_FrustumCuller.Cull(Math::Frustum::FromViewProjection(viewProjection)));
+
+		for (uint32_t i = 0; i < (uint32_t)m_Renderables.size(); i++)
+		{
+			const RenderableItem &item = m_Renderables[i];
+			bool visible = m_FrustumCuller.IsVisible(i);
+
+			if (item.Root == entt::null)
+			{
+				auto &sphere = m_Registry.get<SphereRendererComponent>(item.Entity);
+				if (visible)
+				{
+					MaterialComponent *material = m_Registry.try_get<MaterialComponent>(item.Entity);
+					Renderer3D::DrawSphere(item.Transform, sphere, material, (int)item.Entity);
+				}
+				else
+				{
+					Renderer3D::DrawSphereShadow(item.Transform, sphere);
+				}
+			}
+			else
+			{
+				auto &model = m_Registry.get<ModelRendererComponent>(item.Root);
+				MeshRendererComponent *mesh = m_Registry.try_get<MeshRendererComponent>(item.Entity);
+				if (visible)
+				{
+					MaterialComponent *material = m_Registry.try_get<MaterialComponent>(item.Entity);
+					Renderer3D::DrawModel(item.Transform, model, mesh, material, (int)item.Root);
+				}
+				else
+				{
+					Renderer3D::DrawModelShadow(item.Transform, model, mesh, (int)item.Root);
+				}
+			}
+		}
 	}
 
 	void Scene::NewScene()
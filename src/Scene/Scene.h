@@ -6,6 +6,7 @@
 #include "src/Renderer/Texture.h"
 #include "src/Renderer/Shader.h"
 #include "src/Renderer/Manager/SceneManager.h"
+#include "src/Math/FrustumCuller.h"
 
 #include <entt/entt.hpp>
 
@@ -63,6 +64,8 @@ namespace Mc
 		// void OnPhysics2DStop();
 
 		void RenderScene(EditorCamera& camera);
+		// 视锥剔除后提交球体和模型，被剔除的物体只提交阴影投射
+		void DrawRenderables(const glm::mat4& viewProjection);
 	private:
 		entt::registry m_Registry;
 		uint32_t m_ViewportWidth = 0, m_ViewportHeight = 0;
@@ -75,6 +78,16 @@ namespace Mc
 
 		Scope<SceneManager> m_SceneEntity;
 
+		// 每帧复用，避免重复分配
+		struct RenderableItem
+		{
+			glm::mat4 Transform;
+			entt::entity Entity;
+			entt::entity Root; // 模型子网格所属的根实体，球体为 entt::null
+		};
+		std::vector<RenderableItem> m_Renderables;
+		Math::FrustumCuller m_FrustumCuller;
+
 		friend class Entity;
 		friend class SceneSerializer;
 		friend class SceneHierarchyPanel;
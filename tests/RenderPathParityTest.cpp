@@ -0,0 +1,185 @@
+// 前向与延迟渲染路径的一致性测试: 同一个固定场景分别用两条路径渲染到帧缓冲，逐像素比较
+// 在 llvmpipe 上运行 (LIBGL_ALWAYS_SOFTWARE=1)，无显示器时用 xvfb-run; 没有 GL 上下文时返回 77 (ctest 记为跳过)
+//
+// 不覆盖半透明物体: 延迟路径的 alpha 混合只与背景混合 (见 Renderer3D::RenderPath)，两条路径的结果本来就不同，
+// 因此场景中所有物体的 alpha 都为 1
+#include "src/Core/Log.h"
+#include "src/Renderer/HeadlessContext.h"
+#include "src/Renderer/Renderer.h"
+#include "src/Renderer/Renderer3D.h"
+#include "src/Renderer/Framebuffer.h"
+#include "src/Scene/Scene.h"
+#include "src/Scene/Entity.h"
+#include "src/Scene/Components.h"
+
+#include <glad/glad.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using namespace Mc;
+
+namespace
+{
+    const uint32_t s_Width = 320;
+    const uint32_t s_Height = 180;
+
+    // 两条路径的着色器计算顺序和精度不同 (G-buffer 为 RGBA16F / RGBA8)，允许少量误差:
+    // 平均误差不超过 1/255，超过 8/255 的像素不超过 0.5% (几何边缘的光栅化和深度比较差异)
+    const double s_MaxMeanError = 1.0;
+    const int s_OutlierThreshold = 8;
+    const double s_MaxOutlierRatio = 0.005;
+
+    void BuildScene(Scene &scene)
+    {
+        {
+            Entity light = scene.CreateEntity("Directional Light");
+            light.GetComponent<TransformComponent>().Rotation = glm::vec3(glm::radians(-50.0f), glm::radians(35.0f), 0.0f);
+            auto &directional = light.AddComponent<DirectionalLightComponent>();
+            directional.Intensity = 2.0f;
+        }
+
+        {
+            Entity light = scene.CreateEntity("Point Light");
+            light.GetComponent<TransformComponent>().Translation = glm::vec3(0.0f, 2.0f, 3.0f);
+            auto &point = light.AddComponent<PointLightComponent>();
+            point.Color = glm::vec3(1.0f, 0.6f, 0.3f);
+            point.Intensity = 5.0f;
+        }
+
+        // 5x3 个球体，粗糙度和金属度各不相同，互相部分遮挡以覆盖深度测试
+        for (int y = 0; y < 3; y++)
+        {
+            for (int x = 0; x < 5; x++)
+            {
+                Entity entity = scene.CreateEntity("Sphere");
+                entity.GetComponent<TransformComponent>().Translation = glm::vec3((float)x * 1.6f - 3.2f, (float)y * 1.6f - 1.6f, (float)((x + y) % 2) * -0.8f);
+
+                auto &sphere = entity.AddComponent<SphereRendererComponent>();
+                sphere.ReceivesPBR = true;
+                sphere.ReceivesLight = true;
+
+                auto &material = entity.AddComponent<MaterialComponent>();
+                material.Albedo = glm::vec3(0.2f + 0.2f * (float)x, 0.3f + 0.3f * (float)y, 0.8f - 0.15f * (float)x);
+                material.Roughness = 0.1f + 0.2f * (float)x;
+                material.Metallic = 0.5f * (float)y;
+            }
+        }
+    }
+
+    std::vector<uint8_t> RenderImage(Scene &scene, EditorCamera &camera, Framebuffer &framebuffer, Renderer3D::RenderPath path)
+    {
+        Renderer3D::SetRenderPath(path);
+
+        // 前几帧用于创建 G-buffer、缓冲区增长和阴影缓存，只读取最后一帧
+        for (int frame = 0; frame < 3; frame++)
+        {
+            framebuffer.Bind();
+            Renderer::SetClearColor(glm::vec4(0.3f, 0.3f, 0.3f, 1.0f));
+            Renderer::Clear();
+            framebuffer.ClearAttachment(1, -1);
+
+            scene.OnUpdateEditor(Timestep(0.0f), camera);
+
+            framebuffer.UnBind();
+        }
+
+        std::vector<uint8_t> pixels(s_Width * s_Height * 4);
+        glFinish();
+        glGetTextureImage(framebuffer.GetColorAttachmentRendererID(0), 0, GL_RGBA, GL_UNSIGNED_BYTE, (GLsizei)pixels.size(), pixels.data());
+        return pixels;
+    }
+
+    // 失败时写出两张图，便于查看差异
+    void WritePPM(const char *path, const std::vector<uint8_t> &pixels)
+    {
+        FILE *file = fopen(path, "wb");
+        if (!file)
+            return;
+
+        fprintf(file, "P6\n%u %u\n255\n", s_Width, s_Height);
+        for (uint32_t y = s_Height; y-- > 0;)
+        {
+            for (uint32_t x = 0; x < s_Width; x++)
+                fwrite(&pixels[(y * s_Width + x) * 4], 1, 3, file);
+        }
+        fclose(file);
+    }
+}
+
+int main()
+{
+    Log::Init();
+
+    HeadlessContext context(s_Width, s_Height);
+    if (!context.IsValid())
+    {
+        printf("RenderPathParityTest: no GL context available, skipping\n");
+        return 77;
+    }
+
+    int result = 0;
+    {
+        FramebufferSpecification spec;
+        spec.Attachments = {FramebufferTextureFormat::RGBA8, FramebufferTextureFormat::RED_INTEGER, FramebufferTextureFormat::DEPTH24STENCIL8};
+        spec.Width = s_Width;
+        spec.Height = s_Height;
+        Ref<Framebuffer> framebuffer = Framebuffer::Create(spec);
+
+        Scene scene;
+        BuildScene(scene);
+
+        EditorCamera camera(45.0f, (float)s_Width / (float)s_Height, 0.1f, 100.0f);
+        camera.SetViewportSize((float)s_Width, (float)s_Height);
+        camera.SetDistance(9.0f);
+        camera.SetFocalPoint(glm::vec3(0.0f));
+
+        std::vector<uint8_t> forward = RenderImage(scene, camera, *framebuffer, Renderer3D::RenderPath::Forward);
+        std::vector<uint8_t> deferred = RenderImage(scene, camera, *framebuffer, Renderer3D::RenderPath::Deferred);
+        Renderer3D::SetRenderPath(Renderer3D::RenderPath::Forward);
+
+        double errorSum = 0.0;
+        uint32_t outliers = 0;
+        uint32_t covered = 0;
+        const uint32_t pixelCount = s_Width * s_Height;
+        for (uint32_t i = 0; i < pixelCount; i++)
+        {
+            int maxError = 0;
+            bool background = true;
+            for (int c = 0; c < 3; c++)
+            {
+                int error = std::abs((int)forward[i * 4 + c] - (int)deferred[i * 4 + c]);
+                maxError = error > maxError ? error : maxError;
+                errorSum += error;
+                // 左下角没有物体，与它相同的像素视为背景 (清屏颜色或天空盒)
+                background = background && forward[i * 4 + c] == forward[c];
+            }
+            if (maxError > s_OutlierThreshold)
+                outliers++;
+            if (!background)
+                covered++;
+        }
+
+        double meanError = errorSum / (double)(pixelCount * 3);
+        double outlierRatio = (double)outliers / (double)pixelCount;
+        printf("RenderPathParityTest: mean error %.3f, %u pixels (%.2f%%) above %d, %u pixels covered\n",
+               meanError, outliers, outlierRatio * 100.0, s_OutlierThreshold, covered);
+
+        // 场景没有画出来时两条路径同样只有背景，比较没有意义; 球体应覆盖画面的一大部分
+        if (covered < pixelCount / 10)
+        {
+            printf("RenderPathParityTest: FAILED, nothing was rendered\n");
+            result = 1;
+        }
+        else if (meanError > s_MaxMeanError || outlierRatio > s_MaxOutlierRatio)
+        {
+            printf("RenderPathParityTest: FAILED, writing forward.ppm and deferred.ppm\n");
+            WritePPM("forward.ppm", forward);
+            WritePPM("deferred.ppm", deferred);
+            result = 1;
+        }
+    }
+
+    return result;
+}